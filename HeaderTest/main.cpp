@@ -28,7 +28,11 @@
 #pragma clang diagnostic ignored "-Wmissing-prototypes"
 #endif
 
+#ifdef _WIN32
 int __cdecl wmain(int, wchar_t* [], wchar_t* [])
+#else
+int main(int, char* [])
+#endif
 {
     return 0;
 }
@@ -0,0 +1,661 @@
+//--------------------------------------------------------------------------------------
+// File: MeshGenerator.h
+//
+// Procedural meshes of arbitrary size for scale and throughput benchmarks. Unlike
+// ShapesGenerator, vertices are welded (no texture seams) so the results are closed
+// manifolds where the shape allows it, and adjacency is produced alongside.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#define _XM_NO_XMVECTOR_OVERLOADS_
+#include <DirectXMath.h>
+
+template<typename T>
+class MeshGenerator
+{
+public:
+    using index_t = T;
+
+    enum Kind
+    {
+        KIND_SPHERE = 0,    // icosahedral subdivision sphere
+        KIND_TERRAIN,       // fractal height field grid (open surface)
+        KIND_HOLES,         // thick plate with many through-holes (high genus)
+        KIND_CLUTTER,       // many small disconnected rocks and rings, like a scanned prop
+        KIND_MAX
+    };
+
+    static const char* GetKindName( Kind kind )
+    {
+        switch( kind )
+        {
+        case KIND_SPHERE:   return "sphere";
+        case KIND_TERRAIN:  return "terrain";
+        case KIND_HOLES:    return "holes";
+        case KIND_CLUTTER:  return "clutter";
+        default:            return "unknown";
+        }
+    }
+
+    // Creates a mesh of the given kind with approximately targetFaces triangles. Spheres
+    // come in steps of 4x, so the closest subdivision level is used. Output is deterministic
+    // for a given seed on all platforms. Throws std::overflow_error if the vertex count does
+    // not fit in index_t.
+    static void Create( Kind kind, size_t targetFaces, uint32_t seed,
+                        std::vector<index_t>& indices, std::vector<DirectX::XMFLOAT3>& positions, std::vector<uint32_t>& adjacency )
+    {
+        targetFaces = std::max<size_t>( 20, targetFaces );
+
+        switch( kind )
+        {
+        case KIND_SPHERE:
+            {
+                size_t level = 0;
+                while ( ( size_t(20) << ( 2 * ( level + 1 ) ) ) <= targetFaces * 2 )
+                    ++level;
+                CreateGeodesicSphere( indices, positions, 1.f, level );
+            }
+            break;
+
+        case KIND_TERRAIN:
+            {
+                auto grid = static_cast<size_t>( std::sqrt( double( targetFaces ) / 2.0 ) + 0.5 );
+                CreateTerrain( indices, positions, 10.f, 1.5f, std::max<size_t>( 2, grid ), seed );
+            }
+            break;
+
+        case KIND_HOLES:
+            {
+                // Top and bottom faces dominate the triangle count, and holes take out about a quarter
+                auto grid = static_cast<size_t>( std::sqrt( double( targetFaces ) / 3.0 ) + 0.5 );
+                grid = std::max<size_t>( 8, grid );
+                const size_t holes = std::min<size_t>( ( grid / 4 ) * ( grid / 4 ), 64 );
+                CreatePlateWithHoles( indices, positions, 10.f, 0.5f, grid, holes );
+            }
+            break;
+
+        case KIND_CLUTTER:
+            {
+                const size_t components = std::min<size_t>( std::max<size_t>( 4, targetFaces / 2000 ), 4096 );
+                CreateClutter( indices, positions, components, targetFaces / components, seed );
+            }
+            break;
+
+        default:
+            throw std::invalid_argument( "Invalid MeshGenerator kind" );
+        }
+
+        adjacency.resize( indices.size() );
+        ComputeAdjacency( indices.data(), indices.size() / 3, positions.size(), adjacency.data() );
+    }
+
+    // 20 * 4^subdivisions faces
+    static void CreateGeodesicSphere( std::vector<index_t>& indices, std::vector<DirectX::XMFLOAT3>& positions, float diameter, size_t subdivisions )
+    {
+        using namespace DirectX;
+
+        indices.clear();
+        positions.clear();
+
+        const uint64_t finalVerts = 10 * ( uint64_t(1) << ( 2 * subdivisions ) ) + 2;
+        CheckVertexCount( finalVerts );
+
+        positions.reserve( static_cast<size_t>( finalVerts ) );
+        indices.reserve( size_t(60) << ( 2 * subdivisions ) );
+
+        const float t = ( 1.f + std::sqrt( 5.f ) ) / 2.f;
+
+        const XMFLOAT3 icoVerts[12] =
+        {
+            XMFLOAT3( -1,  t,  0 ), XMFLOAT3(  1,  t,  0 ), XMFLOAT3( -1, -t,  0 ), XMFLOAT3(  1, -t,  0 ),
+            XMFLOAT3(  0, -1,  t ), XMFLOAT3(  0,  1,  t ), XMFLOAT3(  0, -1, -t ), XMFLOAT3(  0,  1, -t ),
+            XMFLOAT3(  t,  0, -1 ), XMFLOAT3(  t,  0,  1 ), XMFLOAT3( -t,  0, -1 ), XMFLOAT3( -t,  0,  1 ),
+        };
+
+        static const uint8_t s_icoFaces[20][3] =
+        {
+            { 0, 11, 5 }, { 0, 5, 1 }, { 0, 1, 7 }, { 0, 7, 10 }, { 0, 10, 11 },
+            { 1, 5, 9 }, { 5, 11, 4 }, { 11, 10, 2 }, { 10, 7, 6 }, { 7, 1, 8 },
+            { 3, 9, 4 }, { 3, 4, 2 }, { 3, 2, 6 }, { 3, 6, 8 }, { 3, 8, 9 },
+            { 4, 9, 5 }, { 2, 4, 11 }, { 6, 2, 10 }, { 8, 6, 7 }, { 9, 8, 1 },
+        };
+
+        const float radius = diameter / 2;
+
+        for( size_t j = 0; j < 12; ++j )
+        {
+            XMFLOAT3 p;
+            XMStoreFloat3( &p, XMVectorScale( XMVector3Normalize( XMLoadFloat3( &icoVerts[j] ) ), radius ) );
+            positions.push_back( p );
+        }
+
+        for( size_t j = 0; j < 20; ++j )
+        {
+            indices.push_back( index_t( s_icoFaces[j][0] ) );
+            indices.push_back( index_t( s_icoFaces[j][1] ) );
+            indices.push_back( index_t( s_icoFaces[j][2] ) );
+        }
+
+        std::vector<uint32_t> adjacency;
+        std::vector<index_t> midpoints;
+        std::vector<index_t> next;
+
+        for( size_t level = 0; level < subdivisions; ++level )
+        {
+            const size_t nFaces = indices.size() / 3;
+
+            // Each edge's midpoint is created by whichever of its two faces comes first
+            adjacency.resize( indices.size() );
+            ComputeAdjacency( indices.data(), nFaces, positions.size(), adjacency.data() );
+
+            midpoints.resize( indices.size() );
+            for( size_t face = 0; face < nFaces; ++face )
+            {
+                for( size_t edge = 0; edge < 3; ++edge )
+                {
+                    const uint32_t neighbor = adjacency[ face * 3 + edge ];
+                    if ( neighbor != uint32_t(-1) && neighbor < face )
+                    {
+                        for( size_t k = 0; k < 3; ++k )
+                        {
+                            if ( adjacency[ neighbor * 3 + k ] == face )
+                            {
+                                midpoints[ face * 3 + edge ] = midpoints[ neighbor * 3 + k ];
+                                break;
+                            }
+                        }
+                        continue;
+                    }
+
+                    XMVECTOR a = XMLoadFloat3( &positions[ indices[ face * 3 + edge ] ] );
+                    XMVECTOR b = XMLoadFloat3( &positions[ indices[ face * 3 + ( edge + 1 ) % 3 ] ] );
+                    XMVECTOR m = XMVectorScale( XMVector3Normalize( XMVectorAdd( a, b ) ), radius );
+
+                    XMFLOAT3 p;
+                    XMStoreFloat3( &p, m );
+                    midpoints[ face * 3 + edge ] = index_t( positions.size() );
+                    positions.push_back( p );
+                }
+            }
+
+            next.clear();
+            next.reserve( indices.size() * 4 );
+            for( size_t face = 0; face < nFaces; ++face )
+            {
+                const index_t a = indices[ face * 3 ];
+                const index_t b = indices[ face * 3 + 1 ];
+                const index_t c = indices[ face * 3 + 2 ];
+                const index_t ab = midpoints[ face * 3 ];
+                const index_t bc = midpoints[ face * 3 + 1 ];
+                const index_t ca = midpoints[ face * 3 + 2 ];
+
+                const index_t tris[12] = { a, ab, ca,  b, bc, ab,  c, ca, bc,  ab, bc, ca };
+                next.insert( next.end(), tris, tris + 12 );
+            }
+
+            std::swap( indices, next );
+        }
+    }
+
+    // gridSize x gridSize quads (2 * gridSize^2 faces) spanning size x size, displaced by fractal value noise
+    static void CreateTerrain( std::vector<index_t>& indices, std::vector<DirectX::XMFLOAT3>& positions, float size, float height, size_t gridSize, uint32_t seed )
+    {
+        using namespace DirectX;
+
+        indices.clear();
+        positions.clear();
+
+        gridSize = std::max<size_t>( 1, gridSize );
+
+        const size_t stride = gridSize + 1;
+        CheckVertexCount( uint64_t( stride ) * stride );
+
+        positions.reserve( stride * stride );
+        indices.reserve( gridSize * gridSize * 6 );
+
+        const float scale = size / float( gridSize );
+        const float features = 8.f / float( gridSize );
+
+        for( size_t i = 0; i <= gridSize; ++i )
+        {
+            for( size_t j = 0; j <= gridSize; ++j )
+            {
+                const float y = height * FractalNoise( float( i ) * features, float( j ) * features, seed );
+                positions.push_back( XMFLOAT3( float( i ) * scale - size / 2, y, float( j ) * scale - size / 2 ) );
+            }
+        }
+
+        for( size_t i = 0; i < gridSize; ++i )
+        {
+            for( size_t j = 0; j < gridSize; ++j )
+            {
+                const index_t p00 = index_t( i * stride + j );
+                const index_t p01 = index_t( i * stride + j + 1 );
+                const index_t p10 = index_t( ( i + 1 ) * stride + j );
+                const index_t p11 = index_t( ( i + 1 ) * stride + j + 1 );
+
+                // Alternate the diagonal to avoid a directional bias in the triangulation
+                if ( ( i + j ) & 1 )
+                {
+                    const index_t tris[6] = { p00, p01, p11,  p00, p11, p10 };
+                    indices.insert( indices.end(), tris, tris + 6 );
+                }
+                else
+                {
+                    const index_t tris[6] = { p00, p01, p10,  p01, p11, p10 };
+                    indices.insert( indices.end(), tris, tris + 6 );
+                }
+            }
+        }
+    }
+
+    // A closed slab of gridSize x gridSize cells with up to 'holes' square through-holes,
+    // giving a surface of genus 'holes'
+    static void CreatePlateWithHoles( std::vector<index_t>& indices, std::vector<DirectX::XMFLOAT3>& positions, float size, float thickness, size_t gridSize, size_t holes )
+    {
+        using namespace DirectX;
+
+        indices.clear();
+        positions.clear();
+
+        gridSize = std::max<size_t>( 3, gridSize );
+
+        // Holes sit in the middle of a lattice of blocks so they never touch each other
+        // or the outside edge, which keeps the surface manifold
+        size_t lattice = 1;
+        while ( lattice * lattice < holes )
+            ++lattice;
+
+        const size_t block = gridSize / lattice;
+        const size_t holeSize = ( block >= 3 ) ? std::max<size_t>( 1, block / 2 ) : 0;
+
+        std::vector<uint8_t> solid( gridSize * gridSize, 1 );
+        if ( holeSize > 0 )
+        {
+            for( size_t h = 0; h < holes; ++h )
+            {
+                const size_t bx = ( h % lattice ) * block + ( block - holeSize ) / 2;
+                const size_t bz = ( h / lattice ) * block + ( block - holeSize ) / 2;
+
+                for( size_t i = bx; i < bx + holeSize; ++i )
+                    for( size_t j = bz; j < bz + holeSize; ++j )
+                        solid[ i * gridSize + j ] = 0;
+            }
+        }
+
+        const size_t stride = gridSize + 1;
+        const size_t gridVerts = stride * stride;
+        CheckVertexCount( uint64_t( gridVerts ) * 2 );
+
+        const float scale = size / float( gridSize );
+        positions.reserve( gridVerts * 2 );
+        for( size_t layer = 0; layer < 2; ++layer )
+        {
+            const float y = ( layer == 0 ) ? ( thickness / 2 ) : ( -thickness / 2 );
+            for( size_t i = 0; i <= gridSize; ++i )
+                for( size_t j = 0; j <= gridSize; ++j )
+                    positions.push_back( XMFLOAT3( float( i ) * scale - size / 2, y, float( j ) * scale - size / 2 ) );
+        }
+
+        auto isSolid = [&]( ptrdiff_t i, ptrdiff_t j ) -> bool
+        {
+            if ( i < 0 || j < 0 || i >= ptrdiff_t( gridSize ) || j >= ptrdiff_t( gridSize ) )
+                return false;
+            return solid[ size_t( i ) * gridSize + size_t( j ) ] != 0;
+        };
+
+        for( size_t i = 0; i < gridSize; ++i )
+        {
+            for( size_t j = 0; j < gridSize; ++j )
+            {
+                if ( !solid[ i * gridSize + j ] )
+                    continue;
+
+                // Cell outline p00 -> p01 -> p11 -> p10 on top, reversed on the bottom
+                const index_t p[4] =
+                {
+                    index_t( i * stride + j ),
+                    index_t( i * stride + j + 1 ),
+                    index_t( ( i + 1 ) * stride + j + 1 ),
+                    index_t( ( i + 1 ) * stride + j ),
+                };
+
+                const index_t q[4] =
+                {
+                    index_t( p[0] + gridVerts ), index_t( p[1] + gridVerts ), index_t( p[2] + gridVerts ), index_t( p[3] + gridVerts ),
+                };
+
+                const index_t tris[12] =
+                {
+                    p[0], p[1], p[2],  p[0], p[2], p[3],
+                    q[0], q[2], q[1],  q[0], q[3], q[2],
+                };
+                indices.insert( indices.end(), tris, tris + 12 );
+
+                // Side walls where the outline borders a hole or the outside
+                const bool open[4] =
+                {
+                    !isSolid( ptrdiff_t( i ) - 1, ptrdiff_t( j ) ),
+                    !isSolid( ptrdiff_t( i ), ptrdiff_t( j ) + 1 ),
+                    !isSolid( ptrdiff_t( i ) + 1, ptrdiff_t( j ) ),
+                    !isSolid( ptrdiff_t( i ), ptrdiff_t( j ) - 1 ),
+                };
+
+                for( size_t e = 0; e < 4; ++e )
+                {
+                    if ( !open[e] )
+                        continue;
+
+                    const size_t a = e;
+                    const size_t b = ( e + 1 ) & 3;
+
+                    const index_t wall[6] = { p[b], p[a], q[a],  p[b], q[a], q[b] };
+                    indices.insert( indices.end(), wall, wall + 6 );
+                }
+            }
+        }
+
+        RemoveUnusedVertices( indices, positions );
+    }
+
+    // 'components' disconnected parts of roughly facesPerComponent triangles each, randomly
+    // placed: noisy rocks (subdivided spheres) and rings (tori)
+    static void CreateClutter( std::vector<index_t>& indices, std::vector<DirectX::XMFLOAT3>& positions, size_t components, size_t facesPerComponent, uint32_t seed )
+    {
+        using namespace DirectX;
+
+        indices.clear();
+        positions.clear();
+
+        components = std::max<size_t>( 1, components );
+        facesPerComponent = std::max<size_t>( 20, facesPerComponent );
+
+        size_t rockLevel = 0;
+        while ( ( size_t(20) << ( 2 * ( rockLevel + 1 ) ) ) <= facesPerComponent * 2 )
+            ++rockLevel;
+
+        // Ring with major:minor tessellation of 2:1
+        const auto ringMinor = std::max<size_t>( 3, static_cast<size_t>( std::sqrt( double( facesPerComponent ) / 4.0 ) ) );
+        const size_t ringMajor = ringMinor * 2;
+
+        const uint64_t rockVerts = 10 * ( uint64_t(1) << ( 2 * rockLevel ) ) + 2;
+        const uint64_t ringVerts = uint64_t( ringMajor ) * ringMinor;
+        CheckVertexCount( ( ( components + 1 ) / 2 ) * rockVerts + ( components / 2 ) * ringVerts );
+
+        Random rng( seed );
+
+        // Scatter in a cube that grows with the part count so parts rarely intersect
+        const float extent = 2.f * std::cbrt( float( components ) );
+
+        std::vector<index_t> partIndices;
+        std::vector<XMFLOAT3> partPositions;
+
+        for( size_t c = 0; c < components; ++c )
+        {
+            if ( c & 1 )
+            {
+                CreateRing( partIndices, partPositions, 0.5f, 0.15f, ringMajor, ringMinor );
+            }
+            else
+            {
+                CreateGeodesicSphere( partIndices, partPositions, 0.6f, rockLevel );
+
+                // Lumpy surface
+                const uint32_t rockSeed = rng.Next();
+                for( auto& it : partPositions )
+                {
+                    const float n = FractalNoise( it.x * 6.f + it.z * 3.f, it.y * 6.f - it.z * 3.f, rockSeed );
+                    const float s = 0.8f + 0.4f * n;
+                    it.x *= s;
+                    it.y *= s;
+                    it.z *= s;
+                }
+            }
+
+            const float scaleX = 0.5f + rng.NextFloat();
+            const float scaleY = 0.5f + rng.NextFloat();
+            const float scaleZ = 0.5f + rng.NextFloat();
+
+            XMMATRIX transform = XMMatrixMultiply(
+                XMMatrixScaling( scaleX, scaleY, scaleZ ),
+                XMMatrixMultiply(
+                    XMMatrixRotationRollPitchYaw( rng.NextFloat() * XM_2PI, rng.NextFloat() * XM_2PI, rng.NextFloat() * XM_2PI ),
+                    XMMatrixTranslation( ( rng.NextFloat() - 0.5f ) * extent, ( rng.NextFloat() - 0.5f ) * extent, ( rng.NextFloat() - 0.5f ) * extent ) ) );
+
+            const size_t base = positions.size();
+            for( const auto& it : partPositions )
+            {
+                XMFLOAT3 p;
+                XMStoreFloat3( &p, XMVector3TransformCoord( XMLoadFloat3( &it ), transform ) );
+                positions.push_back( p );
+            }
+
+            for( auto it : partIndices )
+            {
+                indices.push_back( index_t( base + it ) );
+            }
+        }
+    }
+
+    // Welded torus with major x minor quads
+    static void CreateRing( std::vector<index_t>& indices, std::vector<DirectX::XMFLOAT3>& positions, float radius, float thickness, size_t major, size_t minor )
+    {
+        using namespace DirectX;
+
+        indices.clear();
+        positions.clear();
+
+        major = std::max<size_t>( 3, major );
+        minor = std::max<size_t>( 3, minor );
+        CheckVertexCount( uint64_t( major ) * minor );
+
+        positions.reserve( major * minor );
+        indices.reserve( major * minor * 6 );
+
+        for( size_t i = 0; i < major; ++i )
+        {
+            float so, co;
+            XMScalarSinCos( &so, &co, float( i ) * XM_2PI / float( major ) );
+
+            for( size_t j = 0; j < minor; ++j )
+            {
+                float si, ci;
+                XMScalarSinCos( &si, &ci, float( j ) * XM_2PI / float( minor ) );
+
+                const float r = radius + thickness * ci;
+                positions.push_back( XMFLOAT3( r * co, thickness * si, r * so ) );
+            }
+        }
+
+        for( size_t i = 0; i < major; ++i )
+        {
+            const size_t nextI = ( i + 1 ) % major;
+            for( size_t j = 0; j < minor; ++j )
+            {
+                const size_t nextJ = ( j + 1 ) % minor;
+
+                const index_t p00 = index_t( i * minor + j );
+                const index_t p01 = index_t( i * minor + nextJ );
+                const index_t p10 = index_t( nextI * minor + j );
+                const index_t p11 = index_t( nextI * minor + nextJ );
+
+                const index_t tris[6] = { p00, p01, p11,  p00, p11, p10 };
+                indices.insert( indices.end(), tris, tris + 6 );
+            }
+        }
+    }
+
+    // Edge-adjacency in the layout UVAtlas expects: entry 3*face+edge is the face across the
+    // edge from corner 'edge' to corner 'edge+1', or uint32_t(-1) for a boundary. Assumes
+    // consistently wound, welded geometry; linear time and no hashing, so it scales to
+    // very large meshes.
+    static void ComputeAdjacency( const index_t* indices, size_t nFaces, size_t nVerts, uint32_t* adjacency )
+    {
+        assert( indices != nullptr && adjacency != nullptr );
+
+        if ( uint64_t( nFaces ) * 3 >= UINT32_MAX )
+            throw std::overflow_error( "MeshGenerator::ComputeAdjacency face count too large" );
+
+        // Half-edges bucketed by their start vertex
+        std::vector<uint32_t> offsets( nVerts + 1, 0 );
+        for( size_t j = 0; j < nFaces * 3; ++j )
+        {
+            ++offsets[ size_t( indices[ j ] ) + 1 ];
+        }
+
+        for( size_t j = 0; j < nVerts; ++j )
+        {
+            offsets[ j + 1 ] += offsets[ j ];
+        }
+
+        struct HalfEdge
+        {
+            uint32_t end;
+            uint32_t faceEdge;
+        };
+
+        std::vector<HalfEdge> edges( nFaces * 3 );
+        {
+            std::vector<uint32_t> fill( offsets.begin(), offsets.end() - 1 );
+            for( size_t face = 0; face < nFaces; ++face )
+            {
+                for( size_t edge = 0; edge < 3; ++edge )
+                {
+                    const size_t start = indices[ face * 3 + edge ];
+                    const uint32_t end = uint32_t( indices[ face * 3 + ( edge + 1 ) % 3 ] );
+                    edges[ fill[ start ]++ ] = { end, uint32_t( face * 3 + edge ) };
+                }
+            }
+        }
+
+        // The neighbor across (a,b) owns the opposite half-edge (b,a)
+        for( size_t face = 0; face < nFaces; ++face )
+        {
+            for( size_t edge = 0; edge < 3; ++edge )
+            {
+                const uint32_t a = uint32_t( indices[ face * 3 + edge ] );
+                const size_t b = indices[ face * 3 + ( edge + 1 ) % 3 ];
+
+                uint32_t neighbor = uint32_t(-1);
+                for( uint32_t k = offsets[ b ]; k < offsets[ b + 1 ]; ++k )
+                {
+                    if ( edges[ k ].end == a && ( edges[ k ].faceEdge / 3 ) != face )
+                    {
+                        neighbor = edges[ k ].faceEdge / 3;
+                        break;
+                    }
+                }
+
+                adjacency[ face * 3 + edge ] = neighbor;
+            }
+        }
+    }
+
+private:
+    // Small portable PRNG (xorshift32) so results match across standard libraries
+    struct Random
+    {
+        uint32_t state;
+
+        explicit Random( uint32_t seed ) : state( seed ? seed : 0x9E3779B9u ) {}
+
+        uint32_t Next()
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state;
+        }
+
+        // [0, 1)
+        float NextFloat()
+        {
+            return float( Next() >> 8 ) * ( 1.f / 16777216.f );
+        }
+    };
+
+    static void CheckVertexCount( uint64_t nVerts )
+    {
+        if ( nVerts > uint64_t( std::numeric_limits<index_t>::max() ) )
+            throw std::overflow_error( "MeshGenerator vertex count exceeds the index format" );
+    }
+
+    static float LatticeValue( int32_t x, int32_t z, uint32_t seed )
+    {
+        uint32_t h = seed ^ ( uint32_t( x ) * 0x8DA6B343u ) ^ ( uint32_t( z ) * 0xD8163841u );
+        h ^= h >> 13;
+        h *= 0x5BD1E995u;
+        h ^= h >> 15;
+        return float( h & 0xFFFFFF ) * ( 1.f / 16777215.f );
+    }
+
+    static float ValueNoise( float x, float z, uint32_t seed )
+    {
+        const float fx = std::floor( x );
+        const float fz = std::floor( z );
+        const auto ix = static_cast<int32_t>( fx );
+        const auto iz = static_cast<int32_t>( fz );
+
+        float tx = x - fx;
+        float tz = z - fz;
+        tx = tx * tx * ( 3.f - 2.f * tx );
+        tz = tz * tz * ( 3.f - 2.f * tz );
+
+        const float v00 = LatticeValue( ix, iz, seed );
+        const float v10 = LatticeValue( ix + 1, iz, seed );
+        const float v01 = LatticeValue( ix, iz + 1, seed );
+        const float v11 = LatticeValue( ix + 1, iz + 1, seed );
+
+        const float a = v00 + ( v10 - v00 ) * tx;
+        const float b = v01 + ( v11 - v01 ) * tx;
+        return a + ( b - a ) * tz;
+    }
+
+    // Five octaves of value noise, in [0, 1)
+    static float FractalNoise( float x, float z, uint32_t seed )
+    {
+        float sum = 0.f;
+        float amplitude = 0.5f;
+        float frequency = 1.f;
+        for( uint32_t octave = 0; octave < 5; ++octave )
+        {
+            sum += amplitude * ValueNoise( x * frequency, z * frequency, seed + octave * 0x9E3779B9u );
+            amplitude *= 0.5f;
+            frequency *= 2.f;
+        }
+        return sum;
+    }
+
+    static void RemoveUnusedVertices( std::vector<index_t>& indices, std::vector<DirectX::XMFLOAT3>& positions )
+    {
+        std::vector<uint32_t> remap( positions.size(), uint32_t(-1) );
+        for( auto it : indices )
+            remap[ it ] = 0;
+
+        size_t count = 0;
+        for( size_t j = 0; j < positions.size(); ++j )
+        {
+            if ( remap[ j ] != uint32_t(-1) )
+            {
+                remap[ j ] = uint32_t( count );
+                positions[ count++ ] = positions[ j ];
+            }
+        }
+        positions.resize( count );
+
+        for( auto& it : indices )
+            it = index_t( remap[ it ] );
+    }
+};
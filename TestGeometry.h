@@ -17,7 +17,7 @@ namespace TestGeometry
 {
 
 //--- Cube ----------------------------------------------------------------------------
-extern const __declspec(selectany) DirectX::XMFLOAT3 g_cubeVerts[ 8 ] =
+extern const SELECTANY DirectX::XMFLOAT3 g_cubeVerts[ 8 ] =
     {
         DirectX::XMFLOAT3( 0.f, 0.f, 0.f ),
         DirectX::XMFLOAT3( 1.f, 1.f, 0.f ),
@@ -29,7 +29,7 @@ extern const __declspec(selectany) DirectX::XMFLOAT3 g_cubeVerts[ 8 ] =
         DirectX::XMFLOAT3( 1.f, 0.f, 1.f ),
     };
 
-extern const __declspec(selectany) uint16_t g_cubeIndices16[ 12*3 ] =
+extern const SELECTANY uint16_t g_cubeIndices16[ 12*3 ] =
     {
         0, 1, 2,
         0, 3, 1,
@@ -45,7 +45,7 @@ extern const __declspec(selectany) uint16_t g_cubeIndices16[ 12*3 ] =
         5, 6, 4,
     };
 
-extern const __declspec(selectany) uint32_t g_cubeIndices32[ 12*3 ] =
+extern const SELECTANY uint32_t g_cubeIndices32[ 12*3 ] =
     {
         0, 1, 2,
         0, 3, 1,
@@ -63,7 +63,7 @@ extern const __declspec(selectany) uint32_t g_cubeIndices32[ 12*3 ] =
 
 
 //--- Face-mapped Cube ----------------------------------------------------------------
-extern const __declspec(selectany) DirectX::XMFLOAT3 g_fmCubeVerts[ 24 ] =
+extern const SELECTANY DirectX::XMFLOAT3 g_fmCubeVerts[ 24 ] =
     {
         DirectX::XMFLOAT3( -1.0f, 1.0f, -1.0f ),
         DirectX::XMFLOAT3( 1.0f, 1.0f, -1.0f ),
@@ -96,7 +96,7 @@ extern const __declspec(selectany) DirectX::XMFLOAT3 g_fmCubeVerts[ 24 ] =
         DirectX::XMFLOAT3( -1.0f, 1.0f, 1.0f ),
     };
 
-extern const __declspec(selectany) DirectX::XMFLOAT2 g_fmCubeUVs[ 24 ] =
+extern const SELECTANY DirectX::XMFLOAT2 g_fmCubeUVs[ 24 ] =
     {
         DirectX::XMFLOAT2( 1.0f, 0.0f ),
         DirectX::XMFLOAT2( 0.0f, 0.0f ),
@@ -129,7 +129,7 @@ extern const __declspec(selectany) DirectX::XMFLOAT2 g_fmCubeUVs[ 24 ] =
         DirectX::XMFLOAT2( 1.0f, 0.0f ),
     };
 
-extern const __declspec(selectany) uint16_t g_fmCubeIndices16[ 12*3 ] =
+extern const SELECTANY uint16_t g_fmCubeIndices16[ 12*3 ] =
     {
         3,1,0,
         2,1,3,
@@ -150,7 +150,7 @@ extern const __declspec(selectany) uint16_t g_fmCubeIndices16[ 12*3 ] =
         23,20,22
     };
 
-extern const __declspec(selectany) uint32_t g_fmCubeIndices32[ 12*3 ] =
+extern const SELECTANY uint32_t g_fmCubeIndices32[ 12*3 ] =
     {
         3,1,0,
         2,1,3,
@@ -171,7 +171,7 @@ extern const __declspec(selectany) uint32_t g_fmCubeIndices32[ 12*3 ] =
         23,20,22
     };
 
-extern const __declspec(selectany) uint32_t g_fmCubeAttributes[ 12 ] =
+extern const SELECTANY uint32_t g_fmCubeAttributes[ 12 ] =
     {
         0, 0,
         1, 1,
@@ -183,7 +183,7 @@ extern const __declspec(selectany) uint32_t g_fmCubeAttributes[ 12 ] =
 
 
 //--- Box (aka cuboid or rectangular parallelepiped) ----------------------------------
-extern const __declspec(selectany) DirectX::XMFLOAT3 g_boxVerts[ 8 ] =
+extern const SELECTANY DirectX::XMFLOAT3 g_boxVerts[ 8 ] =
     {
         DirectX::XMFLOAT3( 0.f, 0.f, 0.f ),
         DirectX::XMFLOAT3( 4.f, 2.f, 0.f ),
@@ -195,7 +195,7 @@ extern const __declspec(selectany) DirectX::XMFLOAT3 g_boxVerts[ 8 ] =
         DirectX::XMFLOAT3( 4.f, 0.f, 1.f ),
     };
 
-extern const __declspec(selectany) uint16_t g_boxIndices16[ 12*3 ] =
+extern const SELECTANY uint16_t g_boxIndices16[ 12*3 ] =
     {
         0, 1, 2,
         0, 3, 1,
@@ -211,7 +211,7 @@ extern const __declspec(selectany) uint16_t g_boxIndices16[ 12*3 ] =
         5, 6, 4,
     };
 
-extern const __declspec(selectany) uint32_t g_boxIndices32[ 12*3 ] =
+extern const SELECTANY uint32_t g_boxIndices32[ 12*3 ] =
     {
         0, 1, 2,
         0, 3, 1,
@@ -229,7 +229,7 @@ extern const __declspec(selectany) uint32_t g_boxIndices32[ 12*3 ] =
 
 
 //--- Tetrahedron ---------------------------------------------------------------------
-extern const __declspec(selectany) DirectX::XMFLOAT3 g_tetraVerts[ 4 ] =
+extern const SELECTANY DirectX::XMFLOAT3 g_tetraVerts[ 4 ] =
     {
         DirectX::XMFLOAT3( 1.f, 1.f, 1.f ),
         DirectX::XMFLOAT3( 1.f, 2.f, 1.f ),
@@ -237,7 +237,7 @@ extern const __declspec(selectany) DirectX::XMFLOAT3 g_tetraVerts[ 4 ] =
         DirectX::XMFLOAT3( 1.f, 1.f, 2.f ),
     };
 
-extern const __declspec(selectany) uint16_t g_tetraIndices16[ 4*3 ] =
+extern const SELECTANY uint16_t g_tetraIndices16[ 4*3 ] =
     {
         0, 1, 2,
         1, 2, 0,
@@ -245,7 +245,7 @@ extern const __declspec(selectany) uint16_t g_tetraIndices16[ 4*3 ] =
         0, 3, 1,
     };
 
-extern const __declspec(selectany) uint32_t g_tetraIndices32[ 4*3 ] =
+extern const SELECTANY uint32_t g_tetraIndices32[ 4*3 ] =
     {
         0, 1, 2,
         1, 2, 0,
@@ -255,7 +255,7 @@ extern const __declspec(selectany) uint32_t g_tetraIndices32[ 4*3 ] =
 
 
 //--- Bowtie --------------------------------------------------------------------------
-extern const __declspec(selectany) DirectX::XMFLOAT3 g_bowtieVerts[ 5 ] =
+extern const SELECTANY DirectX::XMFLOAT3 g_bowtieVerts[ 5 ] =
     {
         DirectX::XMFLOAT3( -1.f, 1.f, 0.f ),
         DirectX::XMFLOAT3( -1.f, -1.f, 0.f ),
@@ -264,13 +264,13 @@ extern const __declspec(selectany) DirectX::XMFLOAT3 g_bowtieVerts[ 5 ] =
         DirectX::XMFLOAT3( 1.f, -1.f, 0.f ),
     };
 
-extern const __declspec(selectany) uint16_t g_bowtieIndices16[ 2*3 ] =
+extern const SELECTANY uint16_t g_bowtieIndices16[ 2*3 ] =
     {
         0, 1, 2,
         2, 4, 3
     };
 
-extern const __declspec(selectany) uint32_t g_bowtieIndices32[ 2*3 ] =
+extern const SELECTANY uint32_t g_bowtieIndices32[ 2*3 ] =
     {
         0, 1, 2,
         2, 4, 3
@@ -278,20 +278,20 @@ extern const __declspec(selectany) uint32_t g_bowtieIndices32[ 2*3 ] =
 
 
 //--- Backfacing ----------------------------------------------------------------------
-extern const __declspec(selectany) DirectX::XMFLOAT3 g_backfaceVerts[ 3 ] =
+extern const SELECTANY DirectX::XMFLOAT3 g_backfaceVerts[ 3 ] =
     {
         DirectX::XMFLOAT3( 0.f, 0.f, 0.f ),
         DirectX::XMFLOAT3( 1.f, 0.f, 0.f ),
         DirectX::XMFLOAT3( 1.f, 1.f, 0.f ),
     };
 
-extern const __declspec(selectany) uint16_t g_backfaceIndices16[ 2*3 ] =
+extern const SELECTANY uint16_t g_backfaceIndices16[ 2*3 ] =
     {
         0, 1, 2,
         2, 1, 0,
     };
 
-extern const __declspec(selectany) uint32_t g_backfaceIndices32[ 2*3 ] =
+extern const SELECTANY uint32_t g_backfaceIndices32[ 2*3 ] =
     {
         0, 1, 2,
         2, 1, 0,
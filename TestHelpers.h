@@ -11,7 +11,9 @@
 
 #pragma once
 
+#ifdef _WIN32
 #include <cguid.h>
+#endif
 
 #include <algorithm>
 #include <memory>
@@ -104,8 +106,9 @@ inline bool IsTestIBCorrect( const T* ib, size_t count, IB_TEST_TYPE fillType )
 
 
 //--------------------------------------------------------------------------------------
-extern const __declspec(selectany) GUID g_VBGuid = { 0xc129d450, 0x922e, 0x4655, { 0xb0, 0x98, 0xf6, 0x1e, 0xfe, 0xd7, 0xb7, 0x6d } };
-extern const __declspec(selectany) GUID g_VBGuid2 = { 0x92f9af91, 0xe870, 0x45f2, { 0x98, 0x8c, 0x29, 0xb4, 0x34, 0x82, 0xc6, 0x14 } };
+extern const SELECTANY GUID g_VBGuid = { 0xc129d450, 0x922e, 0x4655, { 0xb0, 0x98, 0xf6, 0x1e, 0xfe, 0xd7, 0xb7, 0x6d } };
+extern const SELECTANY GUID g_VBGuid2 = { 0x92f9af91, 0xe870, 0x45f2, { 0x98, 0x8c, 0x29, 0xb4, 0x34, 0x82, 0xc6, 0x14 } };
+extern const SELECTANY GUID g_VBNullGuid = {};
 
 static_assert ( sizeof(GUID) == 16, "Size mismatch" );
 
@@ -273,13 +276,13 @@ inline bool IsTestVBCorrect32( const uint8_t* vb, size_t count, VB_FILL_TYPE fil
             for( size_t j = 0; j < count; ++j )
             {
                 if ( memcmp( reinterpret_cast<const BYTE*>(ptr),
-                             reinterpret_cast<const BYTE*>(&GUID_NULL), sizeof(GUID) ) != 0 )
+                             reinterpret_cast<const BYTE*>(&g_VBNullGuid), sizeof(GUID) ) != 0 )
                     return false;
 
                 ptr += 2;
 
                 if ( memcmp( reinterpret_cast<const BYTE*>(ptr2),
-                             reinterpret_cast<const BYTE*>(&GUID_NULL), sizeof(GUID) ) != 0 )
+                             reinterpret_cast<const BYTE*>(&g_VBNullGuid), sizeof(GUID) ) != 0 )
                     return false;
 
                 ptr2 += 2;
@@ -393,7 +396,7 @@ inline bool IsTestVBCorrect16( const uint8_t* vb, size_t count, VB_FILL_TYPE fil
             for( size_t j = 0; j < count; ++j )
             {
                 if ( memcmp( reinterpret_cast<const BYTE*>(ptr),
-                             reinterpret_cast<const BYTE*>(&GUID_NULL), sizeof(GUID) ) != 0 )
+                             reinterpret_cast<const BYTE*>(&g_VBNullGuid), sizeof(GUID) ) != 0 )
                     return false;
 
                 ++ptr;
@@ -407,7 +410,7 @@ inline bool IsTestVBCorrect16( const uint8_t* vb, size_t count, VB_FILL_TYPE fil
 
 
 //--------------------------------------------------------------------------------------
-extern const __declspec(selectany) DirectX::XMVECTORF32 g_MeshEpsilon = { { { 1.192092896e-6f, 1.192092896e-6f, 1.192092896e-6f, 1.192092896e-6f } } };
+extern const SELECTANY DirectX::XMVECTORF32 g_MeshEpsilon = { { { 1.192092896e-6f, 1.192092896e-6f, 1.192092896e-6f, 1.192092896e-6f } } };
 
 inline bool CompareArray( const DirectX::XMFLOAT3* a, const DirectX::XMFLOAT3* b, size_t count )
 {
@@ -5,12 +5,26 @@
 //-------------------------------------------------------------------------------------
 
 #include "directxtest.h"
+
+#include <chrono>
+#include <memory>
+#include <set>
+#include <type_traits>
+#include <utility>
+
 #include "TestHelpers.h"
 #include "TestGeometry.h"
+#include "MeshGenerator.h"
 #include "ShapesGenerator.h"
+#include "parallelatlas.h"
+#include "bitsetpacker.h"
+#include "atlasmetrics.h"
+#include "partitioncache.h"
+#include "uvatlastyped.h"
 
 #include "UVAtlas.h"
 #include "DirectXMesh.h"
+#include "WaveFrontReader.h"
 
 using namespace DirectX;
 using namespace TestGeometry;
@@ -104,14 +118,104 @@ static inline bool VerifyVertices( const XMFLOAT3* pos, size_t nVerts, const UVA
 }
 
 
+//-------------------------------------------------------------------------------------
+// Prints the packing quality of a UVAtlasCreate result. The values depend on the packer,
+// so nothing is asserted here beyond the call succeeding; Test20 checks the metrics.
+static bool ReportAtlasMetrics( const char* name, const std::vector<UVAtlasVertex>& vb, const std::vector<uint8_t>& ib, DXGI_FORMAT indexFormat,
+                                const std::vector<uint32_t>& facePart, size_t width, size_t height, float gutter )
+{
+    const size_t indexSize = ( indexFormat == DXGI_FORMAT_R16_UINT ) ? sizeof(uint16_t) : sizeof(uint32_t);
+
+    UVAtlasMetrics metrics;
+    HRESULT hr = UVAtlasComputeMetrics( vb.data(), vb.size(), ib.data(), indexFormat, ib.size() / ( indexSize * 3 ), facePart.data(),
+                                        width, height, gutter, metrics );
+    if ( FAILED(hr) )
+    {
+        printe( "\nERROR: atlas metrics [%s] failed (%08X)\n", name, static_cast<unsigned int>(hr) );
+        return false;
+    }
+
+    print( "\n\t%s: coverage %.3f, %zu overlap texels, %zu gutter violations, texel density %.2f..%.2f",
+           name, metrics.coverage, metrics.overlapTexels, metrics.gutterViolations, metrics.minTexelDensity, metrics.maxTexelDensity );
+
+    return true;
+}
+
+
+//-------------------------------------------------------------------------------------
+// 128-bit digest of the atlas outputs for bitwise comparisons (two FNV-1a lanes, not
+// cryptographic). Sizes are folded in so that moving bytes between arrays changes it.
+namespace
+{
+    struct AtlasDigest
+    {
+        uint64_t lane[2];
+
+        AtlasDigest() noexcept : lane{ 0xcbf29ce484222325ull, 0x84222325cbf29ce4ull } {}
+
+        void Add( const void* data, size_t size ) noexcept
+        {
+            auto ptr = static_cast<const uint8_t*>( data );
+            for( size_t j = 0; j < size; ++j )
+            {
+                lane[0] = ( lane[0] ^ ptr[j] ) * 0x100000001b3ull;
+                lane[1] = ( lane[1] ^ ptr[j] ^ ( lane[0] >> 32 ) ) * 0x100000001b3ull;
+            }
+        }
+
+        template<typename T>
+        void Add( const std::vector<T>& data ) noexcept
+        {
+            const uint64_t size = data.size();
+            Add( &size, sizeof(size) );
+            Add( data.data(), data.size() * sizeof(T) );
+        }
+
+        void GetBytes( uint8_t digest[16] ) const noexcept
+        {
+            for( size_t j = 0; j < 16; ++j )
+            {
+                digest[j] = static_cast<uint8_t>( lane[j / 8] >> ( ( j % 8 ) * 8 ) );
+            }
+        }
+
+        bool operator == ( const AtlasDigest& other ) const noexcept
+        {
+            return lane[0] == other.lane[0] && lane[1] == other.lane[1];
+        }
+    };
+
+    static_assert( sizeof(UVAtlasVertex) == sizeof(XMFLOAT3) + sizeof(XMFLOAT2), "UVAtlasVertex must not have padding to be hashed" );
+
+    AtlasDigest ComputeAtlasDigest(
+        const std::vector<UVAtlasVertex>& vb, const std::vector<uint8_t>& ib,
+        const std::vector<uint32_t>& facePart, const std::vector<uint32_t>& remap ) noexcept
+    {
+        AtlasDigest digest;
+        digest.Add( vb );
+        digest.Add( ib );
+        digest.Add( facePart );
+        digest.Add( remap );
+        return digest;
+    }
+
+    void PrintAtlasDigest( const char* label, const AtlasDigest& digest )
+    {
+        uint8_t bytes[16];
+        digest.GetBytes( bytes );
+        printdigest( label, bytes );
+    }
+}
+
+
 //-------------------------------------------------------------------------------------
 static HRESULT __cdecl UVAtlasCallback( float fPercentDone  )
 {
     UNREFERENCED_PARAMETER(fPercentDone);
 
-    static ULONGLONG s_lastTick = 0;
+    static thread_local uint64_t s_lastTick = 0;
 
-    ULONGLONG tick = GetTickCount64();
+    uint64_t tick = GetTickMS();
 
     if ( ( tick - s_lastTick ) > 1000 )
     {
@@ -246,6 +350,10 @@ bool Test01()
                     printe( "\nERROR: Invalid index buffer from create atlas [fmcube16] (%08X):%S\n", static_cast<unsigned int>(hr), msgs.c_str() );
                     success = false;
                 }
+                else if ( !ReportAtlasMetrics( "fmcube16", vb, ib, DXGI_FORMAT_R16_UINT, facePart, 512, 512, 1.f ) )
+                {
+                    success = false;
+                }
             }
         }
 
@@ -646,6 +754,10 @@ bool Test01()
                     printe( "\nERROR: Invalid index buffer from create atlas [fmcube16] gutter (%08X):%S\n", static_cast<unsigned int>(hr), msgs.c_str() );
                     success = false;
                 }
+                else if ( !ReportAtlasMetrics( "fmcube16 gutter", vb, ib, DXGI_FORMAT_R16_UINT, facePart, 512, 512, 2.5f ) )
+                {
+                    success = false;
+                }
             }
         }
 
@@ -981,6 +1093,10 @@ bool Test01()
                     printe( "\nERROR: Invalid index buffer from create atlas [fmcube32] (%08X):%S\n", static_cast<unsigned int>(hr), msgs.c_str() );
                     success = false;
                 }
+                else if ( !ReportAtlasMetrics( "fmcube32", vb, ib, DXGI_FORMAT_R32_UINT, facePart, 512, 512, 1.f ) )
+                {
+                    success = false;
+                }
             }
         }
     }
@@ -2088,3 +2204,1343 @@ bool Test03()
 
     return success;
 }
+
+
+//-------------------------------------------------------------------------------------
+// UVAtlasCreate (parallel)
+bool Test13()
+{
+    bool success = true;
+    HRESULT hr;
+
+    // invalid args (same validation as UVAtlasCreate)
+    #pragma warning(push)
+    #pragma warning(disable : 6385 6387)
+    {
+        std::vector<UVAtlasVertex> vb;
+        std::vector<uint8_t> ib;
+        hr = UVAtlasCreateParallel( g_fmCubeVerts, 24, g_fmCubeIndices16, DXGI_FORMAT_R8G8B8A8_UNORM, 12,
+                                    0, 0.f, 512, 512, 1.f,
+                                    s_fmCubeAdj, nullptr, nullptr, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                                    UVATLAS_DEFAULT, 4, vb, ib, nullptr, nullptr, nullptr, nullptr );
+        if ( hr != E_INVALIDARG )
+        {
+            printe( "\nERROR: expected failure for wrong DXGI format\n" );
+            success = false;
+        }
+
+        hr = UVAtlasCreateParallel( g_fmCubeVerts, 24, g_fmCubeIndices16, DXGI_FORMAT_R16_UINT, 12,
+                                    0, 0.f, 512, 512, 1.f,
+                                    nullptr, nullptr, nullptr, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                                    UVATLAS_DEFAULT, 4, vb, ib, nullptr, nullptr, nullptr, nullptr );
+        if ( hr != E_INVALIDARG )
+        {
+            printe( "\nERROR: expected failure for missing adj\n" );
+            success = false;
+        }
+    }
+    #pragma warning(pop)
+
+    // 16-bit cube (one component, so this is UVAtlasCreate)
+    {
+        std::vector<UVAtlasVertex> vb;
+        std::vector<uint8_t> ib;
+        std::vector<uint32_t> facePart;
+        std::vector<uint32_t> remap;
+        float maxStretch = 0.f;
+        size_t numCharts = 0;
+        hr = UVAtlasCreateParallel( g_fmCubeVerts, 24, g_fmCubeIndices16, DXGI_FORMAT_R16_UINT, 12,
+                                    0, 0.f, 512, 512, 1.f,
+                                    s_fmCubeAdj, nullptr, nullptr, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                                    UVATLAS_DEFAULT, 4, vb, ib, &facePart, &remap, &maxStretch, &numCharts );
+        if (FAILED(hr))
+        {
+            printe( "\nERROR: create atlas parallel [fmcube16] failed (%08X)\n", static_cast<unsigned int>(hr) );
+            success = false;
+        }
+        else if ( ( ib.size() / (sizeof(uint16_t)*3) ) != 12
+                  || facePart.size() != 12
+                  || remap.size() != vb.size()
+                  || numCharts < 4 || numCharts > 6 )
+        {
+            printe( "\nERROR: Unexpected results from create atlas parallel [fmcube16]\n\tverts %zu\n\tface partitions %zu\n\tremap array %zu\n\tnumCharts %zu\n",
+                    vb.size(), facePart.size(), remap.size(), numCharts );
+            success = false;
+        }
+    }
+
+    // Many components, partitioned concurrently
+    for( size_t threads = 1; threads <= 8; threads *= 2 )
+    {
+        std::vector<uint32_t> indices;
+        std::vector<XMFLOAT3> pos;
+        std::vector<uint32_t> adj;
+        MeshGenerator<uint32_t>::Create( MeshGenerator<uint32_t>::KIND_CLUTTER, 8000, 1, indices, pos, adj );
+
+        const size_t nFaces = indices.size() / 3;
+
+        std::vector<UVAtlasVertex> vb;
+        std::vector<uint8_t> ib;
+        std::vector<uint32_t> facePart;
+        std::vector<uint32_t> remap;
+        float maxStretch = 0.f;
+        size_t numCharts = 0;
+        hr = UVAtlasCreateParallel( pos.data(), pos.size(), indices.data(), DXGI_FORMAT_R32_UINT, nFaces,
+                                    0, 0.f, 512, 512, 1.f,
+                                    adj.data(), nullptr, nullptr, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                                    UVATLAS_DEFAULT, threads, vb, ib, &facePart, &remap, &maxStretch, &numCharts );
+        if (FAILED(hr))
+        {
+            printe( "\nERROR: create atlas parallel [clutter, %zu threads] failed (%08X)\n", threads, static_cast<unsigned int>(hr) );
+            success = false;
+        }
+        else if ( vb.size() < pos.size()
+                  || ( ib.size() / (sizeof(uint32_t)*3) ) != nFaces
+                  || facePart.size() != nFaces
+                  || remap.size() != vb.size()
+                  || !numCharts )
+        {
+            printe( "\nERROR: Unexpected results from create atlas parallel [clutter, %zu threads]\n\tverts %zu\n\tfaces %zu (%zu bytes)\n\tface partitions %zu\n\tremap array %zu\n\tmaxStretch %f\n\tnumCharts %zu\n",
+                    threads, vb.size(), nFaces, ib.size(), facePart.size(), remap.size(), maxStretch, numCharts );
+            success = false;
+        }
+        else if ( !IsValidVertexRemap( reinterpret_cast<const uint32_t*>( ib.data() ), nFaces, remap.data(), vb.size(), true ) )
+        {
+            printe( "\nERROR: Vertex remap invalid from create atlas parallel [clutter, %zu threads]\n", threads );
+            success = false;
+        }
+        else if ( !IsValidFacePartition( facePart.data(), nFaces, numCharts ) )
+        {
+            printe( "\nERROR: Face partition invalid from create atlas parallel [clutter, %zu threads]\n", threads );
+            success = false;
+        }
+        else if ( !VerifyVertices( pos.data(), pos.size(), vb.data(), remap.data(), vb.size() ) )
+        {
+            printe( "\nERROR: Vertex data doesn't match remap [clutter, %zu threads]\n", threads );
+            success = false;
+        }
+        else
+        {
+            std::wstring msgs;
+            hr = Validate( reinterpret_cast<const uint32_t*>( ib.data() ), nFaces, vb.size(), nullptr, VALIDATE_DEFAULT, &msgs );
+            if ( FAILED(hr) )
+            {
+                printe( "\nERROR: Invalid index buffer from create atlas parallel [clutter, %zu threads] (%08X):%S\n", threads, static_cast<unsigned int>(hr), msgs.c_str() );
+                success = false;
+            }
+        }
+
+        // Every vertex must land inside the unit texture square after the combined pack
+        for( const auto& it : vb )
+        {
+            if ( it.uv.x < 0.f || it.uv.x > 1.f || it.uv.y < 0.f || it.uv.y > 1.f )
+            {
+                printe( "\nERROR: UV out of range from create atlas parallel [clutter, %zu threads]: %f, %f\n", threads, it.uv.x, it.uv.y );
+                success = false;
+                break;
+            }
+        }
+    }
+
+    // Two cubes and an unused face: the cubes are partitioned on separate workers and the
+    // unused face (-1 indices) must come back marked, not offset into the merged vertex buffer
+    {
+        std::vector<XMFLOAT3> pos( g_fmCubeVerts, g_fmCubeVerts + 24 );
+        for( size_t j = 0; j < 24; ++j )
+            pos.emplace_back( g_fmCubeVerts[j].x + 4.f, g_fmCubeVerts[j].y, g_fmCubeVerts[j].z );
+
+        std::vector<uint16_t> indices( g_fmCubeIndices16, g_fmCubeIndices16 + 36 );
+        for( size_t j = 0; j < 36; ++j )
+            indices.push_back( uint16_t( g_fmCubeIndices16[j] + 24 ) );
+        indices.insert( indices.end(), 3, uint16_t(-1) );
+
+        std::vector<uint32_t> adj( s_fmCubeAdj, s_fmCubeAdj + 36 );
+        for( size_t j = 0; j < 36; ++j )
+            adj.push_back( ( s_fmCubeAdj[j] == uint32_t(-1) ) ? s_fmCubeAdj[j] : s_fmCubeAdj[j] + 12 );
+        adj.insert( adj.end(), 3, uint32_t(-1) );
+
+        const size_t nFaces = indices.size() / 3;
+
+        std::vector<UVAtlasVertex> vb;
+        std::vector<uint8_t> ib;
+        std::vector<uint32_t> facePart;
+        std::vector<uint32_t> remap;
+        float maxStretch = 0.f;
+        size_t numCharts = 0;
+        hr = UVAtlasCreateParallel( pos.data(), pos.size(), indices.data(), DXGI_FORMAT_R16_UINT, nFaces,
+                                    0, 0.f, 512, 512, 1.f,
+                                    adj.data(), nullptr, nullptr, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                                    UVATLAS_DEFAULT, 2, vb, ib, &facePart, &remap, &maxStretch, &numCharts );
+        if (FAILED(hr))
+        {
+            printe( "\nERROR: create atlas parallel [fmcube16 x2, unused face] failed (%08X)\n", static_cast<unsigned int>(hr) );
+            success = false;
+        }
+        else if ( ( ib.size() / (sizeof(uint16_t)*3) ) != nFaces
+                  || facePart.size() != nFaces
+                  || remap.size() != vb.size()
+                  || numCharts < 8 || numCharts > 12 )
+        {
+            printe( "\nERROR: Unexpected results from create atlas parallel [fmcube16 x2, unused face]\n\tverts %zu\n\tface partitions %zu\n\tremap array %zu\n\tnumCharts %zu\n",
+                    vb.size(), facePart.size(), remap.size(), numCharts );
+            success = false;
+        }
+        else
+        {
+            auto outIndices = reinterpret_cast<const uint16_t*>( ib.data() );
+            const size_t unused = nFaces - 1;
+            if ( outIndices[ unused * 3 ] != uint16_t(-1) || outIndices[ unused * 3 + 1 ] != uint16_t(-1) || outIndices[ unused * 3 + 2 ] != uint16_t(-1) )
+            {
+                printe( "\nERROR: create atlas parallel [fmcube16 x2, unused face] lost the unused face marker: %u %u %u\n",
+                        outIndices[ unused * 3 ], outIndices[ unused * 3 + 1 ], outIndices[ unused * 3 + 2 ] );
+                success = false;
+            }
+            else if ( !IsValidVertexRemap( outIndices, nFaces, remap.data(), vb.size(), true ) )
+            {
+                printe( "\nERROR: Vertex remap invalid from create atlas parallel [fmcube16 x2, unused face]\n" );
+                success = false;
+            }
+            else if ( !IsValidFacePartition( facePart.data(), nFaces, numCharts ) )
+            {
+                printe( "\nERROR: Face partition invalid from create atlas parallel [fmcube16 x2, unused face]\n" );
+                success = false;
+            }
+            else
+            {
+                for( size_t j = 0; j < unused * 3; ++j )
+                {
+                    if ( outIndices[j] >= vb.size() )
+                    {
+                        printe( "\nERROR: create atlas parallel [fmcube16 x2, unused face] index %zu out of range (%u >= %zu)\n", j, outIndices[j], vb.size() );
+                        success = false;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // Cancellation from the callback reaches every worker
+    {
+        std::vector<uint32_t> indices;
+        std::vector<XMFLOAT3> pos;
+        std::vector<uint32_t> adj;
+        MeshGenerator<uint32_t>::Create( MeshGenerator<uint32_t>::KIND_CLUTTER, 8000, 2, indices, pos, adj );
+
+        std::vector<UVAtlasVertex> vb;
+        std::vector<uint8_t> ib;
+        hr = UVAtlasCreateParallel( pos.data(), pos.size(), indices.data(), DXGI_FORMAT_R32_UINT, indices.size() / 3,
+                                    0, 0.f, 512, 512, 1.f,
+                                    adj.data(), nullptr, nullptr,
+                                    [](float) -> HRESULT { return E_ABORT; }, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                                    UVATLAS_DEFAULT, 4, vb, ib, nullptr, nullptr, nullptr, nullptr );
+        if ( hr != E_ABORT )
+        {
+            printe( "\nERROR: expected E_ABORT from cancelled create atlas parallel (%08X)\n", static_cast<unsigned int>(hr) );
+            success = false;
+        }
+    }
+
+    return success;
+}
+
+
+//-------------------------------------------------------------------------------------
+// UVAtlasCreate (determinism)
+bool Test14()
+{
+    bool success = true;
+
+    // Library results are repeatable run to run
+    {
+        std::vector<uint32_t> indices;
+        std::vector<XMFLOAT3> pos;
+        std::vector<uint32_t> adj;
+        MeshGenerator<uint32_t>::Create( MeshGenerator<uint32_t>::KIND_SPHERE, 2000, 1, indices, pos, adj );
+
+        AtlasDigest first;
+        for( size_t pass = 0; pass < 2; ++pass )
+        {
+            std::vector<UVAtlasVertex> vb;
+            std::vector<uint8_t> ib;
+            std::vector<uint32_t> facePart;
+            std::vector<uint32_t> remap;
+            HRESULT hr = UVAtlasCreate( pos.data(), pos.size(), indices.data(), DXGI_FORMAT_R32_UINT, indices.size() / 3,
+                                        0, 0.f, 512, 512, 1.f,
+                                        adj.data(), nullptr, nullptr, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                                        UVATLAS_DEFAULT, vb, ib, &facePart, &remap, nullptr, nullptr );
+            if ( FAILED(hr) )
+            {
+                printe( "\nERROR: create atlas [sphere] failed (%08X)\n", static_cast<unsigned int>(hr) );
+                success = false;
+                break;
+            }
+
+            const AtlasDigest digest = ComputeAtlasDigest( vb, ib, facePart, remap );
+            if ( !pass )
+            {
+                first = digest;
+            }
+            else if ( !( digest == first ) )
+            {
+                printe( "\nERROR: create atlas [sphere] is not repeatable\n" );
+                PrintAtlasDigest( "first", first );
+                PrintAtlasDigest( "second", digest );
+                success = false;
+            }
+        }
+    }
+
+    // Parallel results are byte-identical for any thread count, for both index formats
+    const size_t threadCounts[] = { 1, 2, 3, 4, 8, 0 };
+
+    for( size_t format = 0; format < 2; ++format )
+    {
+        const bool is16 = ( format == 0 );
+
+        std::vector<uint32_t> indices32;
+        std::vector<XMFLOAT3> pos;
+        std::vector<uint32_t> adj;
+        MeshGenerator<uint32_t>::Create( MeshGenerator<uint32_t>::KIND_CLUTTER, is16 ? 6000 : 12000, 7, indices32, pos, adj );
+
+        std::vector<uint16_t> indices16;
+        if ( is16 )
+        {
+            if ( pos.size() >= UINT16_MAX )
+            {
+                printe( "\nERROR: generated clutter too large for 16-bit indices (%zu verts)\n", pos.size() );
+                success = false;
+                continue;
+            }
+
+            indices16.reserve( indices32.size() );
+            for( auto i : indices32 )
+            {
+                indices16.push_back( static_cast<uint16_t>( i ) );
+            }
+        }
+
+        const void* indices = is16 ? static_cast<const void*>( indices16.data() ) : static_cast<const void*>( indices32.data() );
+        const DXGI_FORMAT indexFormat = is16 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+        const size_t nFaces = indices32.size() / 3;
+
+        AtlasDigest baseline;
+        for( size_t j = 0; j < std::size(threadCounts); ++j )
+        {
+            std::vector<UVAtlasVertex> vb;
+            std::vector<uint8_t> ib;
+            std::vector<uint32_t> facePart;
+            std::vector<uint32_t> remap;
+            HRESULT hr = UVAtlasCreateParallel( pos.data(), pos.size(), indices, indexFormat, nFaces,
+                                                0, 0.f, 512, 512, 1.f,
+                                                adj.data(), nullptr, nullptr, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                                                UVATLAS_DEFAULT, threadCounts[j], vb, ib, &facePart, &remap, nullptr, nullptr );
+            if ( FAILED(hr) )
+            {
+                printe( "\nERROR: create atlas parallel [clutter%s, %zu threads] failed (%08X)\n",
+                        is16 ? "16" : "32", threadCounts[j], static_cast<unsigned int>(hr) );
+                success = false;
+                break;
+            }
+
+            const AtlasDigest digest = ComputeAtlasDigest( vb, ib, facePart, remap );
+            if ( !j )
+            {
+                baseline = digest;
+            }
+            else if ( !( digest == baseline ) )
+            {
+                printe( "\nERROR: create atlas parallel [clutter%s] output differs with %zu threads\n",
+                        is16 ? "16" : "32", threadCounts[j] );
+                PrintAtlasDigest( "1 thread", baseline );
+                PrintAtlasDigest( "actual", digest );
+                success = false;
+            }
+        }
+    }
+
+    return success;
+}
+
+
+//-------------------------------------------------------------------------------------
+// UVAtlasCreate (cancellation)
+bool Test15()
+{
+    bool success = true;
+
+    using Generator = MeshGenerator<uint32_t>;
+
+    struct CancelCase
+    {
+        const char* name;
+        Generator::Kind kind;
+        size_t threads;     // 1 is UVAtlasCreate, otherwise UVAtlasCreateParallel
+    };
+
+    const CancelCase cases[] =
+    {
+        { "sphere", Generator::KIND_SPHERE, 1 },
+        { "terrain", Generator::KIND_TERRAIN, 1 },
+        { "clutter (parallel)", Generator::KIND_CLUTTER, 0 },
+    };
+
+    // Request cancellation at the first poll and partway through the larger phases
+    const uint64_t signalDelays[] = { 0, 100, 500 };
+
+    const uint64_t budget = GetCancelLatencyBudgetMS();
+
+    for( const auto& test : cases )
+    {
+        std::vector<uint32_t> indices;
+        std::vector<XMFLOAT3> pos;
+        std::vector<uint32_t> adj;
+        {
+            BenchExcludeScope benchExclude;
+            Generator::Create( test.kind, 50000, 3, indices, pos, adj );
+        }
+
+        const size_t nFaces = indices.size() / 3;
+
+        uint64_t worstLatency = 0;
+        for( auto delay : signalDelays )
+        {
+            // The request is raised at signalTick and seen at the next callback poll, so the
+            // measured time covers both the gap between polls and unwinding afterwards
+            const uint64_t signalTick = GetTickMS() + delay;
+            size_t polls = 0;
+            auto callback = [&polls, signalTick]( float ) -> HRESULT
+            {
+                ++polls;
+                return ( GetTickMS() >= signalTick ) ? E_ABORT : S_OK;
+            };
+
+            std::vector<UVAtlasVertex> vb;
+            std::vector<uint8_t> ib;
+            HRESULT hr;
+            if ( test.threads == 1 )
+            {
+                hr = UVAtlasCreate( pos.data(), pos.size(), indices.data(), DXGI_FORMAT_R32_UINT, nFaces,
+                                    0, 0.f, 512, 512, 1.f,
+                                    adj.data(), nullptr, nullptr, callback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                                    UVATLAS_DEFAULT, vb, ib, nullptr, nullptr, nullptr, nullptr );
+            }
+            else
+            {
+                hr = UVAtlasCreateParallel( pos.data(), pos.size(), indices.data(), DXGI_FORMAT_R32_UINT, nFaces,
+                                            0, 0.f, 512, 512, 1.f,
+                                            adj.data(), nullptr, nullptr, callback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                                            UVATLAS_DEFAULT, test.threads, vb, ib, nullptr, nullptr, nullptr, nullptr );
+            }
+
+            const uint64_t returnTick = GetTickMS();
+
+            if ( FAILED(hr) && hr != E_ABORT )
+            {
+                printe( "\nERROR: cancelled create atlas [%s] failed with %08X instead of E_ABORT\n", test.name, static_cast<unsigned int>(hr) );
+                success = false;
+                continue;
+            }
+
+            if ( returnTick < signalTick )
+            {
+                // Finished before the request; nothing to measure
+                continue;
+            }
+
+            const uint64_t latency = returnTick - signalTick;
+            worstLatency = std::max( worstLatency, latency );
+
+            if ( latency > budget )
+            {
+                printe( "\nERROR: create atlas [%s] took %llu ms to return after cancellation at +%llu ms (budget %llu ms, %zu polls)\n",
+                        test.name, static_cast<unsigned long long>(latency), static_cast<unsigned long long>(delay),
+                        static_cast<unsigned long long>(budget), polls );
+                success = false;
+            }
+        }
+
+        print( "\n\t%s: %zu faces, worst cancellation latency %llu ms", test.name, nFaces, static_cast<unsigned long long>(worstLatency) );
+    }
+
+    print( "\n" );
+
+    return success;
+}
+
+
+//-------------------------------------------------------------------------------------
+// UVAtlasPack (multiple)
+bool Test17()
+{
+    bool success = true;
+    HRESULT hr;
+
+    const UVAtlasPackTarget targets[] =
+    {
+        { 512, 512, 1.f },
+        { 1024, 1024, 2.f },
+        { 2048, 2048, 4.f },
+        { 4096, 4096, 8.f },
+        { 1024, 256, 1.f },
+    };
+
+    std::vector<uint32_t> indices;
+    std::vector<XMFLOAT3> pos;
+    std::vector<uint32_t> adj;
+    MeshGenerator<uint32_t>::Create( MeshGenerator<uint32_t>::KIND_CLUTTER, 4000, 5, indices, pos, adj );
+
+    const size_t nFaces = indices.size() / 3;
+
+    std::vector<UVAtlasVertex> vb;
+    std::vector<uint8_t> ib;
+    std::vector<uint32_t> partitionAdj;
+    hr = UVAtlasPartition( pos.data(), pos.size(), indices.data(), DXGI_FORMAT_R32_UINT, nFaces,
+                           0, 0.f,
+                           adj.data(), nullptr, nullptr, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                           UVATLAS_DEFAULT, vb, ib, nullptr, nullptr, partitionAdj, nullptr, nullptr );
+    if ( FAILED(hr) )
+    {
+        printe( "\nERROR: partition [clutter] failed (%08X)\n", static_cast<unsigned int>(hr) );
+        return false;
+    }
+
+    // invalid args
+    {
+        std::vector<std::vector<UVAtlasVertex>> vbs;
+        std::vector<std::vector<uint8_t>> ibs;
+
+        hr = UVAtlasPackMultiple( vb, ib, DXGI_FORMAT_R32_UINT, targets, 0, partitionAdj,
+                                  UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY, 0, vbs, ibs );
+        if ( hr != E_INVALIDARG )
+        {
+            printe( "\nERROR: expected failure for no targets (%08X)\n", static_cast<unsigned int>(hr) );
+            success = false;
+        }
+
+        hr = UVAtlasPackMultiple( vb, ib, DXGI_FORMAT_R8G8B8A8_UNORM, targets, std::size(targets), partitionAdj,
+                                  UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY, 0, vbs, ibs );
+        if ( hr != E_INVALIDARG )
+        {
+            printe( "\nERROR: expected failure for wrong DXGI format (%08X)\n", static_cast<unsigned int>(hr) );
+            success = false;
+        }
+
+        const UVAtlasPackTarget badTargets[] = { { 512, 512, 1.f }, { 0, 512, 1.f } };
+        hr = UVAtlasPackMultiple( vb, ib, DXGI_FORMAT_R32_UINT, badTargets, std::size(badTargets), partitionAdj,
+                                  UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY, 0, vbs, ibs );
+        if ( hr != E_INVALIDARG || !vbs.empty() || !ibs.empty() )
+        {
+            printe( "\nERROR: expected failure for zero width target (%08X)\n", static_cast<unsigned int>(hr) );
+            success = false;
+        }
+    }
+
+    // Every resolution must match a separate UVAtlasPack on a copy, for any thread count
+    for( size_t threads = 1; threads <= 4; threads += 3 )
+    {
+        std::vector<std::vector<UVAtlasVertex>> vbs;
+        std::vector<std::vector<uint8_t>> ibs;
+        hr = UVAtlasPackMultiple( vb, ib, DXGI_FORMAT_R32_UINT, targets, std::size(targets), partitionAdj,
+                                  UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY, threads, vbs, ibs );
+        if ( FAILED(hr) )
+        {
+            printe( "\nERROR: pack multiple [%zu threads] failed (%08X)\n", threads, static_cast<unsigned int>(hr) );
+            success = false;
+            continue;
+        }
+
+        if ( vbs.size() != std::size(targets) || ibs.size() != std::size(targets) )
+        {
+            printe( "\nERROR: pack multiple [%zu threads] returned %zu vertex and %zu index buffers\n", threads, vbs.size(), ibs.size() );
+            success = false;
+            continue;
+        }
+
+        for( size_t j = 0; j < std::size(targets); ++j )
+        {
+            std::vector<UVAtlasVertex> expectedVB = vb;
+            std::vector<uint8_t> expectedIB = ib;
+            hr = UVAtlasPack( expectedVB, expectedIB, DXGI_FORMAT_R32_UINT, targets[j].width, targets[j].height, targets[j].gutter,
+                              partitionAdj, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY );
+            if ( FAILED(hr) )
+            {
+                printe( "\nERROR: pack [%zu x %zu] failed (%08X)\n", targets[j].width, targets[j].height, static_cast<unsigned int>(hr) );
+                success = false;
+                continue;
+            }
+
+            if ( vbs[j].size() != expectedVB.size()
+                 || memcmp( vbs[j].data(), expectedVB.data(), expectedVB.size() * sizeof(UVAtlasVertex) ) != 0
+                 || ibs[j] != expectedIB )
+            {
+                printe( "\nERROR: pack multiple [%zu x %zu, %zu threads] differs from UVAtlasPack\n", targets[j].width, targets[j].height, threads );
+                success = false;
+            }
+        }
+    }
+
+    // The input is left as it was
+    {
+        std::vector<UVAtlasVertex> before = vb;
+        std::vector<std::vector<UVAtlasVertex>> vbs;
+        std::vector<std::vector<uint8_t>> ibs;
+        hr = UVAtlasPackMultiple( vb, ib, DXGI_FORMAT_R32_UINT, targets, 1, partitionAdj,
+                                  nullptr, UVATLAS_DEFAULT_CALLBACK_FREQUENCY, 0, vbs, ibs );
+        if ( FAILED(hr) || memcmp( before.data(), vb.data(), vb.size() * sizeof(UVAtlasVertex) ) != 0 )
+        {
+            printe( "\nERROR: pack multiple modified its input (%08X)\n", static_cast<unsigned int>(hr) );
+            success = false;
+        }
+    }
+
+    return success;
+}
+
+
+//-------------------------------------------------------------------------------------
+// UVAtlasPack (bitset)
+bool Test19()
+{
+    bool success = true;
+    HRESULT hr;
+
+    std::vector<uint32_t> indices;
+    std::vector<XMFLOAT3> pos;
+    std::vector<uint32_t> adj;
+    MeshGenerator<uint32_t>::Create( MeshGenerator<uint32_t>::KIND_CLUTTER, 4000, 5, indices, pos, adj );
+
+    std::vector<UVAtlasVertex> vb;
+    std::vector<uint8_t> ib;
+    std::vector<uint32_t> facePart;
+    std::vector<uint32_t> partitionAdj;
+    hr = UVAtlasPartition( pos.data(), pos.size(), indices.data(), DXGI_FORMAT_R32_UINT, indices.size() / 3,
+                           0, 0.f,
+                           adj.data(), nullptr, nullptr, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                           UVATLAS_DEFAULT, vb, ib, &facePart, nullptr, partitionAdj, nullptr, nullptr );
+    if ( FAILED(hr) )
+    {
+        printe( "\nERROR: partition [clutter] failed (%08X)\n", static_cast<unsigned int>(hr) );
+        return false;
+    }
+
+    const size_t nFaces = ib.size() / ( sizeof(uint32_t) * 3 );
+
+    // invalid args
+    {
+        std::vector<UVAtlasVertex> vbCopy = vb;
+        std::vector<uint8_t> ibCopy = ib;
+
+        hr = UVAtlasPackEx( vbCopy, ibCopy, DXGI_FORMAT_R32_UINT, 512, 512, 1.f, partitionAdj,
+                            UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY, static_cast<UVATLAS_PACKER>( 0x2 ) );
+        if ( hr != E_INVALIDARG )
+        {
+            printe( "\nERROR: expected failure for unknown packer (%08X)\n", static_cast<unsigned int>(hr) );
+            success = false;
+        }
+
+        hr = UVAtlasPackEx( vbCopy, ibCopy, DXGI_FORMAT_R32_UINT, 0, 512, 1.f, partitionAdj,
+                            UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY, UVATLAS_PACKER_BITSET );
+        if ( hr != E_INVALIDARG )
+        {
+            printe( "\nERROR: expected failure for zero width (%08X)\n", static_cast<unsigned int>(hr) );
+            success = false;
+        }
+
+        hr = UVAtlasPackEx( vbCopy, ibCopy, DXGI_FORMAT_R8G8B8A8_UNORM, 512, 512, 1.f, partitionAdj,
+                            UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY, UVATLAS_PACKER_BITSET );
+        if ( hr != E_INVALIDARG )
+        {
+            printe( "\nERROR: expected failure for wrong DXGI format (%08X)\n", static_cast<unsigned int>(hr) );
+            success = false;
+        }
+
+        std::vector<uint32_t> shortAdj( partitionAdj.begin(), partitionAdj.end() - 3 );
+        hr = UVAtlasPackEx( vbCopy, ibCopy, DXGI_FORMAT_R32_UINT, 512, 512, 1.f, shortAdj,
+                            UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY, UVATLAS_PACKER_BITSET );
+        if ( hr != E_INVALIDARG )
+        {
+            printe( "\nERROR: expected failure for short adjacency (%08X)\n", static_cast<unsigned int>(hr) );
+            success = false;
+        }
+
+        if ( memcmp( vbCopy.data(), vb.data(), vb.size() * sizeof(UVAtlasVertex) ) != 0 || ibCopy != ib )
+        {
+            printe( "\nERROR: failed pack modified its input\n" );
+            success = false;
+        }
+    }
+
+    // The default packer is UVAtlasPack
+    {
+        std::vector<UVAtlasVertex> expectedVB = vb;
+        std::vector<uint8_t> expectedIB = ib;
+        hr = UVAtlasPack( expectedVB, expectedIB, DXGI_FORMAT_R32_UINT, 512, 512, 1.f,
+                          partitionAdj, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY );
+        if ( FAILED(hr) )
+        {
+            printe( "\nERROR: pack [clutter] failed (%08X)\n", static_cast<unsigned int>(hr) );
+            success = false;
+        }
+        else
+        {
+            std::vector<UVAtlasVertex> vbCopy = vb;
+            std::vector<uint8_t> ibCopy = ib;
+            hr = UVAtlasPackEx( vbCopy, ibCopy, DXGI_FORMAT_R32_UINT, 512, 512, 1.f, partitionAdj,
+                                UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY, UVATLAS_PACKER_DEFAULT );
+            if ( FAILED(hr)
+                 || memcmp( vbCopy.data(), expectedVB.data(), expectedVB.size() * sizeof(UVAtlasVertex) ) != 0
+                 || ibCopy != expectedIB )
+            {
+                printe( "\nERROR: default packer differs from UVAtlasPack (%08X)\n", static_cast<unsigned int>(hr) );
+                success = false;
+            }
+        }
+    }
+
+    // Bitset packs stay in the unit square with no two charts sharing a texel
+    const size_t sizes[] = { 512, 1024, 2048, 4096 };
+    for( const size_t size : sizes )
+    {
+        std::vector<UVAtlasVertex> vbCopy = vb;
+        std::vector<uint8_t> ibCopy = ib;
+        hr = UVAtlasPackEx( vbCopy, ibCopy, DXGI_FORMAT_R32_UINT, size, size, 2.f, partitionAdj,
+                            UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY, UVATLAS_PACKER_BITSET );
+        if ( FAILED(hr) )
+        {
+            printe( "\nERROR: bitset pack [%zu] failed (%08X)\n", size, static_cast<unsigned int>(hr) );
+            success = false;
+            continue;
+        }
+
+        if ( vbCopy.size() != vb.size() || ibCopy != ib )
+        {
+            printe( "\nERROR: bitset pack [%zu] changed the mesh topology\n", size );
+            success = false;
+            continue;
+        }
+
+        for( size_t j = 0; j < vbCopy.size(); ++j )
+        {
+            const auto& it = vbCopy[j];
+            if ( it.uv.x < 0.f || it.uv.x > 1.f || it.uv.y < 0.f || it.uv.y > 1.f
+                 || memcmp( &it.pos, &vb[j].pos, sizeof(XMFLOAT3) ) != 0 )
+            {
+                printe( "\nERROR: bitset pack [%zu] vertex %zu is wrong (uv %f %f)\n", size, j, it.uv.x, it.uv.y );
+                success = false;
+                break;
+            }
+        }
+
+        UVAtlasMetrics metrics;
+        hr = UVAtlasComputeMetrics( vbCopy.data(), vbCopy.size(), ibCopy.data(), DXGI_FORMAT_R32_UINT, nFaces,
+                                    facePart.data(), size, size, 0.f, metrics );
+        if ( FAILED(hr) )
+        {
+            printe( "\nERROR: metrics for bitset pack [%zu] failed (%08X)\n", size, static_cast<unsigned int>(hr) );
+            success = false;
+        }
+        else if ( metrics.overlapTexels )
+        {
+            printe( "\nERROR: bitset pack [%zu] has %zu texels covered by more than one chart\n", size, metrics.overlapTexels );
+            success = false;
+        }
+    }
+
+    // Cancellation
+    {
+        std::vector<UVAtlasVertex> vbCopy = vb;
+        std::vector<uint8_t> ibCopy = ib;
+        hr = UVAtlasPackEx( vbCopy, ibCopy, DXGI_FORMAT_R32_UINT, 1024, 1024, 2.f, partitionAdj,
+                            [](float) -> HRESULT { return E_ABORT; }, UVATLAS_DEFAULT_CALLBACK_FREQUENCY, UVATLAS_PACKER_BITSET );
+        if ( hr != E_ABORT )
+        {
+            printe( "\nERROR: expected E_ABORT from cancelled bitset pack (%08X)\n", static_cast<unsigned int>(hr) );
+            success = false;
+        }
+    }
+
+    return success;
+}
+
+
+//-------------------------------------------------------------------------------------
+// UVAtlasComputeMetrics
+bool Test20()
+{
+    bool success = true;
+    HRESULT hr;
+
+    // Two unit squares in object space, each 4x4 texels in a 16x16 atlas
+    UVAtlasVertex vb[8] = {};
+    auto makeQuad = [&]( size_t base, float u0, float v0 )
+    {
+        const XMFLOAT2 corners[4] = { { 0.f, 0.f }, { 1.f, 0.f }, { 1.f, 1.f }, { 0.f, 1.f } };
+        for( size_t j = 0; j < 4; ++j )
+        {
+            vb[ base + j ].pos = XMFLOAT3( corners[j].x, corners[j].y, float( base ) );
+            vb[ base + j ].uv = XMFLOAT2( u0 + corners[j].x * 0.25f, v0 + corners[j].y * 0.25f );
+        }
+    };
+
+    static const uint16_t s_indices[3 * 4] =
+    {
+        0, 1, 2,
+        0, 2, 3,
+        4, 5, 6,
+        4, 6, 7,
+    };
+
+    static const uint32_t s_facePart[4] = { 0, 0, 1, 1 };
+
+    // invalid args
+    {
+        makeQuad( 0, 0.f, 0.f );
+        makeQuad( 4, 0.375f, 0.f );
+
+        UVAtlasMetrics metrics;
+        hr = UVAtlasComputeMetrics( nullptr, 8, s_indices, DXGI_FORMAT_R16_UINT, 4, s_facePart, 16, 16, 1.f, metrics );
+        if ( hr != E_INVALIDARG )
+        {
+            printe( "\nERROR: expected failure for missing vertices (%08X)\n", static_cast<unsigned int>(hr) );
+            success = false;
+        }
+
+        hr = UVAtlasComputeMetrics( vb, 8, s_indices, DXGI_FORMAT_R8G8B8A8_UNORM, 4, s_facePart, 16, 16, 1.f, metrics );
+        if ( hr != E_INVALIDARG )
+        {
+            printe( "\nERROR: expected failure for wrong DXGI format (%08X)\n", static_cast<unsigned int>(hr) );
+            success = false;
+        }
+
+        hr = UVAtlasComputeMetrics( vb, 8, s_indices, DXGI_FORMAT_R16_UINT, 4, s_facePart, 0, 16, 1.f, metrics );
+        if ( hr != E_INVALIDARG )
+        {
+            printe( "\nERROR: expected failure for zero width (%08X)\n", static_cast<unsigned int>(hr) );
+            success = false;
+        }
+
+        hr = UVAtlasComputeMetrics( vb, 7, s_indices, DXGI_FORMAT_R16_UINT, 4, s_facePart, 16, 16, 1.f, metrics );
+        if ( hr != E_INVALIDARG )
+        {
+            printe( "\nERROR: expected failure for index out of range (%08X)\n", static_cast<unsigned int>(hr) );
+            success = false;
+        }
+
+        static const uint32_t s_badPart[4] = { 0, 0, 1, 4 };
+        hr = UVAtlasComputeMetrics( vb, 8, s_indices, DXGI_FORMAT_R16_UINT, 4, s_badPart, 16, 16, 1.f, metrics );
+        if ( hr != E_INVALIDARG )
+        {
+            printe( "\nERROR: expected failure for chart id out of range (%08X)\n", static_cast<unsigned int>(hr) );
+            success = false;
+        }
+    }
+
+    // Charts two texels apart: clean at gutter 2, the facing columns violate at gutter 3.5
+    {
+        makeQuad( 0, 0.f, 0.f );
+        makeQuad( 4, 0.375f, 0.f );
+
+        UVAtlasMetrics metrics;
+        hr = UVAtlasComputeMetrics( vb, 8, s_indices, DXGI_FORMAT_R16_UINT, 4, s_facePart, 16, 16, 2.f, metrics );
+        if ( FAILED(hr) )
+        {
+            printe( "\nERROR: metrics [apart] failed (%08X)\n", static_cast<unsigned int>(hr) );
+            success = false;
+        }
+        else if ( metrics.coveredTexels != 32 || metrics.coverage != 0.125f
+                  || metrics.overlapTexels != 0 || metrics.gutterViolations != 0
+                  || metrics.charts.size() != 2
+                  || metrics.charts[0].faceCount != 2 || metrics.charts[0].coveredTexels != 16
+                  || metrics.charts[1].faceCount != 2 || metrics.charts[1].coveredTexels != 16
+                  || fabsf( metrics.minTexelDensity - 4.f ) > 1e-4f || fabsf( metrics.maxTexelDensity - 4.f ) > 1e-4f )
+        {
+            printe( "\nERROR: unexpected metrics [apart]: %zu covered, %f coverage, %zu overlap, %zu gutter, density %f..%f\n",
+                    metrics.coveredTexels, metrics.coverage, metrics.overlapTexels, metrics.gutterViolations,
+                    metrics.minTexelDensity, metrics.maxTexelDensity );
+            success = false;
+        }
+
+        hr = UVAtlasComputeMetrics( vb, 8, s_indices, DXGI_FORMAT_R16_UINT, 4, s_facePart, 16, 16, 3.5f, metrics );
+        if ( FAILED(hr) || metrics.gutterViolations != 8 || metrics.overlapTexels != 0 )
+        {
+            printe( "\nERROR: unexpected metrics [gutter] (%08X): %zu overlap, %zu gutter\n",
+                    static_cast<unsigned int>(hr), metrics.overlapTexels, metrics.gutterViolations );
+            success = false;
+        }
+    }
+
+    // Charts touching along a column of texel centers: each center goes to one chart
+    {
+        makeQuad( 0, 0.03125f, 0.f );
+        makeQuad( 4, 0.28125f, 0.f );
+
+        UVAtlasMetrics metrics;
+        hr = UVAtlasComputeMetrics( vb, 8, s_indices, DXGI_FORMAT_R16_UINT, 4, s_facePart, 16, 16, 1.f, metrics );
+        if ( FAILED(hr) || metrics.coveredTexels != 32 || metrics.overlapTexels != 0
+             || metrics.charts.size() != 2 || metrics.charts[0].coveredTexels != 16 || metrics.charts[1].coveredTexels != 16 )
+        {
+            printe( "\nERROR: unexpected metrics [touching] (%08X): %zu covered, %zu overlap\n",
+                    static_cast<unsigned int>(hr), metrics.coveredTexels, metrics.overlapTexels );
+            success = false;
+        }
+    }
+
+    // Charts sharing two columns of texels
+    {
+        makeQuad( 0, 0.f, 0.f );
+        makeQuad( 4, 0.125f, 0.f );
+
+        UVAtlasMetrics metrics;
+        hr = UVAtlasComputeMetrics( vb, 8, s_indices, DXGI_FORMAT_R16_UINT, 4, s_facePart, 16, 16, 1.f, metrics );
+        if ( FAILED(hr) || metrics.coveredTexels != 24 || metrics.overlapTexels != 8
+             || metrics.charts.size() != 2 || metrics.charts[0].coveredTexels != 8 || metrics.charts[1].coveredTexels != 8 )
+        {
+            printe( "\nERROR: unexpected metrics [overlap] (%08X): %zu covered, %zu overlap\n",
+                    static_cast<unsigned int>(hr), metrics.coveredTexels, metrics.overlapTexels );
+            success = false;
+        }
+    }
+
+    return success;
+}
+
+
+//-------------------------------------------------------------------------------------
+// UVAtlasPartition (cache)
+namespace
+{
+    struct PartitionOutputs
+    {
+        std::vector<UVAtlasVertex> vb;
+        std::vector<uint8_t> ib;
+        std::vector<uint32_t> facePart;
+        std::vector<uint32_t> remap;
+        std::vector<uint32_t> adjacency;
+        float maxStretch;
+        size_t numCharts;
+
+        AtlasDigest GetDigest() const noexcept
+        {
+            AtlasDigest digest = ComputeAtlasDigest( vb, ib, facePart, remap );
+            digest.Add( adjacency );
+            digest.Add( &maxStretch, sizeof(maxStretch) );
+            const uint64_t charts = numCharts;
+            digest.Add( &charts, sizeof(charts) );
+            return digest;
+        }
+    };
+}
+
+bool Test22()
+{
+    bool success = true;
+    HRESULT hr;
+
+    wchar_t szPath[MAX_PATH] = {};
+    if ( !ExpandMediaPath( MESH_MEDIA_PATH L"teapot._obj", szPath, MAX_PATH ) )
+    {
+        printe( "ERROR: ExpandMediaPath FAILED\n" );
+        return false;
+    }
+
+    std::unique_ptr<DX::WaveFrontReader<uint16_t>> mesh( new DX::WaveFrontReader<uint16_t>() );
+    {
+        BenchExcludeScope benchExclude;
+        hr = mesh->Load( szPath );
+    }
+    if ( FAILED(hr) )
+    {
+        printe( "ERROR: Failed loading mesh data (%08X):\n%S\n", static_cast<unsigned int>(hr), szPath );
+        return false;
+    }
+
+    const size_t nFaces = mesh->indices.size() / 3;
+    std::vector<XMFLOAT3> pos( mesh->vertices.size() );
+    for( size_t j = 0; j < pos.size(); ++j )
+        pos[j] = mesh->vertices[j].position;
+
+    std::vector<uint32_t> adj( mesh->indices.size() );
+    hr = GenerateAdjacencyAndPointReps( mesh->indices.data(), nFaces, pos.data(), pos.size(), 0.f, nullptr, adj.data() );
+    if ( FAILED(hr) )
+    {
+        printe( "ERROR: failed GenerateAdjacencyAndPointReps (%08X)\n:%S\n", static_cast<unsigned int>(hr), szPath );
+        return false;
+    }
+
+    // A new directory per run so entries from earlier runs can't turn misses into hits
+    wchar_t cacheDir[MAX_PATH] = {};
+    if ( !CreateTempDirectory( cacheDir, MAX_PATH ) )
+    {
+        printe( "ERROR: Failed creating a temporary directory for the partition cache\n" );
+        return false;
+    }
+
+    std::set<std::wstring> entries;
+    auto partition = [&]( const std::vector<XMFLOAT3>& positions, float maxStretch, UVATLAS options,
+                          PartitionOutputs& out, bool& hit, double& ms ) -> HRESULT
+    {
+        UVAtlasPartitionCacheInfo info = {};
+        const auto start = std::chrono::steady_clock::now();
+        HRESULT result = UVAtlasPartitionCached( cacheDir, positions.data(), positions.size(), mesh->indices.data(), DXGI_FORMAT_R16_UINT, nFaces,
+                                                 0, maxStretch,
+                                                 adj.data(), nullptr, nullptr, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                                                 options, out.vb, out.ib, &out.facePart, &out.remap, out.adjacency,
+                                                 &out.maxStretch, &out.numCharts, &info );
+        ms = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+        hit = info.hit;
+        if ( SUCCEEDED(result) )
+            entries.insert( info.file );
+        return result;
+    };
+
+    // invalid args
+    {
+        PartitionOutputs out = {};
+        hr = UVAtlasPartitionCached( nullptr, pos.data(), pos.size(), mesh->indices.data(), DXGI_FORMAT_R16_UINT, nFaces,
+                                     0, 0.f,
+                                     adj.data(), nullptr, nullptr, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                                     UVATLAS_DEFAULT, out.vb, out.ib, &out.facePart, &out.remap, out.adjacency,
+                                     nullptr, nullptr, nullptr );
+        if ( hr != E_INVALIDARG )
+        {
+            printe( "\nERROR: expected failure for missing cache directory (%08X)\n", static_cast<unsigned int>(hr) );
+            success = false;
+        }
+
+        hr = UVAtlasPartitionCached( cacheDir, pos.data(), pos.size(), mesh->indices.data(), DXGI_FORMAT_R8G8B8A8_UNORM, nFaces,
+                                     0, 0.f,
+                                     adj.data(), nullptr, nullptr, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                                     UVATLAS_DEFAULT, out.vb, out.ib, &out.facePart, &out.remap, out.adjacency,
+                                     nullptr, nullptr, nullptr );
+        if ( hr != E_INVALIDARG )
+        {
+            printe( "\nERROR: expected failure for wrong DXGI format (%08X)\n", static_cast<unsigned int>(hr) );
+            success = false;
+        }
+    }
+
+    PartitionOutputs reference = {};
+    hr = UVAtlasPartition( pos.data(), pos.size(), mesh->indices.data(), DXGI_FORMAT_R16_UINT, nFaces,
+                           0, 0.f,
+                           adj.data(), nullptr, nullptr, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                           UVATLAS_DEFAULT, reference.vb, reference.ib, &reference.facePart, &reference.remap, reference.adjacency,
+                           &reference.maxStretch, &reference.numCharts );
+    if ( FAILED(hr) )
+    {
+        printe( "\nERROR: partition [teapot] failed (%08X)\n", static_cast<unsigned int>(hr) );
+        success = false;
+    }
+    else
+    {
+        const AtlasDigest expected = reference.GetDigest();
+
+        // Miss, then hit, both matching UVAtlasPartition
+        PartitionOutputs missed = {};
+        PartitionOutputs cached = {};
+        bool hit = false;
+        double missMS = 0;
+        double hitMS = 0;
+        hr = partition( pos, 0.f, UVATLAS_DEFAULT, missed, hit, missMS );
+        if ( FAILED(hr) || hit || !( missed.GetDigest() == expected ) )
+        {
+            printe( "\nERROR: partition cache [teapot] first call (%08X) hit %d or differs from UVAtlasPartition\n", static_cast<unsigned int>(hr), hit ? 1 : 0 );
+            success = false;
+        }
+
+        hr = partition( pos, 0.f, UVATLAS_DEFAULT, cached, hit, hitMS );
+        if ( FAILED(hr) || !hit || !( cached.GetDigest() == expected ) )
+        {
+            printe( "\nERROR: partition cache [teapot] second call (%08X) missed %d or differs from UVAtlasPartition\n", static_cast<unsigned int>(hr), hit ? 0 : 1 );
+            success = false;
+        }
+        else
+        {
+            print( "\n\tteapot: %.2f ms partition, %.2f ms cached (%.0fx)", missMS, hitMS, ( hitMS > 0 ) ? missMS / hitMS : 0.0 );
+            if ( hitMS >= missMS )
+            {
+                printe( "\nERROR: partition cache [teapot] hit took %.2f ms, no faster than partitioning (%.2f ms)\n", hitMS, missMS );
+                success = false;
+            }
+
+            // Packing starts from the cached charts exactly as from fresh ones
+            const size_t sizes[] = { 512, 1024 };
+            for( const size_t size : sizes )
+            {
+                PartitionOutputs expectedPack = reference;
+                PartitionOutputs cachedPack = cached;
+                HRESULT hrExpected = UVAtlasPack( expectedPack.vb, expectedPack.ib, DXGI_FORMAT_R16_UINT, size, size, 2.f,
+                                                  expectedPack.adjacency, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY );
+                hr = UVAtlasPack( cachedPack.vb, cachedPack.ib, DXGI_FORMAT_R16_UINT, size, size, 2.f,
+                                  cachedPack.adjacency, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY );
+                if ( FAILED(hr) || FAILED(hrExpected) || !( cachedPack.GetDigest() == expectedPack.GetDigest() ) )
+                {
+                    printe( "\nERROR: pack [teapot, %zu] from cached partition (%08X) differs from fresh (%08X)\n",
+                            size, static_cast<unsigned int>(hr), static_cast<unsigned int>(hrExpected) );
+                    success = false;
+                }
+            }
+        }
+
+        // Any change to the inputs misses
+        {
+            PartitionOutputs out = {};
+            hr = partition( pos, 0.5f, UVATLAS_DEFAULT, out, hit, missMS );
+            if ( FAILED(hr) || hit )
+            {
+                printe( "\nERROR: partition cache [teapot] hit after changing maxStretch (%08X)\n", static_cast<unsigned int>(hr) );
+                success = false;
+            }
+
+            hr = partition( pos, 0.f, UVATLAS_GEODESIC_FAST, out, hit, missMS );
+            if ( FAILED(hr) || hit )
+            {
+                printe( "\nERROR: partition cache [teapot] hit after changing options (%08X)\n", static_cast<unsigned int>(hr) );
+                success = false;
+            }
+
+            std::vector<XMFLOAT3> moved = pos;
+            moved[0].x += 0.01f;
+            hr = partition( moved, 0.f, UVATLAS_DEFAULT, out, hit, missMS );
+            if ( FAILED(hr) || hit )
+            {
+                printe( "\nERROR: partition cache [teapot] hit after moving a vertex (%08X)\n", static_cast<unsigned int>(hr) );
+                success = false;
+            }
+
+            if ( entries.size() != 4 )
+            {
+                printe( "\nERROR: partition cache [teapot] expected 4 entries, found %zu\n", entries.size() );
+                success = false;
+            }
+        }
+
+        // A damaged entry is a miss that rewrites it
+        {
+            UVAtlasPartitionCacheInfo info = {};
+            PartitionOutputs out = {};
+            hr = UVAtlasPartitionCached( cacheDir, pos.data(), pos.size(), mesh->indices.data(), DXGI_FORMAT_R16_UINT, nFaces,
+                                         0, 0.f,
+                                         adj.data(), nullptr, nullptr, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                                         UVATLAS_DEFAULT, out.vb, out.ib, &out.facePart, &out.remap, out.adjacency,
+                                         &out.maxStretch, &out.numCharts, &info );
+            if ( FAILED(hr) || !info.hit )
+            {
+                printe( "\nERROR: partition cache [teapot] lost its entry (%08X)\n", static_cast<unsigned int>(hr) );
+                success = false;
+            }
+            else
+            {
+                FILE* fp = OpenFile( info.file.c_str(), "r+b" );
+                if ( fp )
+                {
+                    fseek( fp, -4, SEEK_END );
+                    const uint32_t garbage = 0xdeadbeef;
+                    fwrite( &garbage, sizeof(garbage), 1, fp );
+                    fclose( fp );
+                }
+
+                hr = partition( pos, 0.f, UVATLAS_DEFAULT, out, hit, missMS );
+                if ( !fp || FAILED(hr) || hit || !( out.GetDigest() == expected ) )
+                {
+                    printe( "\nERROR: partition cache [teapot] used a damaged entry (%08X)\n", static_cast<unsigned int>(hr) );
+                    success = false;
+                }
+
+                hr = partition( pos, 0.f, UVATLAS_DEFAULT, out, hit, hitMS );
+                if ( FAILED(hr) || !hit || !( out.GetDigest() == expected ) )
+                {
+                    printe( "\nERROR: partition cache [teapot] didn't rewrite a damaged entry (%08X)\n", static_cast<unsigned int>(hr) );
+                    success = false;
+                }
+            }
+        }
+
+        // An entry made from other inputs under this name, as a key collision would leave,
+        // is a miss. The moved-vertex entry is copied over this one and given its key (the
+        // 16 bytes after the magic and version) so only the stored inputs tell them apart.
+        {
+            std::vector<XMFLOAT3> moved = pos;
+            moved[0].x += 0.01f;
+
+            UVAtlasPartitionCacheInfo infoMoved = {};
+            UVAtlasPartitionCacheInfo info = {};
+            PartitionOutputs out = {};
+            hr = UVAtlasPartitionCached( cacheDir, moved.data(), moved.size(), mesh->indices.data(), DXGI_FORMAT_R16_UINT, nFaces,
+                                         0, 0.f,
+                                         adj.data(), nullptr, nullptr, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                                         UVATLAS_DEFAULT, out.vb, out.ib, &out.facePart, &out.remap, out.adjacency,
+                                         nullptr, nullptr, &infoMoved );
+            HRESULT hrDefault = UVAtlasPartitionCached( cacheDir, pos.data(), pos.size(), mesh->indices.data(), DXGI_FORMAT_R16_UINT, nFaces,
+                                                        0, 0.f,
+                                                        adj.data(), nullptr, nullptr, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                                                        UVATLAS_DEFAULT, out.vb, out.ib, &out.facePart, &out.remap, out.adjacency,
+                                                        nullptr, nullptr, &info );
+            if ( FAILED(hr) || FAILED(hrDefault) || !infoMoved.hit || !info.hit )
+            {
+                printe( "\nERROR: partition cache [teapot] lost its entries (%08X, %08X)\n",
+                        static_cast<unsigned int>(hr), static_cast<unsigned int>(hrDefault) );
+                success = false;
+            }
+            else
+            {
+                std::vector<uint8_t> other;
+                uint8_t key[16] = {};
+                bool copied = false;
+                FILE* fp = OpenFile( infoMoved.file.c_str(), "rb" );
+                if ( fp )
+                {
+                    uint8_t buffer[4096];
+                    size_t count;
+                    while ( ( count = fread( buffer, 1, sizeof(buffer), fp ) ) > 0 )
+                        other.insert( other.end(), buffer, buffer + count );
+                    fclose( fp );
+                }
+
+                fp = OpenFile( info.file.c_str(), "rb" );
+                if ( fp )
+                {
+                    copied = fseek( fp, 8, SEEK_SET ) == 0 && fread( key, sizeof(key), 1, fp ) == 1;
+                    fclose( fp );
+                }
+
+                if ( copied && other.size() > 8 + sizeof(key) )
+                {
+                    memcpy( other.data() + 8, key, sizeof(key) );
+                    fp = OpenFile( info.file.c_str(), "wb" );
+                    copied = fp && fwrite( other.data(), 1, other.size(), fp ) == other.size();
+                    if ( fp )
+                        fclose( fp );
+                }
+                else
+                {
+                    copied = false;
+                }
+
+                hr = partition( pos, 0.f, UVATLAS_DEFAULT, out, hit, missMS );
+                if ( !copied || FAILED(hr) || hit || !( out.GetDigest() == expected ) )
+                {
+                    printe( "\nERROR: partition cache [teapot] served an entry made from other inputs (%08X)\n", static_cast<unsigned int>(hr) );
+                    success = false;
+                }
+
+                hr = partition( pos, 0.f, UVATLAS_DEFAULT, out, hit, hitMS );
+                if ( FAILED(hr) || !hit || !( out.GetDigest() == expected ) )
+                {
+                    printe( "\nERROR: partition cache [teapot] didn't rewrite an entry made from other inputs (%08X)\n", static_cast<unsigned int>(hr) );
+                    success = false;
+                }
+            }
+        }
+
+        // Cancellation still reaches a hit
+        {
+            PartitionOutputs out = {};
+            hr = UVAtlasPartitionCached( cacheDir, pos.data(), pos.size(), mesh->indices.data(), DXGI_FORMAT_R16_UINT, nFaces,
+                                         0, 0.f,
+                                         adj.data(), nullptr, nullptr, [](float) -> HRESULT { return E_ABORT; }, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                                         UVATLAS_DEFAULT, out.vb, out.ib, &out.facePart, &out.remap, out.adjacency,
+                                         nullptr, nullptr, nullptr );
+            if ( hr != E_ABORT )
+            {
+                printe( "\nERROR: expected E_ABORT from cancelled partition cache hit (%08X)\n", static_cast<unsigned int>(hr) );
+                success = false;
+            }
+        }
+    }
+
+    for( const auto& entry : entries )
+        RemovePath( entry.c_str() );
+
+    // RemovePath wants the directory without its trailing separator
+    cacheDir[ wcslen( cacheDir ) - 1 ] = 0;
+    if ( !RemovePath( cacheDir ) )
+    {
+        printe( "\nERROR: partition cache left files behind in %S\n", cacheDir );
+        success = false;
+    }
+
+    return success;
+}
+
+
+//-------------------------------------------------------------------------------------
+// UVAtlasCreate (typed indices)
+namespace
+{
+    // Whether the typed UVAtlasCreate overload takes an index_t buffer. The void* entry point
+    // needs one more argument, so it can't be picked in its place.
+    template<typename index_t, typename = void>
+    struct AcceptsTypedIndices : std::false_type {};
+
+    template<typename index_t>
+    struct AcceptsTypedIndices<index_t, std::void_t<decltype( UVAtlasCreate( std::declval<const XMFLOAT3*>(), size_t(0),
+        std::declval<const index_t*>(), size_t(0), size_t(0), 0.f, size_t(0), size_t(0), 0.f,
+        std::declval<const uint32_t*>(), std::declval<const uint32_t*>(), std::declval<const float*>(),
+        UVAtlasCallback, 0.f, UVATLAS_DEFAULT,
+        std::declval<std::vector<UVAtlasVertex>&>(), std::declval<std::vector<uint8_t>&>() ) )>> : std::true_type {};
+
+    // The overloads only supply the format, and Test01 and the IMT tests cover the results of
+    // the void* entry points, so one call per overload checks the forwarding
+    template<typename index_t>
+    bool CheckTypedIndices( const char* name, const index_t* indices )
+    {
+        bool success = true;
+
+        std::vector<UVAtlasVertex> vb;
+        std::vector<uint8_t> ib;
+        std::vector<uint32_t> facePart;
+        std::vector<uint32_t> remap;
+        size_t numCharts = 0;
+        HRESULT hr = UVAtlasCreate<index_t>( g_fmCubeVerts, 24, indices, 12,
+                                             0, 0.f, 512, 512, 1.f,
+                                             s_fmCubeAdj, nullptr, nullptr, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                                             UVATLAS_DEFAULT, vb, ib, &facePart, &remap, nullptr, &numCharts );
+        if ( FAILED(hr) )
+        {
+            printe( "\nERROR: typed create atlas [%s] failed (%08X)\n", name, static_cast<unsigned int>(hr) );
+            success = false;
+        }
+        else if ( ib.size() != 12 * 3 * sizeof(index_t)
+                  || !IsValidVertexRemap( reinterpret_cast<const index_t*>( ib.data() ), 12, remap.data(), vb.size(), true )
+                  || !IsValidFacePartition( facePart.data(), 12, numCharts ) )
+        {
+            printe( "\nERROR: Unexpected results from typed create atlas [%s]\n\tverts %zu\n\tindex bytes %zu\n\tnumCharts %zu\n",
+                    name, vb.size(), ib.size(), numCharts );
+            success = false;
+        }
+
+        // The positions double as a 3-component per-vertex signal
+        std::vector<float> imt( 12 * 3 );
+        hr = UVAtlasComputeIMTFromPerVertexSignal<index_t>( g_fmCubeVerts, 24, indices, 12,
+                                                            &g_fmCubeVerts[0].x, 3, sizeof(XMFLOAT3),
+                                                            UVAtlasCallback, imt.data() );
+        if ( FAILED(hr) )
+        {
+            printe( "\nERROR: typed IMT from per-vertex signal [%s] failed (%08X)\n", name, static_cast<unsigned int>(hr) );
+            success = false;
+        }
+
+        return success;
+    }
+}
+
+bool Test25()
+{
+    static_assert( UVAtlasIndexFormat<uint16_t>::value == DXGI_FORMAT_R16_UINT, "16-bit indices are R16_UINT" );
+    static_assert( UVAtlasIndexFormat<uint32_t>::value == DXGI_FORMAT_R32_UINT, "32-bit indices are R32_UINT" );
+
+    static_assert( AcceptsTypedIndices<uint16_t>::value && AcceptsTypedIndices<uint32_t>::value, "typed overloads take 16 and 32-bit indices" );
+    static_assert( !AcceptsTypedIndices<int16_t>::value && !AcceptsTypedIndices<int32_t>::value, "signed indices must not compile" );
+    static_assert( !AcceptsTypedIndices<uint8_t>::value && !AcceptsTypedIndices<uint64_t>::value, "other index widths must not compile" );
+
+    bool success = true;
+
+    if ( !CheckTypedIndices( "fmcube16", g_fmCubeIndices16 ) )
+        success = false;
+
+    if ( !CheckTypedIndices( "fmcube32", g_fmCubeIndices32 ) )
+        success = false;
+
+    return success;
+}
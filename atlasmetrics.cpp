@@ -0,0 +1,234 @@
+//-------------------------------------------------------------------------------------
+// atlasmetrics.cpp
+//
+// Copyright (c) Microsoft Corporation.
+//-------------------------------------------------------------------------------------
+
+#include "directxtest.h"
+#include "atlasmetrics.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <exception>
+
+using namespace DirectX;
+
+namespace
+{
+    const HRESULT c_ArithmeticOverflow = static_cast<HRESULT>(0x80070216L);
+
+    // Owner values that aren't chart ids
+    const uint32_t c_Empty = UINT32_MAX;
+    const uint32_t c_Shared = UINT32_MAX - 1;
+
+    template<typename index_t>
+    HRESULT Rasterize(
+        const UVAtlasVertex* vertices, size_t nVerts,
+        const index_t* indices, size_t nFaces,
+        const uint32_t* facePartitioning,
+        size_t width, size_t height,
+        std::vector<uint32_t>& owner,
+        std::vector<UVAtlasChartMetrics>& charts)
+    {
+        for (size_t face = 0; face < nFaces; ++face)
+        {
+            const index_t i0 = indices[face * 3];
+            const index_t i1 = indices[face * 3 + 1];
+            const index_t i2 = indices[face * 3 + 2];
+            if (size_t(i0) >= nVerts || size_t(i1) >= nVerts || size_t(i2) >= nVerts)
+                return E_INVALIDARG;
+
+            const uint32_t id = facePartitioning[face];
+            auto& chart = charts[id];
+            ++chart.faceCount;
+
+            const XMVECTOR p0 = XMLoadFloat3(&vertices[i0].pos);
+            const XMVECTOR e1 = XMVectorSubtract(XMLoadFloat3(&vertices[i1].pos), p0);
+            const XMVECTOR e2 = XMVectorSubtract(XMLoadFloat3(&vertices[i2].pos), p0);
+            chart.surfaceArea += double(XMVectorGetX(XMVector3Length(XMVector3Cross(e1, e2)))) * 0.5;
+
+            XMFLOAT2 p[3];
+            const index_t tri[3] = { i0, i1, i2 };
+            for (size_t k = 0; k < 3; ++k)
+            {
+                const XMFLOAT2& uv = vertices[tri[k]].uv;
+                p[k] = XMFLOAT2(uv.x * float(width), uv.y * float(height));
+            }
+
+            const float area = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[2].x - p[0].x) * (p[1].y - p[0].y);
+            chart.uvArea += double(std::abs(area)) * 0.5;
+            if (area == 0.f)
+                continue;
+
+            // Half-open fill rule: a texel center exactly on an edge belongs to the triangle
+            // only for its top and left edges, so charts that just touch don't share texels
+            const float sign = (area > 0.f) ? 1.f : -1.f;
+            bool ownsEdge[3];
+            for (size_t k = 0; k < 3; ++k)
+            {
+                const float dx = (p[(k + 1) % 3].x - p[k].x) * sign;
+                const float dy = (p[(k + 1) % 3].y - p[k].y) * sign;
+                ownsEdge[k] = (dy > 0.f) || (dy == 0.f && dx < 0.f);
+            }
+
+            const float minX = std::max(0.f, std::floor(std::min({ p[0].x, p[1].x, p[2].x }) - 0.5f));
+            const float minY = std::max(0.f, std::floor(std::min({ p[0].y, p[1].y, p[2].y }) - 0.5f));
+            const float maxX = std::min(float(width - 1), std::ceil(std::max({ p[0].x, p[1].x, p[2].x }) - 0.5f));
+            const float maxY = std::min(float(height - 1), std::ceil(std::max({ p[0].y, p[1].y, p[2].y }) - 0.5f));
+            if (minX > maxX || minY > maxY)
+                continue;
+
+            for (size_t y = size_t(minY); y <= size_t(maxY); ++y)
+            {
+                const float cy = float(y) + 0.5f;
+                for (size_t x = size_t(minX); x <= size_t(maxX); ++x)
+                {
+                    const float cx = float(x) + 0.5f;
+                    bool inside = true;
+                    for (size_t k = 0; k < 3 && inside; ++k)
+                    {
+                        const XMFLOAT2& a = p[k];
+                        const XMFLOAT2& b = p[(k + 1) % 3];
+                        const float edge = ((b.x - a.x) * (cy - a.y) - (cx - a.x) * (b.y - a.y)) * sign;
+                        inside = (edge > 0.f) || (edge == 0.f && ownsEdge[k]);
+                    }
+
+                    if (!inside)
+                        continue;
+
+                    uint32_t& texel = owner[y * width + x];
+                    if (texel == c_Empty)
+                    {
+                        texel = id;
+                    }
+                    else if (texel != id)
+                    {
+                        texel = c_Shared;
+                    }
+                }
+            }
+        }
+
+        return S_OK;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT __cdecl UVAtlasComputeMetrics(
+    const UVAtlasVertex* vertices, size_t nVerts,
+    const void* indices,
+    DXGI_FORMAT indexFormat, size_t nFaces,
+    const uint32_t* pFacePartitioning,
+    size_t width, size_t height, float gutter,
+    UVAtlasMetrics& metrics)
+{
+    if (!vertices || !nVerts || !indices || !nFaces || !pFacePartitioning)
+        return E_INVALIDARG;
+
+    if (indexFormat != DXGI_FORMAT_R16_UINT && indexFormat != DXGI_FORMAT_R32_UINT)
+        return E_INVALIDARG;
+
+    if (!width || !height || !(gutter >= 0.f) || !(gutter <= float(std::max(width, height))))
+        return E_INVALIDARG;
+
+    if (nFaces >= c_Shared || width > SIZE_MAX / height)
+        return c_ArithmeticOverflow;
+
+    uint32_t maxChart = 0;
+    for (size_t face = 0; face < nFaces; ++face)
+    {
+        if (pFacePartitioning[face] >= nFaces)
+            return E_INVALIDARG;
+        maxChart = std::max(maxChart, pFacePartitioning[face]);
+    }
+
+    try
+    {
+        std::vector<UVAtlasChartMetrics> charts(size_t(maxChart) + 1, UVAtlasChartMetrics{});
+        std::vector<uint32_t> owner(width * height, c_Empty);
+
+        const HRESULT hr = (indexFormat == DXGI_FORMAT_R16_UINT)
+            ? Rasterize(vertices, nVerts, static_cast<const uint16_t*>(indices), nFaces, pFacePartitioning, width, height, owner, charts)
+            : Rasterize(vertices, nVerts, static_cast<const uint32_t*>(indices), nFaces, pFacePartitioning, width, height, owner, charts);
+        if (FAILED(hr))
+            return hr;
+
+        UVAtlasMetrics result = {};
+
+        // Offsets strictly inside the gutter radius; none when gutter is at most one texel
+        const float gutterSq = gutter * gutter;
+        const ptrdiff_t radius = ptrdiff_t(std::ceil(gutter)) - 1;
+
+        for (size_t y = 0; y < height; ++y)
+        {
+            for (size_t x = 0; x < width; ++x)
+            {
+                const uint32_t id = owner[y * width + x];
+                if (id == c_Empty)
+                    continue;
+
+                ++result.coveredTexels;
+                if (id == c_Shared)
+                {
+                    ++result.overlapTexels;
+                    continue;
+                }
+
+                ++charts[id].coveredTexels;
+
+                bool violation = false;
+                for (ptrdiff_t dy = -radius; dy <= radius && !violation; ++dy)
+                {
+                    const ptrdiff_t ny = ptrdiff_t(y) + dy;
+                    if (ny < 0 || ny >= ptrdiff_t(height))
+                        continue;
+
+                    for (ptrdiff_t dx = -radius; dx <= radius; ++dx)
+                    {
+                        const ptrdiff_t nx = ptrdiff_t(x) + dx;
+                        if (nx < 0 || nx >= ptrdiff_t(width) || float(dx * dx + dy * dy) >= gutterSq)
+                            continue;
+
+                        const uint32_t other = owner[size_t(ny) * width + size_t(nx)];
+                        if (other != c_Empty && other != c_Shared && other != id)
+                        {
+                            violation = true;
+                            break;
+                        }
+                    }
+                }
+
+                if (violation)
+                    ++result.gutterViolations;
+            }
+        }
+
+        result.coverage = float(double(result.coveredTexels) / (double(width) * double(height)));
+
+        float minDensity = FLT_MAX;
+        float maxDensity = 0.f;
+        for (auto& chart : charts)
+        {
+            if (!chart.faceCount || !(chart.surfaceArea > 0.0))
+                continue;
+
+            chart.texelDensity = float(std::sqrt(chart.uvArea / chart.surfaceArea));
+            minDensity = std::min(minDensity, chart.texelDensity);
+            maxDensity = std::max(maxDensity, chart.texelDensity);
+        }
+
+        result.minTexelDensity = (maxDensity > 0.f) ? minDensity : 0.f;
+        result.maxTexelDensity = maxDensity;
+        result.charts.swap(charts);
+
+        metrics = std::move(result);
+        return S_OK;
+    }
+    catch (const std::bad_alloc&)
+    {
+        return E_OUTOFMEMORY;
+    }
+}
@@ -0,0 +1,52 @@
+//-------------------------------------------------------------------------------------
+// atlasmetrics.h
+//
+// Packing quality of an atlas, measured by rasterizing its output UVs at the target
+// resolution
+//
+// Copyright (c) Microsoft Corporation.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "UVAtlas.h"
+
+struct UVAtlasChartMetrics
+{
+    size_t faceCount;
+    size_t coveredTexels;   // texel centers covered by this chart and no other
+    double uvArea;          // in texels
+    double surfaceArea;     // of the chart's triangles in object space
+    float texelDensity;     // texels per object-space unit of length; 0 for a degenerate chart
+};
+
+struct UVAtlasMetrics
+{
+    size_t coveredTexels;       // texel centers covered by any chart
+    float coverage;             // coveredTexels / (width * height)
+    size_t overlapTexels;       // texel centers covered by more than one chart
+    size_t gutterViolations;    // texels closer than gutter to a texel of another chart
+    float minTexelDensity;      // over charts with non-zero surface area
+    float maxTexelDensity;
+    std::vector<UVAtlasChartMetrics> charts;    // indexed by chart id
+};
+
+// Samples every texel center of a width x height atlas against the triangles of the mesh
+// as output by UVAtlasCreate or UVAtlasPack. pFacePartitioning gives the chart id of each
+// face; ids must be less than nFaces. A center on an edge shared by two triangles is
+// covered by exactly one of them, so charts that touch without overlapping count no
+// overlap texels. A texel counts as a gutter violation when its center
+// is less than gutter texels from the center of a texel covered by a different chart, so
+// overlaps are not counted again there. Texel density is sqrt(uvArea / surfaceArea) and
+// is uniform across charts for an undistorted, evenly scaled atlas.
+HRESULT __cdecl UVAtlasComputeMetrics(
+    _In_reads_(nVerts) const DirectX::UVAtlasVertex* vertices, size_t nVerts,
+    _When_(indexFormat == DXGI_FORMAT_R16_UINT, _In_reads_bytes_(nFaces * sizeof(uint16_t) * 3))
+    _When_(indexFormat != DXGI_FORMAT_R16_UINT, _In_reads_bytes_(nFaces * sizeof(uint32_t) * 3)) const void* indices,
+    DXGI_FORMAT indexFormat, size_t nFaces,
+    _In_reads_(nFaces) const uint32_t* pFacePartitioning,
+    size_t width, size_t height, float gutter,
+    UVAtlasMetrics& metrics);
@@ -0,0 +1,54 @@
+//-------------------------------------------------------------------------------------
+// atlasprogress.h
+//
+// Progress reporting and cancellation through a block of atomics shared with the caller,
+// as an alternative to writing a status callback
+//
+// Copyright (c) Microsoft Corporation.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+#include "UVAtlas.h"
+
+// The atlas call publishes progress here and stops with the given status once Cancel() is
+// called. Any thread can read or cancel at any time; nothing in the block takes a lock.
+struct UVAtlasProgress
+{
+    std::atomic<float> percentComplete;
+    std::atomic<uint32_t> updates;      // progress reports so far, for liveness checks
+    std::atomic<HRESULT> status;        // S_OK, or the failure to stop with
+
+    UVAtlasProgress() noexcept : percentComplete(0.f), updates(0), status(S_OK) {}
+
+    UVAtlasProgress(const UVAtlasProgress&) = delete;
+    UVAtlasProgress& operator=(const UVAtlasProgress&) = delete;
+
+    void Cancel(HRESULT hr = E_ABORT) noexcept
+    {
+        status.store(FAILED(hr) ? hr : E_ABORT, std::memory_order_relaxed);
+    }
+
+    bool IsCancelled() const noexcept
+    {
+        return FAILED(status.load(std::memory_order_relaxed));
+    }
+};
+
+// Status callback for UVAtlasCreate, UVAtlasPartition, UVAtlasPack or UVAtlasCreateParallel
+// that only stores into and reads from progress, which must outlive the call. The library
+// still polls through the callback, but no caller code runs on its thread.
+inline std::function<HRESULT __cdecl(float)> UVAtlasProgressCallback(UVAtlasProgress& progress)
+{
+    UVAtlasProgress* block = &progress;
+    return [block](float percentComplete) noexcept -> HRESULT
+    {
+        block->percentComplete.store(percentComplete, std::memory_order_relaxed);
+        block->updates.fetch_add(1, std::memory_order_relaxed);
+        return block->status.load(std::memory_order_relaxed);
+    };
+}
@@ -0,0 +1,340 @@
+//-------------------------------------------------------------------------------------
+// baseline.cpp
+//
+// Copyright (c) Microsoft Corporation.
+//-------------------------------------------------------------------------------------
+
+#include "directxtest.h"
+#include "baseline.h"
+
+#include "UVAtlas.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Minimal JSON reader covering what the baseline format needs. Values the gate does
+    // not understand are skipped so the file can carry extra annotations.
+    class JSONReader
+    {
+    public:
+        explicit JSONReader(const std::string& text) : m_text(text), m_pos(0) {}
+
+        bool ParseBaseline(Baseline& baseline, std::string* description)
+        {
+            if (!Expect('{'))
+                return false;
+
+            if (Peek('}'))
+                return Expect('}');
+
+            for (;;)
+            {
+                std::string key;
+                if (!ReadString(key) || !Expect(':'))
+                    return false;
+
+                if (key == "tests")
+                {
+                    if (!ParseTests(baseline))
+                        return false;
+                }
+                else if (key == "description" && description && Peek('"'))
+                {
+                    if (!ReadString(*description))
+                        return false;
+                }
+                else if (!SkipValue())
+                {
+                    return false;
+                }
+
+                if (Peek(','))
+                {
+                    Expect(',');
+                    continue;
+                }
+
+                return Expect('}');
+            }
+        }
+
+    private:
+        const std::string& m_text;
+        size_t m_pos;
+
+        void SkipWhitespace()
+        {
+            while (m_pos < m_text.size() && (m_text[m_pos] == ' ' || m_text[m_pos] == '\t' || m_text[m_pos] == '\r' || m_text[m_pos] == '\n'))
+                ++m_pos;
+        }
+
+        bool Peek(char ch)
+        {
+            SkipWhitespace();
+            return (m_pos < m_text.size() && m_text[m_pos] == ch);
+        }
+
+        bool Expect(char ch)
+        {
+            if (!Peek(ch))
+                return false;
+            ++m_pos;
+            return true;
+        }
+
+        bool ReadString(std::string& str)
+        {
+            if (!Expect('"'))
+                return false;
+
+            str.clear();
+            while (m_pos < m_text.size())
+            {
+                const char ch = m_text[m_pos++];
+                if (ch == '"')
+                    return true;
+
+                if (ch == '\\')
+                {
+                    if (m_pos >= m_text.size())
+                        return false;
+                    str += m_text[m_pos++];
+                }
+                else
+                {
+                    str += ch;
+                }
+            }
+
+            return false;
+        }
+
+        bool ReadNumber(double& value)
+        {
+            SkipWhitespace();
+            const char* start = m_text.c_str() + m_pos;
+            char* end = nullptr;
+            value = strtod(start, &end);
+            if (end == start)
+                return false;
+
+            m_pos += size_t(end - start);
+            return true;
+        }
+
+        bool SkipValue()
+        {
+            SkipWhitespace();
+            if (m_pos >= m_text.size())
+                return false;
+
+            const char ch = m_text[m_pos];
+            if (ch == '"')
+            {
+                std::string tmp;
+                return ReadString(tmp);
+            }
+            else if (ch == '{' || ch == '[')
+            {
+                const char close = (ch == '{') ? '}' : ']';
+                ++m_pos;
+                if (Peek(close))
+                    return Expect(close);
+
+                for (;;)
+                {
+                    if (ch == '{')
+                    {
+                        std::string tmp;
+                        if (!ReadString(tmp) || !Expect(':'))
+                            return false;
+                    }
+
+                    if (!SkipValue())
+                        return false;
+
+                    if (Peek(','))
+                    {
+                        Expect(',');
+                        continue;
+                    }
+
+                    return Expect(close);
+                }
+            }
+            else if (ch == 't' || ch == 'f' || ch == 'n')
+            {
+                while (m_pos < m_text.size() && isalpha(static_cast<unsigned char>(m_text[m_pos])))
+                    ++m_pos;
+                return true;
+            }
+
+            double tmp;
+            return ReadNumber(tmp);
+        }
+
+        bool ParseEntry(BaselineEntry& entry)
+        {
+            if (!Expect('{'))
+                return false;
+
+            if (Peek('}'))
+                return Expect('}');
+
+            for (;;)
+            {
+                std::string key;
+                if (!ReadString(key) || !Expect(':'))
+                    return false;
+
+                if (key == "median_ms")
+                {
+                    if (!ReadNumber(entry.medianMS))
+                        return false;
+                }
+                else if (key == "allocations")
+                {
+                    double value;
+                    if (!ReadNumber(value) || value < 0)
+                        return false;
+
+                    entry.allocations = static_cast<uint64_t>(value);
+                    entry.hasAllocations = true;
+                }
+                else if (!SkipValue())
+                {
+                    return false;
+                }
+
+                if (Peek(','))
+                {
+                    Expect(',');
+                    continue;
+                }
+
+                return Expect('}');
+            }
+        }
+
+        bool ParseTests(Baseline& baseline)
+        {
+            if (!Expect('{'))
+                return false;
+
+            if (Peek('}'))
+                return Expect('}');
+
+            for (;;)
+            {
+                std::string name;
+                if (!ReadString(name) || !Expect(':'))
+                    return false;
+
+                BaselineEntry entry;
+                if (!ParseEntry(entry))
+                    return false;
+
+                baseline[name] = entry;
+
+                if (Peek(','))
+                {
+                    Expect(',');
+                    continue;
+                }
+
+                return Expect('}');
+            }
+        }
+    };
+
+    std::string EscapeString(const char* str)
+    {
+        std::string result;
+        for (; *str; ++str)
+        {
+            if (*str == '"' || *str == '\\')
+                result += '\\';
+            result += *str;
+        }
+        return result;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+HRESULT LoadBaseline(const wchar_t* fileName, Baseline& baseline, std::string* description)
+{
+    baseline.clear();
+    if (description)
+        description->clear();
+
+    if (!fileName)
+        return E_INVALIDARG;
+
+    FILE* fp = OpenFile(fileName, "rb");
+    if (!fp)
+        return E_FAIL;
+
+    std::string text;
+    char buffer[4096];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+    {
+        text.append(buffer, count);
+    }
+
+    fclose(fp);
+
+    JSONReader reader(text);
+    if (!reader.ParseBaseline(baseline, description))
+    {
+        baseline.clear();
+        if (description)
+            description->clear();
+        return E_FAIL;
+    }
+
+    return S_OK;
+}
+
+
+//-------------------------------------------------------------------------------------
+HRESULT SaveBaseline(const wchar_t* fileName, const Baseline& baseline, const char* description)
+{
+    if (!fileName)
+        return E_INVALIDARG;
+
+    FILE* fp = OpenFile(fileName, "wt");
+    if (!fp)
+        return E_FAIL;
+
+    fprintf(fp, "{\n  \"suite\": \"%s\",\n  \"version\": %d,\n", _DIRECTX_TEST_NAME_, UVATLAS_VERSION);
+    if (description && *description)
+    {
+        fprintf(fp, "  \"description\": \"%s\",\n", EscapeString(description).c_str());
+    }
+    fprintf(fp, "  \"tests\": {");
+
+    bool first = true;
+    for (const auto& it : baseline)
+    {
+        const std::string name = EscapeString(it.first.c_str());
+
+        fprintf(fp, "%s\n    \"%s\": { \"median_ms\": %.3f", first ? "" : ",", name.c_str(), it.second.medianMS);
+        if (it.second.hasAllocations)
+        {
+            fprintf(fp, ", \"allocations\": %llu", static_cast<unsigned long long>(it.second.allocations));
+        }
+        fprintf(fp, " }");
+        first = false;
+    }
+
+    fprintf(fp, "\n  }\n}\n");
+    fclose(fp);
+
+    return S_OK;
+}
@@ -0,0 +1,30 @@
+//-------------------------------------------------------------------------------------
+// baseline.h
+//
+// Performance baseline store used by the xtuvatlas regression gate
+//
+// Copyright (c) Microsoft Corporation.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+struct BaselineEntry
+{
+    double medianMS;
+    uint64_t allocations;
+    bool hasAllocations;
+
+    BaselineEntry() : medianMS(0), allocations(0), hasAllocations(false) {}
+};
+
+using Baseline = std::map<std::string, BaselineEntry>;
+
+// Baseline files are JSON: { "tests": { "<test name>": { "median_ms": <number>, "allocations": <number> }, ... } }
+// where "allocations" is optional and only recorded by allocation-tracking builds. A
+// top-level "description" string is read and written back so rewriting a file keeps it.
+HRESULT LoadBaseline(_In_z_ const wchar_t* fileName, Baseline& baseline, _Out_opt_ std::string* description = nullptr);
+HRESULT SaveBaseline(_In_z_ const wchar_t* fileName, const Baseline& baseline, _In_opt_z_ const char* description = nullptr);
@@ -0,0 +1,611 @@
+//-------------------------------------------------------------------------------------
+// bitsetpacker.cpp
+//
+// Copyright (c) Microsoft Corporation.
+//-------------------------------------------------------------------------------------
+
+#include "directxtest.h"
+#include "bitsetpacker.h"
+#include "unionfind.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <exception>
+#include <numeric>
+
+using namespace DirectX;
+
+namespace
+{
+    // Binary search steps on the chart scale; each step is one full packing attempt
+    const size_t c_ScaleSteps = 10;
+
+    const int32_t c_EmptyColumn = INT32_MAX;
+
+    struct Chart
+    {
+        std::vector<uint32_t> faces;
+        std::vector<uint32_t> verts;
+        XMFLOAT2 minUV;
+        XMFLOAT2 maxUV;
+        double area;
+    };
+
+    // Chart coverage at one scale and rotation; rows of 64-bit words, bit x of row y is texel (x, y)
+    struct ChartMask
+    {
+        int32_t width;
+        int32_t height;
+        size_t words;
+        std::vector<uint64_t> bits;
+        std::vector<int32_t> bottom;    // lowest covered row per column, or c_EmptyColumn
+        std::vector<int32_t> top;       // highest covered row per column
+    };
+
+    struct Placement
+    {
+        int32_t x;
+        int32_t y;
+        bool rotated;
+    };
+
+    //---------------------------------------------------------------------------------
+    // Chart UV -> mask texel coordinates for the given scale and rotation
+    inline XMFLOAT2 ToChartSpace(const Chart& chart, const XMFLOAT2& uv, float scale, bool rotated) noexcept
+    {
+        if (rotated)
+            return XMFLOAT2((uv.y - chart.minUV.y) * scale, (chart.maxUV.x - uv.x) * scale);
+
+        return XMFLOAT2((uv.x - chart.minUV.x) * scale, (uv.y - chart.minUV.y) * scale);
+    }
+
+    inline size_t CountTrailingZeros(uint64_t value) noexcept
+    {
+    #if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return index;
+    #elif defined(_MSC_VER)
+        unsigned long index;
+        if (_BitScanForward(&index, static_cast<unsigned long>(value)))
+            return index;
+        _BitScanForward(&index, static_cast<unsigned long>(value >> 32));
+        return size_t(index) + 32;
+    #else
+        return size_t(__builtin_ctzll(value));
+    #endif
+    }
+
+    // Sets texels [x0, x1] of one mask row a word at a time
+    void SetSpan(uint64_t* row, int32_t x0, int32_t x1) noexcept
+    {
+        for (int32_t x = x0; x <= x1; )
+        {
+            const int32_t bit = x % 64;
+            const int32_t count = std::min(64 - bit, x1 - x + 1);
+            const uint64_t bits = (count == 64) ? ~uint64_t(0) : (((uint64_t(1) << count) - 1) << bit);
+            row[x / 64] |= bits;
+            x += count;
+        }
+    }
+
+    // Conservative coverage of one triangle: for each texel row, the x extent of the triangle
+    // clipped to the band [y, y+1] is marked, so any texel the triangle touches is set
+    void RasterizeTriangle(const XMFLOAT2* p, ChartMask& mask) noexcept
+    {
+        const float minY = std::min({ p[0].y, p[1].y, p[2].y });
+        const float maxY = std::max({ p[0].y, p[1].y, p[2].y });
+        const int32_t y0 = std::max(0, int32_t(std::floor(minY)));
+        const int32_t y1 = std::min(mask.height - 1, int32_t(std::floor(maxY)));
+
+        for (int32_t y = y0; y <= y1; ++y)
+        {
+            const float bandLo = std::max(float(y), minY);
+            const float bandHi = std::min(float(y + 1), maxY);
+
+            float minX = FLT_MAX;
+            float maxX = -FLT_MAX;
+            for (size_t k = 0; k < 3; ++k)
+            {
+                const XMFLOAT2& a = p[k];
+                const XMFLOAT2& b = p[(k + 1) % 3];
+
+                if (a.y >= bandLo && a.y <= bandHi)
+                {
+                    minX = std::min(minX, a.x);
+                    maxX = std::max(maxX, a.x);
+                }
+
+                // Where the edge crosses the band's bounding lines
+                if (a.y != b.y)
+                {
+                    for (const float line : { bandLo, bandHi })
+                    {
+                        const float t = (line - a.y) / (b.y - a.y);
+                        if (t >= 0.f && t <= 1.f)
+                        {
+                            const float x = a.x + (b.x - a.x) * t;
+                            minX = std::min(minX, x);
+                            maxX = std::max(maxX, x);
+                        }
+                    }
+                }
+            }
+
+            if (minX > maxX)
+                continue;
+
+            const int32_t x0 = std::max(0, int32_t(std::floor(minX)));
+            const int32_t x1 = std::min(mask.width - 1, int32_t(std::floor(maxX)));
+            if (x0 <= x1)
+                SetSpan(&mask.bits[size_t(y) * mask.words], x0, x1);
+        }
+    }
+
+    template<typename index_t>
+    void BuildMask(const Chart& chart, const std::vector<UVAtlasVertex>& vb, const index_t* indices,
+        float scale, bool rotated, ChartMask& mask)
+    {
+        const float extentX = (rotated ? (chart.maxUV.y - chart.minUV.y) : (chart.maxUV.x - chart.minUV.x)) * scale;
+        const float extentY = (rotated ? (chart.maxUV.x - chart.minUV.x) : (chart.maxUV.y - chart.minUV.y)) * scale;
+
+        mask.width = int32_t(std::floor(extentX)) + 1;
+        mask.height = int32_t(std::floor(extentY)) + 1;
+        mask.words = (size_t(mask.width) + 63) / 64;
+        mask.bits.assign(mask.words * size_t(mask.height), 0);
+
+        for (auto face : chart.faces)
+        {
+            XMFLOAT2 p[3];
+            for (size_t k = 0; k < 3; ++k)
+                p[k] = ToChartSpace(chart, vb[indices[face * 3 + k]].uv, scale, rotated);
+
+            RasterizeTriangle(p, mask);
+        }
+
+        // Column profiles from the first and last row each column's bit shows up in
+        mask.bottom.assign(size_t(mask.width), c_EmptyColumn);
+        mask.top.assign(size_t(mask.width), -1);
+
+        std::vector<uint64_t> seen(mask.words, 0);
+        for (int32_t y = 0; y < mask.height; ++y)
+        {
+            const uint64_t* row = &mask.bits[size_t(y) * mask.words];
+            for (size_t w = 0; w < mask.words; ++w)
+            {
+                for (uint64_t bits = row[w] & ~seen[w]; bits; bits &= bits - 1)
+                    mask.bottom[w * 64 + CountTrailingZeros(bits)] = y;
+                seen[w] |= row[w];
+            }
+        }
+
+        std::fill(seen.begin(), seen.end(), 0);
+        for (int32_t y = mask.height - 1; y >= 0; --y)
+        {
+            const uint64_t* row = &mask.bits[size_t(y) * mask.words];
+            for (size_t w = 0; w < mask.words; ++w)
+            {
+                for (uint64_t bits = row[w] & ~seen[w]; bits; bits &= bits - 1)
+                    mask.top[w * 64 + CountTrailingZeros(bits)] = y;
+                seen[w] |= row[w];
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    class Atlas
+    {
+    public:
+        Atlas(int32_t width, int32_t height, int32_t gutter) :
+            m_width(width),
+            m_height(height),
+            m_gutter(gutter),
+            m_words((size_t(width) + 63) / 64),
+            m_bits(m_words * size_t(height), 0),
+            m_skyline(size_t(width), 0)
+        {
+        }
+
+        // Lowest position for the mask, or false if it doesn't fit
+        bool Find(const ChartMask& mask, int32_t& outX, int32_t& outY) const
+        {
+            if (mask.width > m_width || mask.height > m_height)
+                return false;
+
+            // Skyline candidates: the mask's left edge at the start of a skyline segment, or its
+            // right edge at the end of one. The drop rests the chart's own bottom profile on the
+            // skyline, so it can sink into steps a bounding box would sit on top of.
+            bool found = false;
+            const int32_t last = m_width - mask.width;
+            for (int32_t x = 0; x <= last; ++x)
+            {
+                const bool leftEdge = (x == 0) || (m_skyline[size_t(x)] != m_skyline[size_t(x - 1)]);
+                const bool rightEdge = (x == last) || (m_skyline[size_t(x + mask.width)] != m_skyline[size_t(x + mask.width - 1)]);
+                if (!leftEdge && !rightEdge)
+                    continue;
+
+                int32_t y = 0;
+                for (int32_t c = 0; c < mask.width; ++c)
+                {
+                    const int32_t bottom = mask.bottom[size_t(c)];
+                    if (bottom != c_EmptyColumn)
+                        y = std::max(y, m_skyline[size_t(x + c)] - bottom);
+
+                    if (found && y >= outY)
+                        break;
+                }
+
+                if (y + mask.height > m_height || (found && y >= outY))
+                    continue;
+
+                outX = x;
+                outY = y;
+                found = true;
+            }
+
+            return found;
+        }
+
+        // True if no covered texel of the mask lands on an occupied (gutter-dilated) texel
+        bool Fits(const ChartMask& mask, int32_t x, int32_t y) const noexcept
+        {
+            const size_t shift = size_t(x) % 64;
+            const size_t base = size_t(x) / 64;
+            for (int32_t r = 0; r < mask.height; ++r)
+            {
+                const uint64_t* row = &m_bits[size_t(y + r) * m_words];
+                const uint64_t* mrow = &mask.bits[size_t(r) * mask.words];
+
+                // Compare one 64-bit word of the mask against the matching span of the atlas row
+                for (size_t w = 0; w < mask.words; ++w)
+                {
+                    const size_t atlasWord = base + w;
+                    uint64_t occupied = row[atlasWord] >> shift;
+                    if (shift && atlasWord + 1 < m_words)
+                        occupied |= row[atlasWord + 1] << (64 - shift);
+
+                    if (occupied & mrow[w])
+                        return false;
+                }
+            }
+
+            return true;
+        }
+
+        // Marks the mask dilated by the gutter as occupied and raises the skyline
+        void Place(const ChartMask& mask, int32_t x, int32_t y)
+        {
+            // Bit i of a dilated row is atlas column x - gutter + i
+            const size_t dwords = (size_t(mask.width) + size_t(m_gutter) * 2 + 63) / 64;
+            std::vector<uint64_t> dilated(dwords + 1);
+            for (int32_t r = 0; r < mask.height; ++r)
+            {
+                const uint64_t* mrow = &mask.bits[size_t(r) * mask.words];
+
+                std::fill(dilated.begin(), dilated.end(), 0);
+                for (int32_t d = 0; d <= m_gutter * 2; ++d)
+                    OrShifted(dilated.data(), mrow, mask.words, size_t(d));
+
+                const int32_t y0 = std::max(0, y + r - m_gutter);
+                const int32_t y1 = std::min(m_height - 1, y + r + m_gutter);
+                for (int32_t ty = y0; ty <= y1; ++ty)
+                    OrIntoRow(ty, dilated.data(), dwords, x - m_gutter);
+            }
+
+            for (int32_t c = 0; c < mask.width; ++c)
+            {
+                if (mask.bottom[size_t(c)] == c_EmptyColumn)
+                    continue;
+
+                const int32_t height = std::min(y + mask.top[size_t(c)] + 1 + m_gutter, m_height);
+                for (int32_t d = -m_gutter; d <= m_gutter; ++d)
+                {
+                    const int32_t tx = x + c + d;
+                    if (tx >= 0 && tx < m_width)
+                        m_skyline[size_t(tx)] = std::max(m_skyline[size_t(tx)], height);
+                }
+            }
+        }
+
+    private:
+        // dst |= src << shift, across word boundaries
+        static void OrShifted(uint64_t* dst, const uint64_t* src, size_t words, size_t shift) noexcept
+        {
+            const size_t wordShift = shift / 64;
+            const size_t bitShift = shift % 64;
+            for (size_t w = 0; w < words; ++w)
+            {
+                dst[w + wordShift] |= src[w] << bitShift;
+                if (bitShift)
+                    dst[w + wordShift + 1] |= src[w] >> (64 - bitShift);
+            }
+        }
+
+        // Atlas row y |= src placed with its bit 0 at column start (which may be negative)
+        void OrIntoRow(int32_t y, const uint64_t* src, size_t words, int32_t start) noexcept
+        {
+            uint64_t* row = &m_bits[size_t(y) * m_words];
+            for (size_t w = 0; w < words; ++w)
+            {
+                uint64_t value = src[w];
+                int32_t base = start + int32_t(w * 64);
+                if (base < 0)
+                {
+                    if (base <= -64)
+                        continue;
+                    value >>= -base;
+                    base = 0;
+                }
+
+                const size_t index = size_t(base) / 64;
+                const size_t shift = size_t(base) % 64;
+                if (index >= m_words)
+                    break;
+
+                row[index] |= value << shift;
+                if (shift && index + 1 < m_words)
+                    row[index + 1] |= value >> (64 - shift);
+            }
+
+            // Nothing past the right edge
+            if (m_width % 64)
+                row[m_words - 1] &= (uint64_t(1) << (m_width % 64)) - 1;
+        }
+
+        int32_t m_width;
+        int32_t m_height;
+        int32_t m_gutter;
+        size_t m_words;
+        std::vector<uint64_t> m_bits;
+        std::vector<int32_t> m_skyline;
+    };
+
+    //---------------------------------------------------------------------------------
+    template<typename index_t>
+    bool TryPack(const std::vector<Chart>& charts, const std::vector<size_t>& order,
+        const std::vector<UVAtlasVertex>& vb, const index_t* indices,
+        int32_t width, int32_t height, int32_t gutter, float scale,
+        std::vector<Placement>& placements)
+    {
+        Atlas atlas(width, height, gutter);
+        placements.resize(charts.size());
+
+        ChartMask masks[2];
+        for (auto index : order)
+        {
+            int32_t bestX = 0, bestY = 0, bestTop = INT32_MAX;
+            bool bestRotated = false;
+            for (size_t r = 0; r < 2; ++r)
+            {
+                BuildMask(charts[index], vb, indices, scale, r != 0, masks[r]);
+
+                int32_t x, y;
+                if (atlas.Find(masks[r], x, y) && (y + masks[r].height) < bestTop)
+                {
+                    bestX = x;
+                    bestY = y;
+                    bestTop = y + masks[r].height;
+                    bestRotated = (r != 0);
+                }
+            }
+
+            if (bestTop == INT32_MAX)
+                return false;
+
+            const ChartMask& mask = masks[bestRotated ? 1 : 0];
+            if (!atlas.Fits(mask, bestX, bestY))
+                return false;
+
+            atlas.Place(mask, bestX, bestY);
+            placements[index] = Placement{ bestX, bestY, bestRotated };
+        }
+
+        return true;
+    }
+
+    template<typename index_t>
+    HRESULT PackBitset(
+        std::vector<UVAtlasVertex>& vb, const index_t* indices, size_t nFaces,
+        size_t width, size_t height, float gutter,
+        const std::vector<uint32_t>& adjacency,
+        const std::function<HRESULT __cdecl(float)>& statusCallBack)
+    {
+        const size_t nVerts = vb.size();
+
+        // Charts are the face groups connected through the partition adjacency
+        std::vector<uint32_t> parent(nFaces);
+        std::iota(parent.begin(), parent.end(), 0u);
+        for (size_t face = 0; face < nFaces; ++face)
+        {
+            for (size_t k = 0; k < 3; ++k)
+            {
+                if (size_t(indices[face * 3 + k]) >= nVerts)
+                    return E_INVALIDARG;
+
+                const uint32_t neighbor = adjacency[face * 3 + k];
+                if (neighbor == uint32_t(-1))
+                    continue;
+                if (neighbor >= nFaces)
+                    return E_INVALIDARG;
+
+                UnionRoots(parent, uint32_t(face), neighbor);
+            }
+        }
+
+        std::vector<Chart> charts;
+        std::vector<uint32_t> chartOf(nFaces, uint32_t(-1));
+        std::vector<uint32_t> vertChart(nVerts, uint32_t(-1));
+        double totalArea = 0;
+        for (size_t face = 0; face < nFaces; ++face)
+        {
+            const uint32_t root = FindRoot(parent, uint32_t(face));
+            if (chartOf[root] == uint32_t(-1))
+            {
+                chartOf[root] = uint32_t(charts.size());
+                Chart chart;
+                chart.minUV = XMFLOAT2(FLT_MAX, FLT_MAX);
+                chart.maxUV = XMFLOAT2(-FLT_MAX, -FLT_MAX);
+                chart.area = 0;
+                charts.emplace_back(std::move(chart));
+            }
+
+            const uint32_t index = chartOf[root];
+            auto& chart = charts[index];
+            chart.faces.push_back(uint32_t(face));
+
+            XMFLOAT2 p[3];
+            for (size_t k = 0; k < 3; ++k)
+            {
+                const index_t v = indices[face * 3 + k];
+                p[k] = vb[v].uv;
+                chart.minUV.x = std::min(chart.minUV.x, p[k].x);
+                chart.minUV.y = std::min(chart.minUV.y, p[k].y);
+                chart.maxUV.x = std::max(chart.maxUV.x, p[k].x);
+                chart.maxUV.y = std::max(chart.maxUV.y, p[k].y);
+
+                if (vertChart[v] == uint32_t(-1))
+                {
+                    vertChart[v] = index;
+                    chart.verts.push_back(uint32_t(v));
+                }
+            }
+
+            const double area = std::abs(double(p[1].x - p[0].x) * double(p[2].y - p[0].y)
+                - double(p[2].x - p[0].x) * double(p[1].y - p[0].y)) * 0.5;
+            chart.area += area;
+            totalArea += area;
+        }
+
+        if (charts.empty() || !(totalArea > 0))
+            return E_FAIL;
+
+        // Largest charts first, as the skyline fills best from big to small
+        std::vector<size_t> order(charts.size());
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::stable_sort(order.begin(), order.end(),
+            [&](size_t a, size_t b) { return charts[a].area > charts[b].area; });
+
+        const int32_t w = int32_t(width);
+        const int32_t h = int32_t(height);
+        const int32_t g = int32_t(std::ceil(gutter));
+
+        // Scale can't exceed the one where the charts would exactly cover the atlas
+        double lo = 0;
+        double hi = std::sqrt(double(width) * double(height) / totalArea);
+        double scale = hi * 0.7;
+
+        std::vector<Placement> placements;
+        std::vector<Placement> best;
+        double bestScale = 0;
+        for (size_t step = 0; step < c_ScaleSteps || bestScale == 0; ++step)
+        {
+            if (statusCallBack)
+            {
+                const HRESULT hr = statusCallBack(std::min(1.f, float(step) / float(c_ScaleSteps)));
+                if (FAILED(hr))
+                    return hr;
+            }
+
+            if (TryPack(charts, order, vb, indices, w, h, g, float(scale), placements))
+            {
+                lo = scale;
+                bestScale = scale;
+                best.swap(placements);
+            }
+            else
+            {
+                hi = scale;
+            }
+
+            // Nothing fit even when very small, e.g. more charts than texels
+            if (bestScale == 0 && step >= c_ScaleSteps * 3)
+                return E_FAIL;
+
+            scale = (bestScale == 0) ? (hi * 0.5) : ((lo + hi) * 0.5);
+        }
+
+        const float s = float(bestScale);
+        for (size_t j = 0; j < charts.size(); ++j)
+        {
+            const auto& chart = charts[j];
+            const auto& placement = best[j];
+            for (auto v : chart.verts)
+            {
+                const XMFLOAT2 p = ToChartSpace(chart, vb[v].uv, s, placement.rotated);
+                vb[v].uv = XMFLOAT2((p.x + float(placement.x)) / float(width), (p.y + float(placement.y)) / float(height));
+            }
+        }
+
+        if (statusCallBack)
+        {
+            const HRESULT hr = statusCallBack(1.f);
+            if (FAILED(hr))
+                return hr;
+        }
+
+        return S_OK;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT __cdecl UVAtlasPackEx(
+    std::vector<UVAtlasVertex>& vMeshVertexBuffer,
+    std::vector<uint8_t>& vMeshIndexBuffer,
+    DXGI_FORMAT indexFormat,
+    size_t width, size_t height, float gutter,
+    const std::vector<uint32_t>& vPartitionResultAdjacency,
+    std::function<HRESULT __cdecl(float percentComplete)> statusCallBack,
+    float callbackFrequency,
+    UVATLAS_PACKER packer)
+{
+    if (packer == UVATLAS_PACKER_DEFAULT)
+    {
+        return UVAtlasPack(vMeshVertexBuffer, vMeshIndexBuffer, indexFormat, width, height, gutter,
+            vPartitionResultAdjacency, statusCallBack, callbackFrequency);
+    }
+
+    if (packer != UVATLAS_PACKER_BITSET)
+        return E_INVALIDARG;
+
+    if (!width || !height || width > INT32_MAX / 2 || height > INT32_MAX / 2 || !(gutter >= 0.f))
+        return E_INVALIDARG;
+
+    size_t indexSize;
+    switch (indexFormat)
+    {
+    case DXGI_FORMAT_R16_UINT: indexSize = sizeof(uint16_t); break;
+    case DXGI_FORMAT_R32_UINT: indexSize = sizeof(uint32_t); break;
+    default: return E_INVALIDARG;
+    }
+
+    const size_t nFaces = vMeshIndexBuffer.size() / (indexSize * 3);
+    if (vMeshVertexBuffer.empty() || !nFaces
+        || vMeshIndexBuffer.size() != nFaces * indexSize * 3
+        || vPartitionResultAdjacency.size() != nFaces * 3)
+        return E_INVALIDARG;
+
+    try
+    {
+        // Works on a copy so a failed pack leaves the caller's vertices alone
+        std::vector<UVAtlasVertex> vb = vMeshVertexBuffer;
+
+        const HRESULT hr = (indexFormat == DXGI_FORMAT_R16_UINT)
+            ? PackBitset(vb, reinterpret_cast<const uint16_t*>(vMeshIndexBuffer.data()), nFaces,
+                width, height, gutter, vPartitionResultAdjacency, statusCallBack)
+            : PackBitset(vb, reinterpret_cast<const uint32_t*>(vMeshIndexBuffer.data()), nFaces,
+                width, height, gutter, vPartitionResultAdjacency, statusCallBack);
+        if (FAILED(hr))
+            return hr;
+
+        vMeshVertexBuffer.swap(vb);
+        return S_OK;
+    }
+    catch (const std::bad_alloc&)
+    {
+        return E_OUTOFMEMORY;
+    }
+}
@@ -0,0 +1,40 @@
+//-------------------------------------------------------------------------------------
+// bitsetpacker.h
+//
+// Alternate chart packer for the output of UVAtlasPartition, using a rasterized bitset
+// occupancy grid and skyline candidate placement
+//
+// Copyright (c) Microsoft Corporation.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "UVAtlas.h"
+
+enum UVATLAS_PACKER : uint32_t
+{
+    UVATLAS_PACKER_DEFAULT = 0x0,   // UVAtlasPack
+    UVATLAS_PACKER_BITSET = 0x1,
+};
+
+// Same contract as UVAtlasPack, with the packing engine selected by packer.
+//
+// The bitset packer rasterizes each chart conservatively at the candidate scale, drops it
+// onto a skyline using the chart's own bottom profile (so charts interlock rather than
+// stacking bounding boxes), tries 0 and 90 degree rotations, and binary searches the
+// largest uniform scale at which every chart fits. Charts keep at least gutter texels
+// between them; the atlas border is not padded. It reports progress once per scale step, so
+// callbackFrequency only applies to the default packer.
+HRESULT __cdecl UVAtlasPackEx(
+    std::vector<DirectX::UVAtlasVertex>& vMeshVertexBuffer,
+    std::vector<uint8_t>& vMeshIndexBuffer,
+    DXGI_FORMAT indexFormat,
+    size_t width, size_t height, float gutter,
+    const std::vector<uint32_t>& vPartitionResultAdjacency,
+    std::function<HRESULT __cdecl(float percentComplete)> statusCallBack,
+    float callbackFrequency,
+    UVATLAS_PACKER packer);
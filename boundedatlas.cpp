@@ -0,0 +1,383 @@
+//-------------------------------------------------------------------------------------
+// boundedatlas.cpp
+//
+// Copyright (c) Microsoft Corporation.
+//-------------------------------------------------------------------------------------
+
+#include "directxtest.h"
+#include "boundedatlas.h"
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+
+using namespace DirectX;
+
+namespace
+{
+    const HRESULT c_ArithmeticOverflow = static_cast<HRESULT>(0x80070216L);
+
+    // Per-face estimates. Under-estimating breaks the budget while over-estimating only
+    // costs extra groups, so they err high.
+    const size_t c_PartitionBytesPerFace = UVATLAS_BOUNDED_PARTITION_BYTES_PER_FACE;
+    const size_t c_OutputBytesPerFace = 64;         // merged outputs, with slack for vertex buffer growth
+    const size_t c_PackBytesPerFace = 64;           // UVAtlasPack scratch over the merged charts; only a feasibility check
+    const size_t c_MinGroupFaces = 4096;
+
+    // Partition progress stays below the pack phase so the boundary report is the first at it
+    const float c_MaxPartitionProgress = std::nextafter(UVATLAS_BOUNDED_PACK_PROGRESS, 0.f);
+
+    // localFace values that aren't local face indices
+    const uint32_t c_Unassigned = UINT32_MAX;
+    const uint32_t c_Done = UINT32_MAX - 1;
+
+    HRESULT CreateWhole(
+        const XMFLOAT3* positions, size_t nVerts,
+        const void* indices, DXGI_FORMAT indexFormat, size_t nFaces,
+        size_t maxChartNumber, float maxStretch,
+        size_t width, size_t height, float gutter,
+        const uint32_t* adjacency, const uint32_t* falseEdgeAdjacency, const float* pIMTArray,
+        std::function<HRESULT __cdecl(float)> statusCallBack, float callbackFrequency,
+        UVATLAS options,
+        std::vector<UVAtlasVertex>& vMeshOutVertexBuffer,
+        std::vector<uint8_t>& vMeshOutIndexBuffer,
+        std::vector<uint32_t>* pvFacePartitioning,
+        std::vector<uint32_t>* pvVertexRemapArray,
+        float* maxStretchOut,
+        size_t* numChartsOut,
+        size_t* numGroupsOut)
+    {
+        const HRESULT hr = UVAtlasCreate(positions, nVerts, indices, indexFormat, nFaces,
+            maxChartNumber, maxStretch, width, height, gutter,
+            adjacency, falseEdgeAdjacency, pIMTArray, statusCallBack, callbackFrequency,
+            options, vMeshOutVertexBuffer, vMeshOutIndexBuffer,
+            pvFacePartitioning, pvVertexRemapArray, maxStretchOut, numChartsOut);
+
+        if (SUCCEEDED(hr) && numGroupsOut)
+            *numGroupsOut = 1;
+
+        return hr;
+    }
+
+    template<typename index_t>
+    HRESULT CreateBounded(
+        const XMFLOAT3* positions, size_t nVerts,
+        const index_t* indices, DXGI_FORMAT indexFormat, size_t nFaces,
+        float maxStretch,
+        size_t width, size_t height, float gutter,
+        const uint32_t* adjacency, const uint32_t* falseEdgeAdjacency, const float* pIMTArray,
+        std::function<HRESULT __cdecl(float)> statusCallBack, float callbackFrequency,
+        UVATLAS options,
+        size_t groupFaces,
+        std::vector<UVAtlasVertex>& vMeshOutVertexBuffer,
+        std::vector<uint8_t>& vMeshOutIndexBuffer,
+        std::vector<uint32_t>* pvFacePartitioning,
+        std::vector<uint32_t>* pvVertexRemapArray,
+        float* maxStretchOut,
+        size_t* numChartsOut,
+        size_t* numGroupsOut)
+    {
+        // Input face -> local face of the current group, and input vertex -> local vertex
+        std::vector<uint32_t> localFace(nFaces, c_Unassigned);
+        std::vector<uint32_t> localVert(nVerts, c_Unassigned);
+
+        // Outputs are filled in place as each group finishes, so no group's results are
+        // held past its merge
+        std::vector<UVAtlasVertex> vb;
+        std::vector<uint32_t> vertexRemap;
+        std::vector<uint8_t> ib(nFaces * 3 * sizeof(index_t));
+        std::vector<uint32_t> facePartitioning(nFaces, 0);
+        std::vector<uint32_t> partitionAdjacency(nFaces * 3, uint32_t(-1));
+
+        auto outIndices = reinterpret_cast<index_t*>(ib.data());
+        const size_t maxIndex = (sizeof(index_t) == 2) ? size_t(UINT16_MAX) : size_t(UINT32_MAX);
+
+        size_t doneFaces = 0;
+        size_t nextSeed = 0;
+        size_t groups = 0;
+        size_t charts = 0;
+        float stretch = 0.f;
+
+        // Unused faces (an index of -1) join no group and keep the marker in every index
+        for (size_t face = 0; face < nFaces; ++face)
+        {
+            if (indices[face * 3] == index_t(-1) || indices[face * 3 + 1] == index_t(-1) || indices[face * 3 + 2] == index_t(-1))
+            {
+                for (size_t k = 0; k < 3; ++k)
+                    outIndices[face * 3 + k] = index_t(-1);
+
+                localFace[face] = c_Done;
+                ++doneFaces;
+            }
+        }
+
+        while (doneFaces < nFaces)
+        {
+            // Grow the group breadth-first from the lowest unassigned face. When a component
+            // runs out before the group is full the next one joins it, so small components
+            // share a partition call.
+            std::vector<uint32_t> faces;    // local face -> input face
+            faces.reserve(std::min(groupFaces, nFaces - doneFaces));
+
+            size_t head = 0;
+            while (faces.size() < groupFaces)
+            {
+                if (head == faces.size())
+                {
+                    while (nextSeed < nFaces && localFace[nextSeed] != c_Unassigned)
+                        ++nextSeed;
+
+                    if (nextSeed >= nFaces)
+                        break;
+
+                    localFace[nextSeed] = uint32_t(faces.size());
+                    faces.push_back(uint32_t(nextSeed));
+                }
+
+                const size_t face = faces[head++];
+                for (size_t k = 0; k < 3 && faces.size() < groupFaces; ++k)
+                {
+                    const uint32_t neighbor = adjacency[face * 3 + k];
+                    if (neighbor < nFaces && localFace[neighbor] == c_Unassigned)
+                    {
+                        localFace[neighbor] = uint32_t(faces.size());
+                        faces.push_back(neighbor);
+                    }
+                }
+            }
+
+            const size_t nLocalFaces = faces.size();
+
+            std::vector<uint32_t> verts;    // local vertex -> input vertex
+            std::vector<UVAtlasVertex> groupVB;
+            std::vector<uint8_t> groupIB;
+            std::vector<uint32_t> groupFacePartitioning;
+            std::vector<uint32_t> groupVertexRemap;
+            std::vector<uint32_t> groupAdjacency;
+            float groupStretch = 0.f;
+            size_t groupCharts = 0;
+
+            {
+                std::vector<index_t> localIndices(nLocalFaces * 3);
+                std::vector<uint32_t> localAdj(nLocalFaces * 3);
+                std::vector<uint32_t> localFalseEdges(falseEdgeAdjacency ? nLocalFaces * 3 : 0);
+                std::vector<float> localIMT(pIMTArray ? nLocalFaces * 3 : 0);
+
+                // Neighbors in other groups become boundary edges, and so chart seams
+                auto toLocalFace = [&](uint32_t face) -> uint32_t
+                {
+                    return (face < nFaces && localFace[face] < c_Done) ? localFace[face] : uint32_t(-1);
+                };
+
+                for (size_t j = 0; j < nLocalFaces; ++j)
+                {
+                    const size_t face = faces[j];
+                    for (size_t k = 0; k < 3; ++k)
+                    {
+                        const index_t v = indices[face * 3 + k];
+                        if (size_t(v) < nVerts)
+                        {
+                            if (localVert[v] == c_Unassigned)
+                            {
+                                localVert[v] = uint32_t(verts.size());
+                                verts.push_back(uint32_t(v));
+                            }
+                            localIndices[j * 3 + k] = index_t(localVert[v]);
+                        }
+                        else
+                        {
+                            // Out of range indices pass through for UVAtlasPartition to reject
+                            localIndices[j * 3 + k] = v;
+                        }
+
+                        localAdj[j * 3 + k] = toLocalFace(adjacency[face * 3 + k]);
+
+                        if (falseEdgeAdjacency)
+                            localFalseEdges[j * 3 + k] = toLocalFace(falseEdgeAdjacency[face * 3 + k]);
+
+                        if (pIMTArray)
+                            localIMT[j * 3 + k] = pIMTArray[face * 3 + k];
+                    }
+                }
+
+                std::vector<XMFLOAT3> localPos(verts.size());
+                for (size_t j = 0; j < verts.size(); ++j)
+                {
+                    localPos[j] = positions[verts[j]];
+                    localVert[verts[j]] = c_Unassigned;
+                }
+
+                std::function<HRESULT __cdecl(float)> callback;
+                if (statusCallBack)
+                {
+                    const float start = float(doneFaces) / float(nFaces);
+                    const float share = float(nLocalFaces) / float(nFaces);
+                    callback = [&statusCallBack, start, share](float percentComplete) -> HRESULT
+                    {
+                        return statusCallBack(std::min((start + percentComplete * share) * UVATLAS_BOUNDED_PACK_PROGRESS, c_MaxPartitionProgress));
+                    };
+                }
+
+                const HRESULT hr = UVAtlasPartition(localPos.data(), localPos.size(),
+                    localIndices.data(), indexFormat, nLocalFaces,
+                    0, maxStretch,
+                    localAdj.data(),
+                    falseEdgeAdjacency ? localFalseEdges.data() : nullptr,
+                    pIMTArray ? localIMT.data() : nullptr,
+                    callback, callbackFrequency,
+                    options,
+                    groupVB, groupIB, &groupFacePartitioning, &groupVertexRemap, groupAdjacency,
+                    &groupStretch, &groupCharts);
+                if (FAILED(hr))
+                    return hr;
+            }
+
+            const size_t vbOffset = vb.size();
+            if (vbOffset + groupVB.size() >= maxIndex)
+                return c_ArithmeticOverflow;
+
+            auto groupIndices = reinterpret_cast<const index_t*>(groupIB.data());
+            for (size_t j = 0; j < nLocalFaces; ++j)
+            {
+                const size_t face = faces[j];
+                facePartitioning[face] = uint32_t(charts + groupFacePartitioning[j]);
+
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    const index_t local = groupIndices[j * 3 + k];
+                    outIndices[face * 3 + k] = (local == index_t(-1)) ? local : index_t(vbOffset + local);
+
+                    const uint32_t neighbor = groupAdjacency[j * 3 + k];
+                    partitionAdjacency[face * 3 + k] = (neighbor == uint32_t(-1)) ? neighbor : faces[neighbor];
+                }
+
+                localFace[face] = c_Done;
+            }
+
+            for (auto v : groupVertexRemap)
+                vertexRemap.push_back(verts[v]);
+
+            vb.insert(vb.end(), groupVB.cbegin(), groupVB.cend());
+
+            stretch = std::max(stretch, groupStretch);
+            charts += groupCharts;
+            doneFaces += nLocalFaces;
+            ++groups;
+        }
+
+        // Release the lookups so only the merged outputs are live while packing
+        std::vector<uint32_t>().swap(localFace);
+        std::vector<uint32_t>().swap(localVert);
+
+        std::function<HRESULT __cdecl(float)> packCallback;
+        if (statusCallBack)
+        {
+            HRESULT hr = statusCallBack(UVATLAS_BOUNDED_PACK_PROGRESS);
+            if (FAILED(hr))
+                return hr;
+
+            packCallback = [&statusCallBack](float percentComplete) -> HRESULT
+            {
+                return statusCallBack(UVATLAS_BOUNDED_PACK_PROGRESS + percentComplete * (1.f - UVATLAS_BOUNDED_PACK_PROGRESS));
+            };
+        }
+
+        const HRESULT hr = UVAtlasPack(vb, ib, indexFormat, width, height, gutter,
+            partitionAdjacency, packCallback, callbackFrequency);
+        if (FAILED(hr))
+            return hr;
+
+        vMeshOutVertexBuffer.swap(vb);
+        vMeshOutIndexBuffer.swap(ib);
+
+        if (pvFacePartitioning)
+            pvFacePartitioning->swap(facePartitioning);
+
+        if (pvVertexRemapArray)
+            pvVertexRemapArray->swap(vertexRemap);
+
+        if (maxStretchOut)
+            *maxStretchOut = stretch;
+
+        if (numChartsOut)
+            *numChartsOut = charts;
+
+        if (numGroupsOut)
+            *numGroupsOut = groups;
+
+        return S_OK;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT __cdecl UVAtlasCreateBounded(
+    const XMFLOAT3* positions, size_t nVerts,
+    const void* indices, DXGI_FORMAT indexFormat, size_t nFaces,
+    size_t maxChartNumber, float maxStretch,
+    size_t width, size_t height, float gutter,
+    const uint32_t* adjacency, const uint32_t* falseEdgeAdjacency, const float* pIMTArray,
+    std::function<HRESULT __cdecl(float percentComplete)> statusCallBack,
+    float callbackFrequency,
+    UVATLAS options,
+    size_t memoryBudget,
+    std::vector<UVAtlasVertex>& vMeshOutVertexBuffer,
+    std::vector<uint8_t>& vMeshOutIndexBuffer,
+    std::vector<uint32_t>* pvFacePartitioning,
+    std::vector<uint32_t>* pvVertexRemapArray,
+    float* maxStretchOut,
+    size_t* numChartsOut,
+    size_t* numGroupsOut)
+{
+    const bool validFormat = (indexFormat == DXGI_FORMAT_R16_UINT || indexFormat == DXGI_FORMAT_R32_UINT);
+
+    // Invalid arguments get UVAtlasCreate's behavior, as do meshes that fit the budget whole
+    if (!memoryBudget || !validFormat || !positions || !indices || !adjacency
+        || !nFaces || !nVerts || nVerts >= UINT32_MAX || nFaces >= (UINT32_MAX / 3)
+        || nFaces <= memoryBudget / (c_PartitionBytesPerFace + c_OutputBytesPerFace))
+    {
+        return CreateWhole(positions, nVerts, indices, indexFormat, nFaces,
+            maxChartNumber, maxStretch, width, height, gutter,
+            adjacency, falseEdgeAdjacency, pIMTArray, statusCallBack, callbackFrequency,
+            options, vMeshOutVertexBuffer, vMeshOutIndexBuffer,
+            pvFacePartitioning, pvVertexRemapArray, maxStretchOut, numChartsOut, numGroupsOut);
+    }
+
+    // A chart limit can't be shared out between groups
+    if (maxChartNumber != 0)
+        return E_INVALIDARG;
+
+    // Held for the whole call: the outputs and the face and vertex lookups
+    const size_t fixedBytes = nFaces * (c_OutputBytesPerFace + sizeof(uint32_t)) + nVerts * sizeof(uint32_t);
+    if (fixedBytes + nFaces * c_PackBytesPerFace > memoryBudget)
+        return E_OUTOFMEMORY;
+
+    const size_t groupFaces = (memoryBudget - fixedBytes) / c_PartitionBytesPerFace;
+    if (groupFaces < c_MinGroupFaces)
+        return E_OUTOFMEMORY;
+
+    try
+    {
+        if (indexFormat == DXGI_FORMAT_R16_UINT)
+        {
+            return CreateBounded(positions, nVerts, static_cast<const uint16_t*>(indices), indexFormat, nFaces,
+                maxStretch, width, height, gutter, adjacency, falseEdgeAdjacency, pIMTArray,
+                statusCallBack, callbackFrequency, options, groupFaces,
+                vMeshOutVertexBuffer, vMeshOutIndexBuffer, pvFacePartitioning, pvVertexRemapArray,
+                maxStretchOut, numChartsOut, numGroupsOut);
+        }
+        else
+        {
+            return CreateBounded(positions, nVerts, static_cast<const uint32_t*>(indices), indexFormat, nFaces,
+                maxStretch, width, height, gutter, adjacency, falseEdgeAdjacency, pIMTArray,
+                statusCallBack, callbackFrequency, options, groupFaces,
+                vMeshOutVertexBuffer, vMeshOutIndexBuffer, pvFacePartitioning, pvVertexRemapArray,
+                maxStretchOut, numChartsOut, numGroupsOut);
+        }
+    }
+    catch (const std::bad_alloc&)
+    {
+        return E_OUTOFMEMORY;
+    }
+}
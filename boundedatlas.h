@@ -0,0 +1,69 @@
+//-------------------------------------------------------------------------------------
+// boundedatlas.h
+//
+// UVAtlasCreate under a memory budget, for meshes whose partition scratch would not fit
+// in memory at once (multi-million-face scans)
+//
+// Copyright (c) Microsoft Corporation.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "UVAtlas.h"
+
+// Progress below this is the partition phase. When the mesh is split, the call reports
+// exactly this value once the groups are merged, before the final UVAtlasPack, which the
+// budget doesn't cover.
+constexpr float UVATLAS_BOUNDED_PACK_PROGRESS = 0.8f;
+
+// Estimated peak heap use of UVAtlasPartition per face of a group, with the group's input
+// copies and outputs, which sizes the groups. Under-estimating breaks the budget while
+// over-estimating only costs extra groups, so it should err high. TRACK_ALLOCATIONS builds
+// of the bounded memory tests measure the real figure on the generated meshes, print it,
+// and fail if it is above this value; recalibrate from that output when the library
+// changes.
+constexpr size_t UVATLAS_BOUNDED_PARTITION_BYTES_PER_FACE = 2048;
+
+// Same contract as UVAtlasCreate, plus memoryBudget in bytes (0 for no limit) and the
+// optional number of groups the mesh was partitioned in.
+//
+// When the estimated peak of a whole-mesh UVAtlasCreate exceeds the budget, the mesh is
+// split into groups of faces grown over the adjacency, sized so one group's partition
+// scratch fits next to the outputs. Groups are partitioned one at a time and merged into
+// the outputs as they finish, then all charts are packed in one UVAtlasPack call. Edges
+// between groups always become chart seams, so the result has more charts than an
+// unbounded call and takes longer; meshes that fit go straight to UVAtlasCreate.
+//
+// The budget covers what the partition phase allocates, not the caller's inputs. Group
+// sizes come from fixed per-face estimates of UVAtlasPartition's peak rather than from
+// measuring it. The final UVAtlasPack runs over the whole merged mesh, and its scratch
+// belongs to the library, so the pack phase is outside the budget: the call only checks
+// that the outputs plus an estimate of the pack scratch fit. Fails with E_OUTOFMEMORY when
+// it can't hold the outputs plus a minimal group, and with E_INVALIDARG for a
+// maxChartNumber limit on a mesh that needs more than one group.
+HRESULT __cdecl UVAtlasCreateBounded(
+    _In_reads_(nVerts) const DirectX::XMFLOAT3* positions, size_t nVerts,
+    _When_(indexFormat == DXGI_FORMAT_R16_UINT, _In_reads_bytes_(nFaces * sizeof(uint16_t) * 3))
+    _When_(indexFormat != DXGI_FORMAT_R16_UINT, _In_reads_bytes_(nFaces * sizeof(uint32_t) * 3)) const void* indices,
+    DXGI_FORMAT indexFormat, size_t nFaces,
+    size_t maxChartNumber, float maxStretch,
+    size_t width, size_t height, float gutter,
+    _In_reads_(nFaces * 3) const uint32_t* adjacency,
+    _In_reads_opt_(nFaces * 3) const uint32_t* falseEdgeAdjacency,
+    _In_reads_opt_(nFaces * 3) const float* pIMTArray,
+    std::function<HRESULT __cdecl(float percentComplete)> statusCallBack,
+    float callbackFrequency,
+    DirectX::UVATLAS options,
+    size_t memoryBudget,
+    std::vector<DirectX::UVAtlasVertex>& vMeshOutVertexBuffer,
+    std::vector<uint8_t>& vMeshOutIndexBuffer,
+    _Out_opt_ std::vector<uint32_t>* pvFacePartitioning,
+    _Out_opt_ std::vector<uint32_t>* pvVertexRemapArray,
+    _Out_opt_ float* maxStretchOut,
+    _Out_opt_ size_t* numChartsOut,
+    _Out_opt_ size_t* numGroupsOut);
@@ -5,9 +5,28 @@
 //-------------------------------------------------------------------------------------
 
 #include "directxtest.h"
+#include "baseline.h"
 #include "ShapesGenerator.h"
 
+#ifdef _WIN32
 #include <objbase.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <clocale>
+#include <cmath>
+#include <cstdarg>
+#include <condition_variable>
+#include <cwchar>
+#include <cwctype>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
 
 #include "UVAtlas.h"
 
@@ -17,11 +36,13 @@ using namespace DirectX;
 // Types and globals
 
 typedef bool (*TestFN)();
+typedef void (*SubTestFN)(std::vector<SubTest>& tests);
 
 struct TestInfo
 {
     const char *name;
     TestFN func;
+    SubTestFN subtests;
 };
 
 extern bool Test01();
@@ -31,84 +52,1159 @@ extern bool Test04();
 extern bool Test05();
 extern bool Test06();
 extern bool Test07();
-extern bool Test08();
+extern void Test08(std::vector<SubTest>&);
 extern bool Test09();
 extern bool Test10();
 #ifndef BUILD_BVT_ONLY
-extern bool Test11();
+extern void Test11(std::vector<SubTest>&);
 #endif
+extern void Test12(std::vector<SubTest>&);
+extern bool Test13();
+extern bool Test14();
+extern bool Test15();
+extern void Test16(std::vector<SubTest>&);
+extern bool Test17();
+extern bool Test18();
+extern bool Test19();
+extern bool Test20();
+extern bool Test22();
+extern void Test23(std::vector<SubTest>&);
+extern void Test24(std::vector<SubTest>&);
+extern bool Test25();
 
 TestInfo g_Tests[] =
 {
-    { "UVAtlasCreate", Test01 },
-    { "UVAtlasPartition", Test02 },
-    { "UVAtlasPack", Test03 },
-    { "UVAtlasApplyRemap (no duplicates)", Test09 },
-    { "UVAtlasApplyRemap (with duplicates)", Test10 },
-    { "UVAtlasComputeIMTFromPerVertexSignal", Test04 },
-    { "UVAtlasComputeIMTFromSignal", Test05 },
-    { "UVAtlasComputeIMTFromTexture", Test06 },
-    { "UVAtlasComputeIMTFromPerTexelSignal", Test07 },
+    { "UVAtlasCreate", Test01, nullptr },
+    { "UVAtlasPartition", Test02, nullptr },
+    { "UVAtlasPartition (cache)", Test22, nullptr },
+    { "UVAtlasPack", Test03, nullptr },
+    { "UVAtlasPack (multiple)", Test17, nullptr },
+    { "UVAtlasPack (bitset)", Test19, nullptr },
+    { "UVAtlasCreate (parallel)", Test13, nullptr },
+    { "UVAtlasCreate (determinism)", Test14, nullptr },
+    { "UVAtlasCreate (cancellation)", Test15, nullptr },
+    { "UVAtlasCreate (typed indices)", Test25, nullptr },
+    { "UVAtlasComputeMetrics", Test20, nullptr },
+    { "UVAtlasApplyRemap (no duplicates)", Test09, nullptr },
+    { "UVAtlasApplyRemap (with duplicates)", Test10, nullptr },
+    { "UVAtlasComputeIMTFromPerVertexSignal", Test04, nullptr },
+    { "UVAtlasComputeIMTFromSignal", Test05, nullptr },
+    { "UVAtlasComputeIMTFromTexture", Test06, nullptr },
+    { "UVAtlasComputeIMTFromPerTexelSignal", Test07, nullptr },
 #ifndef _M_ARM64
-    { "MeshProcess(16)", Test08 },
+    { "MeshProcess(16)", nullptr, Test08 },
 #ifndef BUILD_BVT_ONLY
-    { "MeshProcess(32)", Test11 },
+    { "MeshProcess(32)", nullptr, Test11 },
 #endif
+    { "MeshProcess(generated)", nullptr, Test12 },
+    { "MeshProcess(progress)", nullptr, Test16 },
+    { "MeshProcess(shared atlas)", Test18, nullptr },
+    { "MeshProcess(bounded memory)", nullptr, Test23 },
+    { "MeshProcess(trusted input)", nullptr, Test24 },
 #endif
 };
 
 
 //-------------------------------------------------------------------------------------
-bool RunTests()
+// Output capture
+
+namespace
 {
-    size_t nPass = 0;
-    size_t nFail = 0;
+    thread_local std::string* t_testOutput = nullptr;
+    thread_local double t_excludedMS = 0;
+    thread_local int t_excludeDepth = 0;
+}
+
+void __cdecl TestPrint(const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
 
-    for(size_t i=0; i < ( sizeof(g_Tests) / sizeof(TestInfo) ); ++i)
+    if (t_testOutput)
     {
-        print("%s: ", g_Tests[i].name );
+        AllocationTrackingSuspend noTracking;
+
+        va_list args2;
+        va_copy(args2, args);
+        const int len = vsnprintf(nullptr, 0, format, args2);
+        va_end(args2);
 
-        if ( g_Tests[i].func() )
+        if (len > 0)
         {
-            ++nPass;
-            print("PASS\n");
+            const size_t offset = t_testOutput->size();
+            t_testOutput->resize(offset + size_t(len) + 1);
+            vsnprintf(&(*t_testOutput)[offset], size_t(len) + 1, format, args);
+            t_testOutput->resize(offset + size_t(len));
+        }
+    }
+    else
+    {
+        vprintf(format, args);
+    }
+
+    va_end(args);
+}
+
+
+//-------------------------------------------------------------------------------------
+// Settings from the command line read by the tests
+
+namespace
+{
+    // Set once while parsing the command line, before any test runs
+    uint32_t s_cancelBudgetMS = 2000;
+    bool s_largeTests = false;
+    bool s_trustedInput = false;
+}
+
+uint32_t GetCancelLatencyBudgetMS() noexcept
+{
+    return s_cancelBudgetMS;
+}
+
+bool AreLargeTestsEnabled() noexcept
+{
+    return s_largeTests;
+}
+
+bool IsTrustedInputEnabled() noexcept
+{
+    return s_trustedInput;
+}
+
+
+//-------------------------------------------------------------------------------------
+// Benchmark exclusion regions
+
+BenchExcludeScope::BenchExcludeScope() noexcept :
+    m_start(0)
+{
+    if (t_excludeDepth++ == 0)
+    {
+        m_start = std::chrono::steady_clock::now().time_since_epoch().count();
+    }
+}
+
+BenchExcludeScope::~BenchExcludeScope()
+{
+    if (--t_excludeDepth == 0)
+    {
+        const std::chrono::steady_clock::duration elapsed(std::chrono::steady_clock::now().time_since_epoch().count() - m_start);
+        t_excludedMS += std::chrono::duration<double, std::milli>(elapsed).count();
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+// Work-stealing scheduler for the parallel runner. Each worker drains its own queue
+// from the front and steals from the back of the other workers' queues when empty.
+
+namespace
+{
+    class WorkStealingPool
+    {
+    public:
+        explicit WorkStealingPool(size_t workerCount) :
+            m_queues(workerCount)
+        {
+        }
+
+        void Push(size_t worker, size_t task)
+        {
+            auto& q = m_queues[worker % m_queues.size()];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            q.tasks.push_back(task);
+        }
+
+        template<typename Fn>
+        void Run(Fn fn)
+        {
+            std::vector<std::thread> threads;
+            threads.reserve(m_queues.size());
+
+            for (size_t worker = 0; worker < m_queues.size(); ++worker)
+            {
+                threads.emplace_back([this, worker, &fn]()
+                    {
+                        size_t task = 0;
+                        while (Pop(worker, task) || Steal(worker, task))
+                        {
+                            fn(task);
+                        }
+                    });
+            }
+
+            for (auto& t : threads)
+            {
+                t.join();
+            }
+        }
+
+    private:
+        struct WorkQueue
+        {
+            std::mutex mutex;
+            std::deque<size_t> tasks;
+        };
+
+        std::vector<WorkQueue> m_queues;
+
+        bool Pop(size_t worker, size_t& task)
+        {
+            auto& q = m_queues[worker];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (q.tasks.empty())
+                return false;
+
+            task = q.tasks.front();
+            q.tasks.pop_front();
+            return true;
+        }
+
+        bool Steal(size_t thief, size_t& task)
+        {
+            for (size_t j = 1; j < m_queues.size(); ++j)
+            {
+                auto& q = m_queues[(thief + j) % m_queues.size()];
+                std::lock_guard<std::mutex> lock(q.mutex);
+                if (!q.tasks.empty())
+                {
+                    task = q.tasks.back();
+                    q.tasks.pop_back();
+                    return true;
+                }
+            }
+
+            return false;
+        }
+    };
+
+    struct TestMetrics
+    {
+        double wallMS;
+        double userMS;          // whole process when tests run serially, else the test's thread only
+        double systemMS;
+        double setupMS;         // time inside BenchExcludeScope regions
+        int64_t peakRSSDelta;   // bytes; process-wide, so overlapping tests in parallel mode share it
+        AllocationStats allocs; // only populated when IsAllocationTrackingEnabled()
+        PerfCounterStats counters; // only populated when IsPerfCountersEnabled()
+        bool processCPU;        // userMS/systemMS include threads the test spawned
+
+        TestMetrics() : wallMS(0), userMS(0), systemMS(0), setupMS(0), peakRSSDelta(0), allocs{}, counters{}, processCPU(false) {}
+    };
+
+    struct BenchStats
+    {
+        size_t iterations;
+        double minMS;
+        double medianMS;
+        double p95MS;
+        double maxMS;
+        double cv;
+
+        BenchStats() : iterations(0), minMS(0), medianMS(0), p95MS(0), maxMS(0), cv(0) {}
+    };
+
+    struct TestResult
+    {
+        const SubTest* test;
+        std::string output;
+        TestMetrics metrics;
+        BenchStats bench;
+        bool pass;
+        bool done;
+
+        TestResult() : test(nullptr), pass(false), done(false) {}
+    };
+
+    struct TestOptions
+    {
+        size_t threads;
+        size_t benchIterations;
+        size_t benchWarmup;
+        double tolerance;
+        std::wstring reportFile;
+        std::wstring baselineFile;
+        std::wstring writeBaselineFile;
+        std::vector<std::string> filters;
+        size_t shardIndex;
+        size_t shardCount;
+        bool listOnly;
+        bool counters;
+        std::wstring traceFile;
+
+        TestOptions() : threads(1), benchIterations(0), benchWarmup(1), tolerance(0.25), shardIndex(0), shardCount(1), listOnly(false), counters(false) {}
+    };
+
+    // With processCPU the CPU time covers every thread in the process, which is only the
+    // test's own work when no other test runs alongside it
+    bool RunOneTest(const SubTest& test, TestMetrics& metrics, bool processCPU)
+    {
+        auto getCPUTime = processCPU ? GetProcessCPUTime : GetThreadCPUTime;
+
+        double userStart, systemStart;
+        getCPUTime(userStart, systemStart);
+        const int64_t peakStart = GetPeakRSS();
+        t_excludedMS = 0;
+        const auto wallStart = std::chrono::steady_clock::now();
+
+        AllocationScope allocScope;
+        PerfCounterScope counterScope;
+
+        bool pass = false;
+        try
+        {
+            TraceSpan span(test.name.c_str());
+            pass = test.func();
+        }
+        catch (const std::exception& e)
+        {
+            printe("\nERROR: unhandled exception: %s\n", e.what());
+        }
+        catch (...)
+        {
+            printe("\nERROR: unhandled exception\n");
+        }
+
+        metrics.counters = counterScope.GetStats();
+
+        const auto wallEnd = std::chrono::steady_clock::now();
+        double userEnd, systemEnd;
+        getCPUTime(userEnd, systemEnd);
+
+        metrics.wallMS = std::chrono::duration<double, std::milli>(wallEnd - wallStart).count();
+        metrics.userMS = userEnd - userStart;
+        metrics.systemMS = systemEnd - systemStart;
+        metrics.processCPU = processCPU;
+        metrics.setupMS = t_excludedMS;
+        metrics.allocs = allocScope.GetStats();
+        metrics.peakRSSDelta = GetPeakRSS() - peakStart;
+
+        return pass;
+    }
+
+    void PrintResult(bool pass, const TestMetrics& metrics)
+    {
+        print("%s (%.1f ms wall, %.1f ms %suser, %.1f ms %ssys, %+.1f MB peak RSS",
+            pass ? "PASS" : "FAIL",
+            metrics.wallMS, metrics.userMS, metrics.processCPU ? "" : "thread ",
+            metrics.systemMS, metrics.processCPU ? "" : "thread ",
+            double(metrics.peakRSSDelta) / (1024.0 * 1024.0));
+
+        if (IsAllocationTrackingEnabled())
+        {
+            print(", %llu allocs, %.1f MB allocated, %.1f MB peak live",
+                static_cast<unsigned long long>(metrics.allocs.allocations),
+                double(metrics.allocs.bytes) / (1024.0 * 1024.0),
+                double(metrics.allocs.peakLiveBytes) / (1024.0 * 1024.0));
+        }
+
+        if (metrics.counters.valid)
+        {
+            const auto& c = metrics.counters;
+            print(", %.1f M cycles, IPC %.2f, %.1f K cache misses, %.1f K branch misses",
+                double(c.cycles) / 1.0e6,
+                c.cycles ? double(c.instructions) / double(c.cycles) : 0.0,
+                double(c.cacheMisses) / 1.0e3,
+                double(c.branchMisses) / 1.0e3);
+        }
+
+        print(")\n");
+    }
+
+    BenchStats ComputeBenchStats(std::vector<double>& samples)
+    {
+        BenchStats stats;
+        stats.iterations = samples.size();
+        if (samples.empty())
+            return stats;
+
+        std::sort(samples.begin(), samples.end());
+
+        const size_t n = samples.size();
+        stats.minMS = samples.front();
+        stats.maxMS = samples.back();
+        stats.medianMS = (n & 1) ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) * 0.5;
+
+        // Nearest-rank percentile
+        const size_t rank95 = (n * 95 + 99) / 100;
+        stats.p95MS = samples[std::max<size_t>(rank95, 1) - 1];
+
+        double mean = 0;
+        for (auto it : samples)
+            mean += it;
+        mean /= double(n);
+
+        if (n > 1 && mean > 0)
+        {
+            double variance = 0;
+            for (auto it : samples)
+                variance += (it - mean) * (it - mean);
+            variance /= double(n - 1);
+
+            stats.cv = std::sqrt(variance) / mean;
+        }
+
+        return stats;
+    }
+
+    void PrintBenchResult(bool pass, const BenchStats& stats)
+    {
+        print("%s (%zu iterations: min %.2f, median %.2f, p95 %.2f, max %.2f ms, cv %.1f%%)\n",
+            pass ? "PASS" : "FAIL",
+            stats.iterations, stats.minMS, stats.medianMS, stats.p95MS, stats.maxMS, stats.cv * 100.0);
+    }
+
+    std::string EscapeJSON(const char* str)
+    {
+        std::string result;
+        for (const char* ptr = str; *ptr; ++ptr)
+        {
+            switch (*ptr)
+            {
+            case '"':  result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            default:   result += *ptr; break;
+            }
+        }
+        return result;
+    }
+
+    // Writes a JSON summary, or CSV if the file name ends in .csv
+    bool WriteReport(const std::wstring& fileName, const std::vector<TestResult>& results, size_t threads)
+    {
+        FILE* fp = OpenFile(fileName.c_str(), "wt");
+        if (!fp)
+        {
+            printe("ERROR: Failed to open report file %ls\n", fileName.c_str());
+            return false;
+        }
+
+        const size_t len = fileName.size();
+        const bool csv = (len > 4) && (CompareNoCase(fileName.c_str() + len - 4, L".csv") == 0);
+
+        if (csv)
+        {
+            fprintf(fp, "name,pass,wall_ms,user_ms,system_ms,setup_ms,peak_rss_delta_kb,allocations,allocated_bytes,peak_live_bytes,cycles,instructions,cache_misses,branch_misses,bench_iterations,bench_min_ms,bench_median_ms,bench_p95_ms,bench_max_ms,bench_cv,cpu_scope\n");
+            for (size_t i = 0; i < results.size(); ++i)
+            {
+                const auto& m = results[i].metrics;
+                const auto& b = results[i].bench;
+                fprintf(fp, "\"%s\",%d,%.3f,%.3f,%.3f,%.3f,%lld,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%zu,%.3f,%.3f,%.3f,%.3f,%.4f,%s\n",
+                    results[i].test->name.c_str(), results[i].pass ? 1 : 0,
+                    m.wallMS, m.userMS, m.systemMS, m.setupMS, static_cast<long long>(m.peakRSSDelta / 1024),
+                    static_cast<unsigned long long>(m.allocs.allocations),
+                    static_cast<unsigned long long>(m.allocs.bytes),
+                    static_cast<unsigned long long>(m.allocs.peakLiveBytes),
+                    static_cast<unsigned long long>(m.counters.cycles),
+                    static_cast<unsigned long long>(m.counters.instructions),
+                    static_cast<unsigned long long>(m.counters.cacheMisses),
+                    static_cast<unsigned long long>(m.counters.branchMisses),
+                    b.iterations, b.minMS, b.medianMS, b.p95MS, b.maxMS, b.cv,
+                    m.processCPU ? "process" : "thread");
+            }
         }
         else
         {
-            ++nFail;
-            print("FAIL\n");
+            fprintf(fp, "{\n  \"suite\": \"%s\",\n  \"version\": %d,\n  \"threads\": %zu,\n  \"tests\": [\n",
+                _DIRECTX_TEST_NAME_, UVATLAS_VERSION, threads);
+            for (size_t i = 0; i < results.size(); ++i)
+            {
+                const auto& m = results[i].metrics;
+                fprintf(fp, "    {\n      \"name\": \"%s\",\n      \"pass\": %s,\n",
+                    EscapeJSON(results[i].test->name.c_str()).c_str(), results[i].pass ? "true" : "false");
+                fprintf(fp, "      \"wall_ms\": %.3f,\n      \"user_ms\": %.3f,\n      \"system_ms\": %.3f,\n      \"cpu_scope\": \"%s\",\n      \"setup_ms\": %.3f,\n      \"peak_rss_delta_kb\": %lld",
+                    m.wallMS, m.userMS, m.systemMS, m.processCPU ? "process" : "thread", m.setupMS, static_cast<long long>(m.peakRSSDelta / 1024));
+
+                if (IsAllocationTrackingEnabled())
+                {
+                    fprintf(fp, ",\n      \"allocations\": %llu,\n      \"allocated_bytes\": %llu,\n      \"peak_live_bytes\": %llu",
+                        static_cast<unsigned long long>(m.allocs.allocations),
+                        static_cast<unsigned long long>(m.allocs.bytes),
+                        static_cast<unsigned long long>(m.allocs.peakLiveBytes));
+                }
+
+                if (m.counters.valid)
+                {
+                    fprintf(fp, ",\n      \"counters\": { \"cycles\": %llu, \"instructions\": %llu, \"cache_misses\": %llu, \"branch_misses\": %llu }",
+                        static_cast<unsigned long long>(m.counters.cycles),
+                        static_cast<unsigned long long>(m.counters.instructions),
+                        static_cast<unsigned long long>(m.counters.cacheMisses),
+                        static_cast<unsigned long long>(m.counters.branchMisses));
+                }
+
+                const auto& b = results[i].bench;
+                if (b.iterations > 0)
+                {
+                    fprintf(fp, ",\n      \"bench\": { \"iterations\": %zu, \"min_ms\": %.3f, \"median_ms\": %.3f, \"p95_ms\": %.3f, \"max_ms\": %.3f, \"cv\": %.4f }",
+                        b.iterations, b.minMS, b.medianMS, b.p95MS, b.maxMS, b.cv);
+                }
+
+                fprintf(fp, "\n    }%s\n", (i + 1 < results.size()) ? "," : "");
+            }
+            fprintf(fp, "  ]\n}\n");
+        }
+
+        fclose(fp);
+        return true;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+static void RunTestsParallel(size_t threadCount, std::vector<TestResult>& results)
+{
+    const size_t nTests = results.size();
+
+    std::mutex resultMutex;
+    std::condition_variable resultReady;
+
+    WorkStealingPool pool(threadCount);
+    for (size_t i = 0; i < nTests; ++i)
+    {
+        pool.Push(i, i);
+    }
+
+    std::thread scheduler([&]()
+        {
+            pool.Run([&](size_t index)
+                {
+#ifdef _WIN32
+                    HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+#endif
+
+                    std::string output;
+                    t_testOutput = &output;
+
+                    TestMetrics metrics;
+                    const bool pass = RunOneTest(*results[index].test, metrics, false);
+
+                    t_testOutput = nullptr;
+
+#ifdef _WIN32
+                    if (SUCCEEDED(hr))
+                        CoUninitialize();
+#endif
+
+                    std::lock_guard<std::mutex> lock(resultMutex);
+                    results[index].output = std::move(output);
+                    results[index].metrics = metrics;
+                    results[index].pass = pass;
+                    results[index].done = true;
+                    resultReady.notify_all();
+                });
+        });
+
+    // Report in table order as soon as each test (and all before it) has finished
+    for (size_t i = 0; i < nTests; ++i)
+    {
+        std::string output;
+        {
+            std::unique_lock<std::mutex> lock(resultMutex);
+            resultReady.wait(lock, [&]() { return results[i].done; });
+            std::swap(output, results[i].output);
+        }
+
+        print("%s: ", results[i].test->name.c_str());
+        fputs(output.c_str(), stdout);
+        PrintResult(results[i].pass, results[i].metrics);
+        fflush(stdout);
+    }
+
+    scheduler.join();
+}
+
+
+//-------------------------------------------------------------------------------------
+static void RunTestsSerial(std::vector<TestResult>& results)
+{
+    for(size_t i=0; i < results.size(); ++i)
+    {
+        print("%s: ", results[i].test->name.c_str() );
+
+        results[i].pass = RunOneTest( *results[i].test, results[i].metrics, true );
+        results[i].done = true;
+
+        PrintResult( results[i].pass, results[i].metrics );
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+// Benchmark mode runs each test serially: warm-up passes first, then the timed passes.
+// Test output is discarded after the first run, and time spent in BenchExcludeScope
+// regions (media loading) is subtracted from every sample.
+static void RunTestsBenchmark(size_t iterations, size_t warmup, std::vector<TestResult>& results)
+{
+    std::vector<double> samples;
+    samples.reserve(iterations);
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        auto& result = results[i];
+
+        print("%s: ", results[i].test->name.c_str());
+
+        std::string output;
+        t_testOutput = &output;
+
+        result.pass = RunOneTest(*result.test, result.metrics, true);
+
+        for (size_t j = 1; result.pass && j < warmup; ++j)
+        {
+            TestMetrics metrics;
+            result.pass = RunOneTest(*result.test, metrics, true);
+        }
+
+        samples.clear();
+        if (result.pass && !warmup)
+        {
+            samples.push_back(result.metrics.wallMS - result.metrics.setupMS);
+        }
+
+        while (result.pass && samples.size() < iterations)
+        {
+            TestMetrics metrics;
+            result.pass = RunOneTest(*result.test, metrics, true);
+            samples.push_back(metrics.wallMS - metrics.setupMS);
         }
+
+        t_testOutput = nullptr;
+        result.done = true;
+
+        if (result.pass)
+        {
+            result.bench = ComputeBenchStats(samples);
+            PrintBenchResult(true, result.bench);
+        }
+        else
+        {
+            // Only show output when something went wrong
+            fputs(output.c_str(), stdout);
+            PrintResult(false, result.metrics);
+        }
+
+        fflush(stdout);
     }
+}
+
 
-    print("Ran %zu tests, %zu pass, %zu fail\n", nPass+nFail, nPass, nFail);
+//-------------------------------------------------------------------------------------
+// Timing used for baselines: the benchmark median when available, otherwise the
+// single-run wall time without setup.
+static double GetBaselineTime(const TestResult& result)
+{
+    if (result.bench.iterations > 0)
+        return result.bench.medianMS;
+
+    return result.metrics.wallMS - result.metrics.setupMS;
+}
+
+
+//-------------------------------------------------------------------------------------
+static bool CompareBaseline(const TestOptions& options, const std::vector<TestResult>& results)
+{
+    Baseline baseline;
+    HRESULT hr = LoadBaseline(options.baselineFile.c_str(), baseline);
+    if (FAILED(hr))
+    {
+        printe("ERROR: Failed to load baseline %ls (%08X)\n", options.baselineFile.c_str(), static_cast<unsigned int>(hr));
+        return false;
+    }
+
+    if (baseline.empty())
+    {
+        print("WARNING: Baseline %ls has no entries, so no test is gated; record one with --write-baseline on the reference machine\n",
+            options.baselineFile.c_str());
+        return true;
+    }
+
+    // Ignore regressions smaller than this to keep very short tests from flapping
+    constexpr double c_minRegressionMS = 1.0;
+
+    // A test without an entry can't be gated; it is listed so the gap is visible, but only
+    // regressions fail the run
+    size_t nRegressed = 0;
+    size_t nMissing = 0;
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        if (!results[i].done || !results[i].pass)
+            continue;
+
+        auto it = baseline.find(results[i].test->name);
+        if (it == baseline.end())
+        {
+            print("WARNING: No baseline for %s, not gated\n", results[i].test->name.c_str());
+            ++nMissing;
+            continue;
+        }
+
+        const double current = GetBaselineTime(results[i]);
+        const double limit = it->second.medianMS * (1.0 + options.tolerance);
+        if (current > limit && (current - it->second.medianMS) > c_minRegressionMS)
+        {
+            printe("ERROR: Performance regression in %s: %.2f ms vs. baseline %.2f ms (+%.0f%%, tolerance %.0f%%)\n",
+                results[i].test->name.c_str(), current, it->second.medianMS,
+                (current / it->second.medianMS - 1.0) * 100.0, options.tolerance * 100.0);
+            ++nRegressed;
+        }
+
+        if (IsAllocationTrackingEnabled() && it->second.hasAllocations)
+        {
+            const uint64_t allocs = results[i].metrics.allocs.allocations;
+            if (double(allocs) > double(it->second.allocations) * (1.0 + options.tolerance))
+            {
+                printe("ERROR: Allocation regression in %s: %llu allocations vs. baseline %llu (tolerance %.0f%%)\n",
+                    results[i].test->name.c_str(),
+                    static_cast<unsigned long long>(allocs), static_cast<unsigned long long>(it->second.allocations),
+                    options.tolerance * 100.0);
+                ++nRegressed;
+            }
+        }
+    }
+
+    print("Compared against baseline %ls: %zu regressions, %zu tests without a baseline\n",
+        options.baselineFile.c_str(), nRegressed, nMissing);
+
+    return (nRegressed == 0);
+}
+
+
+//-------------------------------------------------------------------------------------
+static bool WriteBaseline(const TestOptions& options, const std::vector<TestResult>& results)
+{
+    // Merge into any existing file so a filtered run only updates the tests it ran
+    Baseline baseline;
+    std::string description;
+    std::ignore = LoadBaseline(options.writeBaselineFile.c_str(), baseline, &description);
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        if (!results[i].done || !results[i].pass)
+            continue;
+
+        auto& entry = baseline[results[i].test->name];
+        entry.medianMS = GetBaselineTime(results[i]);
+
+        if (IsAllocationTrackingEnabled())
+        {
+            entry.allocations = results[i].metrics.allocs.allocations;
+            entry.hasAllocations = true;
+        }
+    }
+
+    HRESULT hr = SaveBaseline(options.writeBaselineFile.c_str(), baseline, description.c_str());
+    if (FAILED(hr))
+    {
+        printe("ERROR: Failed to write baseline %ls (%08X)\n", options.writeBaselineFile.c_str(), static_cast<unsigned int>(hr));
+        return false;
+    }
+
+    return true;
+}
+
+
+//-------------------------------------------------------------------------------------
+// Glob match supporting '*' and '?'
+static bool MatchGlob(const char* pattern, const char* str)
+{
+    const char* starPattern = nullptr;
+    const char* starStr = nullptr;
+
+    while (*str)
+    {
+        if (*pattern == '*')
+        {
+            starPattern = ++pattern;
+            starStr = str;
+        }
+        else if (*pattern == '?' || *pattern == *str)
+        {
+            ++pattern;
+            ++str;
+        }
+        else if (starPattern)
+        {
+            pattern = starPattern;
+            str = ++starStr;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    while (*pattern == '*')
+        ++pattern;
+
+    return (*pattern == 0);
+}
+
+
+//-------------------------------------------------------------------------------------
+// Expands the test table into the list of tests for this run: sub-tests are named
+// "<table name> <sub-test name>", then filters are applied, then the shard is taken.
+static std::vector<SubTest> EnumerateTests(const TestOptions& options)
+{
+    std::vector<SubTest> all;
+    for (const auto& it : g_Tests)
+    {
+        if (it.subtests)
+        {
+            std::vector<SubTest> subtests;
+            it.subtests(subtests);
+            for (auto& sub : subtests)
+            {
+                all.emplace_back(std::string(it.name) + " " + sub.name, std::move(sub.func));
+            }
+        }
+        else
+        {
+            all.emplace_back(it.name, it.func);
+        }
+    }
+
+    std::vector<SubTest> selected;
+    size_t nMatched = 0;
+    for (auto& it : all)
+    {
+        if (!options.filters.empty())
+        {
+            bool match = false;
+            for (const auto& filter : options.filters)
+            {
+                if (MatchGlob(filter.c_str(), it.name.c_str()))
+                {
+                    match = true;
+                    break;
+                }
+            }
+
+            if (!match)
+                continue;
+        }
+
+        if ((nMatched++ % options.shardCount) == options.shardIndex)
+        {
+            selected.emplace_back(std::move(it));
+        }
+    }
+
+    return selected;
+}
+
+
+//-------------------------------------------------------------------------------------
+static bool RunTests(const TestOptions& options)
+{
+    const std::vector<SubTest> tests = EnumerateTests( options );
+
+    if ( options.listOnly )
+    {
+        for( const auto& it : tests )
+        {
+            print("%s\n", it.name.c_str());
+        }
+        return true;
+    }
+
+    if ( tests.empty() )
+    {
+        if ( options.shardCount > 1 && options.filters.empty() )
+        {
+            // More shards than tests is not an error
+            print("Shard %zu of %zu: no tests\n", options.shardIndex, options.shardCount);
+            return true;
+        }
+
+        printe("ERROR: No tests match the filter/shard selection\n");
+        return false;
+    }
+
+    if ( options.shardCount > 1 )
+    {
+        print("Shard %zu of %zu: %zu tests\n", options.shardIndex, options.shardCount, tests.size());
+    }
+
+    std::vector<TestResult> results( tests.size() );
+    for( size_t i = 0; i < tests.size(); ++i )
+    {
+        results[i].test = &tests[i];
+    }
+
+    if ( options.benchIterations > 0 )
+    {
+        if ( options.threads > 1 )
+        {
+            print("INFO: --bench runs tests serially, ignoring -j\n");
+        }
+
+        RunTestsBenchmark( options.benchIterations, options.benchWarmup, results );
+    }
+    else if ( options.threads > 1 )
+    {
+        RunTestsParallel( options.threads, results );
+    }
+    else
+    {
+        RunTestsSerial( results );
+    }
+
+    size_t nPass = 0;
+    size_t nFail = 0;
+    double totalMS = 0;
+
+    for( const auto& it : results )
+    {
+        if ( it.pass )
+            ++nPass;
+        else
+            ++nFail;
+
+        totalMS += it.metrics.wallMS;
+    }
+
+    print("Ran %zu tests, %zu pass, %zu fail (%.1f ms total test time)\n", nPass+nFail, nPass, nFail, totalMS);
+
+    if ( !options.reportFile.empty() )
+    {
+        if ( !WriteReport( options.reportFile, results, options.threads ) )
+            return false;
+    }
+
+    if ( !options.writeBaselineFile.empty() )
+    {
+        if ( !WriteBaseline( options, results ) )
+            return false;
+    }
+
+    if ( !options.baselineFile.empty() )
+    {
+        if ( !CompareBaseline( options, results ) )
+            return false;
+    }
 
     return (nFail == 0);
 }
 
 
 //-------------------------------------------------------------------------------------
-int __cdecl wmain()
+static bool ParseCommandLine(int argc, wchar_t* argv[], TestOptions& options)
+{
+    for (int iArg = 1; iArg < argc; ++iArg)
+    {
+        const wchar_t* arg = argv[iArg];
+
+        if (!wcscmp(arg, L"-j") || !wcscmp(arg, L"--parallel"))
+        {
+            // Optional thread count; defaults to the number of hardware threads
+            size_t count = 0;
+            if ((iArg + 1 < argc) && iswdigit(argv[iArg + 1][0]))
+            {
+                count = wcstoul(argv[++iArg], nullptr, 10);
+            }
+
+            if (!count)
+            {
+                count = std::max<size_t>(1, std::thread::hardware_concurrency());
+            }
+
+            options.threads = count;
+        }
+        else if (!wcscmp(arg, L"--bench") && (iArg + 1 < argc))
+        {
+            options.benchIterations = wcstoul(argv[++iArg], nullptr, 10);
+            if (!options.benchIterations)
+            {
+                printe("ERROR: --bench requires a non-zero iteration count\n");
+                return false;
+            }
+        }
+        else if (!wcscmp(arg, L"--warmup") && (iArg + 1 < argc))
+        {
+            options.benchWarmup = wcstoul(argv[++iArg], nullptr, 10);
+        }
+        else if (!wcscmp(arg, L"--filter") && (iArg + 1 < argc))
+        {
+            std::string filter;
+            for (const wchar_t* ptr = argv[++iArg]; *ptr; ++ptr)
+            {
+                filter += static_cast<char>(*ptr);
+            }
+            options.filters.emplace_back(std::move(filter));
+        }
+        else if (!wcscmp(arg, L"--shard") && (iArg + 1 < argc))
+        {
+            // i/n with 0 <= i < n
+            wchar_t* end = nullptr;
+            const unsigned long index = wcstoul(argv[++iArg], &end, 10);
+            const unsigned long count = (end && *end == L'/') ? wcstoul(end + 1, nullptr, 10) : 0;
+            if (!count || index >= count)
+            {
+                printe("ERROR: --shard expects <index>/<count> with index < count\n");
+                return false;
+            }
+
+            options.shardIndex = index;
+            options.shardCount = count;
+        }
+        else if (!wcscmp(arg, L"--list"))
+        {
+            options.listOnly = true;
+        }
+        else if (!wcscmp(arg, L"--counters"))
+        {
+            options.counters = true;
+        }
+        else if (!wcscmp(arg, L"--large"))
+        {
+            s_largeTests = true;
+        }
+        else if (!wcscmp(arg, L"--trusted-input"))
+        {
+            s_trustedInput = true;
+        }
+        else if (!wcscmp(arg, L"--trace") && (iArg + 1 < argc))
+        {
+            options.traceFile = argv[++iArg];
+        }
+        else if (!wcscmp(arg, L"--cancel-budget") && (iArg + 1 < argc))
+        {
+            const unsigned long value = wcstoul(argv[++iArg], nullptr, 10);
+            if (!value)
+            {
+                printe("ERROR: --cancel-budget expects a latency in milliseconds\n");
+                return false;
+            }
+
+            s_cancelBudgetMS = static_cast<uint32_t>(std::min<unsigned long>(value, UINT32_MAX));
+        }
+        else if (!wcscmp(arg, L"--report") && (iArg + 1 < argc))
+        {
+            options.reportFile = argv[++iArg];
+        }
+        else if (!wcscmp(arg, L"--baseline") && (iArg + 1 < argc))
+        {
+            options.baselineFile = argv[++iArg];
+        }
+        else if (!wcscmp(arg, L"--write-baseline") && (iArg + 1 < argc))
+        {
+            options.writeBaselineFile = argv[++iArg];
+        }
+        else if (!wcscmp(arg, L"--tolerance") && (iArg + 1 < argc))
+        {
+            // Accepts a fraction (0.25) or a percentage (25%)
+            wchar_t* end = nullptr;
+            double value = wcstod(argv[++iArg], &end);
+            if (end && *end == L'%')
+            {
+                value /= 100.0;
+            }
+
+            if (value < 0)
+            {
+                printe("ERROR: --tolerance must be non-negative\n");
+                return false;
+            }
+
+            options.tolerance = value;
+        }
+        else
+        {
+            printe("ERROR: Unknown option '%ls'\n", arg);
+            printe("Usage: xtuvatlas [--list] [--filter <glob>]... [--shard <index>/<count>]\n"
+                   "                 [-j [threads]] [--bench <iterations> [--warmup <count>]] [--report <file.json|file.csv>]\n"
+                   "                 [--baseline <file.json> [--tolerance <fraction|percent%%>]] [--write-baseline <file.json>]\n"
+                   "                 [--counters] [--trace <file.json>] [--cancel-budget <ms>] [--large]\n"
+                   "                 [--trusted-input]\n"
+                   "With --trace, and in allocation-tracking builds, each MeshProcess case also repeats its\n"
+                   "atlas as separate UVAtlasPartition and UVAtlasPack calls, which roughly doubles those tests.\n");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+//-------------------------------------------------------------------------------------
+static int RunMain(int argc, wchar_t* argv[])
 {
     print("**************************************************************\n");
     print("*** " _DIRECTX_TEST_NAME_ " test\n" );
     print("*** Library Version %03d\n", UVATLAS_VERSION  );
     print("**************************************************************\n");
 
+    TestOptions options;
+    if ( !ParseCommandLine( argc, argv, options ) )
+        return -1;
+
     if ( !XMVerifyCPUSupport() )
     {
         printe("ERROR: XMVerifyCPUSupport fails on this system, not a supported platform\n");
         return -1;
     }
 
+#ifdef _WIN32
     HRESULT hr = CoInitializeEx( NULL, COINIT_MULTITHREADED );
     if ( FAILED(hr) )
     {
         printe("ERROR: CoInitializeEx fails (%08X)\n", static_cast<unsigned int>(hr));
         return -1;
     }
+#endif
 
-    if ( !RunTests() )
-        return -1;
+    if ( options.counters && !EnablePerfCounters() )
+    {
+        // Not fatal; counters are diagnostic only
+        print("WARNING: Hardware performance counters are not available (requires Linux perf_event_open and a permissive perf_event_paranoid)\n");
+    }
+
+    if ( !options.traceFile.empty() )
+    {
+        BeginTrace( options.traceFile.c_str() );
+    }
+
+    bool success = RunTests( options );
+
+    if ( !EndTrace() )
+        success = false;
+
+    return success ? 0 : -1;
+}
 
-    return 0;
+
+//-------------------------------------------------------------------------------------
+#ifdef _WIN32
+int __cdecl wmain(int argc, wchar_t* argv[])
+{
+    return RunMain(argc, argv);
 }
+#else
+int main(int argc, char* argv[])
+{
+    // Only the character set follows the environment; numbers in the JSON, CSV and
+    // baseline files always use '.'
+    setlocale(LC_CTYPE, "");
+
+    std::vector<std::wstring> args;
+    args.reserve(size_t(argc));
+    for (int i = 0; i < argc; ++i)
+    {
+        std::wstring arg(strlen(argv[i]) + 1, L'\0');
+        const size_t len = mbstowcs(&arg[0], argv[i], arg.size());
+        arg.resize((len == static_cast<size_t>(-1)) ? 0 : len);
+        args.emplace_back(std::move(arg));
+    }
+
+    std::vector<wchar_t*> wargv;
+    wargv.reserve(args.size() + 1);
+    for (auto& it : args)
+    {
+        wargv.push_back(&it[0]);
+    }
+    wargv.push_back(nullptr);
+
+    return RunMain(argc, wargv.data());
+}
+#endif
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#ifdef _WIN32
 #pragma warning(push)
 #pragma warning(disable : 4005)
 #define WIN32_LEAN_AND_MEAN
@@ -21,12 +22,49 @@
 #define _CRTDBG_MAP_ALLOC
 #endif
 #include <crtdbg.h>
+#endif
 
+#include <cstdint>
 #include <cstdlib>
 #include <cstdio>
+#include <cstring>
+#include <cwchar>
+#include <functional>
 #include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
 
+#ifdef _WIN32
 #include <Windows.h>
+#else
+#include <climits>
+#include <wsl/winadapter.h>
+
+#ifndef __cdecl
+#define __cdecl
+#endif
+
+#ifndef UNREFERENCED_PARAMETER
+#define UNREFERENCED_PARAMETER(P) (void)(P)
+#endif
+
+#ifndef MAX_PATH
+#define MAX_PATH PATH_MAX
+#endif
+
+#ifndef _MAX_EXT
+#define _MAX_EXT 256
+#endif
+#endif
+
+// The shared test data headers define constants in headers, which needs MSVC's selectany
+// or a weak symbol elsewhere
+#ifdef _WIN32
+#define SELECTANY __declspec(selectany)
+#else
+#define SELECTANY __attribute__((weak))
+#endif
 
 #define _XM_NO_XMVECTOR_OVERLOADS_
 #include <DirectXMath.h>
@@ -34,8 +72,181 @@
 
 #define _DIRECTX_TEST_NAME_ "UVAtlas"
 
-#define print printf
-#define printe printf
+// Test output is routed through TestPrint so the parallel runner can capture it per test
+void __cdecl TestPrint(_In_z_ _Printf_format_string_ const char* format, ...);
+
+#define print TestPrint
+#define printe TestPrint
+
+// Table entries can expand into sub-tests (e.g. one per media file) for filtering and sharding
+struct SubTest
+{
+    std::string name;
+    std::function<bool()> func;
+
+    SubTest(std::string n, std::function<bool()> f) : name(std::move(n)), func(std::move(f)) {}
+};
+
+// Time spent inside this scope (e.g. loading media) is excluded from --bench samples
+class BenchExcludeScope
+{
+public:
+    BenchExcludeScope() noexcept;
+    ~BenchExcludeScope();
+
+    BenchExcludeScope(const BenchExcludeScope&) = delete;
+    BenchExcludeScope& operator=(const BenchExcludeScope&) = delete;
+
+private:
+    long long m_start;
+};
+
+// Longest allowed time in milliseconds from a cancellation request (the status callback
+// starting to return a failure) to the atlas call returning (--cancel-budget)
+uint32_t GetCancelLatencyBudgetMS() noexcept;
+
+// Multi-million-face tests take minutes and gigabytes, so they are only enumerated with --large
+// (CTest runs them in their own process as uvatlas_large)
+bool AreLargeTestsEnabled() noexcept;
+
+// With --trusted-input, media that one test has loaded, validated and derived adjacency for
+// is trusted and reused by later tests in the run. Off by default: the shared meshes move
+// load and validation cost, allocations and injected failures between tests.
+bool IsTrustedInputEnabled() noexcept;
+
+// Heap allocation accounting. Counting only happens in builds with TRACK_ALLOCATIONS defined
+// (CMake option BUILD_ALLOC_TRACKING), which replaces the global operator new/delete.
+struct AllocationStats
+{
+    uint64_t allocations;
+    uint64_t bytes;
+    uint64_t peakLiveBytes;
+};
+
+bool IsAllocationTrackingEnabled() noexcept;
+
+// Measures operator new activity on the calling thread while the scope is active. Scopes nest.
+class AllocationScope
+{
+public:
+    AllocationScope() noexcept;
+    ~AllocationScope();
+
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+
+    AllocationStats GetStats() const noexcept;
+
+private:
+    uint64_t m_allocations;
+    uint64_t m_bytes;
+    int64_t m_startLive;
+    int64_t m_outerPeak;
+};
+
+// Allocations made while this scope is active are not counted (e.g. harness bookkeeping)
+class AllocationTrackingSuspend
+{
+public:
+    AllocationTrackingSuspend() noexcept;
+    ~AllocationTrackingSuspend();
+
+    AllocationTrackingSuspend(const AllocationTrackingSuspend&) = delete;
+    AllocationTrackingSuspend& operator=(const AllocationTrackingSuspend&) = delete;
+};
+
+// Hardware performance counters (perfcounters.cpp). Only available on Linux via
+// perf_event_open, and only after EnablePerfCounters() succeeds (--counters).
+struct PerfCounterStats
+{
+    uint64_t cycles;
+    uint64_t instructions;
+    uint64_t cacheMisses;
+    uint64_t branchMisses;
+    bool valid;
+};
+
+bool EnablePerfCounters() noexcept;
+bool IsPerfCountersEnabled() noexcept;
+
+// Counts events on the calling thread while the scope is active. Scopes do not nest.
+class PerfCounterScope
+{
+public:
+    PerfCounterScope() noexcept;
+    ~PerfCounterScope();
+
+    PerfCounterScope(const PerfCounterScope&) = delete;
+    PerfCounterScope& operator=(const PerfCounterScope&) = delete;
+
+    PerfCounterStats GetStats() const noexcept;
+
+private:
+    bool m_active;
+};
+
+// Chrome/Perfetto timeline tracing (trace.cpp). Events are buffered until EndTrace()
+// writes the file given to BeginTrace() (--trace). Tracing makes the MeshProcess cases
+// repeat each atlas as separate partition and pack calls to split the time between them.
+void BeginTrace(_In_z_ const wchar_t* fileName);
+bool EndTrace();
+bool IsTraceEnabled() noexcept;
+
+void TraceCounter(_In_z_ const char* name, double value);
+
+// Records a span from construction to destruction or End(); name must outlive the span
+class TraceSpan
+{
+public:
+    explicit TraceSpan(_In_z_ const char* name) noexcept;
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    // Closes the span early
+    void End() noexcept;
+
+private:
+    const char* m_name;
+    double m_start;
+};
+
+//-------------------------------------------------------------------------------------
+// Platform layer (platform.cpp)
+
+// Monotonic milliseconds from an arbitrary origin
+uint64_t GetTickMS() noexcept;
+
+// Expands %VAR% references and converts '\\' separators to the native form. Returns false
+// if the result does not fit in count characters.
+bool ExpandMediaPath(_In_z_ const wchar_t* fname, _Out_writes_(count) wchar_t* path, size_t count) noexcept;
+
+// Extension including the leading '.', or an empty string
+void GetFileExtension(_In_z_ const wchar_t* path, _Out_writes_(count) wchar_t* ext, size_t count) noexcept;
+
+int CompareNoCase(_In_z_ const wchar_t* a, _In_z_ const wchar_t* b) noexcept;
+
+FILE* OpenFile(_In_z_ const wchar_t* fileName, _In_z_ const char* mode) noexcept;
+
+// Renames source over destination, replacing it in one step if it exists
+bool MoveFileReplace(_In_z_ const wchar_t* source, _In_z_ const wchar_t* destination) noexcept;
+
+// Deletes a file or an empty directory
+bool RemovePath(_In_z_ const wchar_t* path) noexcept;
+
+// Creates a new, empty directory under the system temporary directory. The path has a
+// trailing separator.
+bool CreateTempDirectory(_Out_writes_(count) wchar_t* path, size_t count) noexcept;
+
+// CPU time consumed by the calling thread
+void GetThreadCPUTime(double& userMS, double& systemMS) noexcept;
+
+// CPU time consumed by all threads of the process
+void GetProcessCPUTime(double& userMS, double& systemMS) noexcept;
+
+// Process-wide peak resident set size in bytes
+int64_t GetPeakRSS() noexcept;
 
 #define printxmv(v) print("%s: %f,%f,%f,%f\n", #v, XMVectorGetX(v), XMVectorGetY(v), XMVectorGetZ(v), XMVectorGetW(v))
 
@@ -49,6 +260,7 @@
                                        digest[8], digest[9], digest[10], digest[11], digest[12], digest[13], digest[14], digest[15] );
 #endif
 
+// Media paths use %VAR% environment references and '\\' separators on all platforms; see ExpandMediaPath
 #define MESH_MEDIA_PATH L"%DIRECTXMESH_MEDIA_PATH%\\"
 
 #define TEX_MEDIA_PATH L"%DIRECTXTEX_MEDIA_PATH%\\"
@@ -52,9 +52,9 @@ static HRESULT __cdecl UVAtlasCallback( float fPercentDone  )
 {
     UNREFERENCED_PARAMETER(fPercentDone);
 
-    static ULONGLONG s_lastTick = 0;
+    static thread_local uint64_t s_lastTick = 0;
 
-    ULONGLONG tick = GetTickCount64();
+    uint64_t tick = GetTickMS();
 
     if ( ( tick - s_lastTick ) > 1000 )
     {
@@ -72,20 +72,21 @@ static HRESULT LoadTextureF32( const wchar_t* fname, std::unique_ptr<float[]>& t
     if ( !fname )
         return E_INVALIDARG;
 
+    BenchExcludeScope benchExclude;
+
     wchar_t szPath[MAX_PATH] = {};
-    DWORD ret = ExpandEnvironmentStringsW( fname, szPath, MAX_PATH );
-    if ( !ret || ret > MAX_PATH )
+    if ( !ExpandMediaPath( fname, szPath, MAX_PATH ) )
     {
-        printe( "ERROR: ExpandEnvironmentStrings FAILED\n" );
+        printe( "ERROR: ExpandMediaPath FAILED\n" );
         return E_FAIL;
     }
 
     wchar_t ext[_MAX_EXT];
-    _wsplitpath_s( szPath, nullptr, 0, nullptr, 0, nullptr, 0, ext, _MAX_EXT );
+    GetFileExtension( szPath, ext, _MAX_EXT );
 
     ScratchImage image;
     HRESULT hr = E_NOTIMPL;
-    if (_wcsicmp(ext, L".dds") == 0)
+    if (CompareNoCase(ext, L".dds") == 0)
     {
         TexMetadata metadata;
         hr = LoadFromDDSFile(szPath, DDS_FLAGS_NONE, &metadata, image);
@@ -106,14 +107,16 @@ static HRESULT LoadTextureF32( const wchar_t* fname, std::unique_ptr<float[]>& t
             std::swap(image, tmp);
         }
     }
-    else if (_wcsicmp(ext, L".tga") == 0)
+    else if (CompareNoCase(ext, L".tga") == 0)
     {
         hr = LoadFromTGAFile(szPath, nullptr, image);
     }
+#ifdef _WIN32
     else
     {
         hr = LoadFromWICFile(szPath, WIC_FLAGS_NONE, nullptr, image);
     }
+#endif
     if (FAILED(hr))
         return hr;
 
@@ -123,9 +126,14 @@ static HRESULT LoadTextureF32( const wchar_t* fname, std::unique_ptr<float[]>& t
     if ( !tex )
         return E_OUTOFMEMORY;
 
+    const size_t texBytes = img->width * img->height * sizeof(float) * 4;
+
     if ( img->format == DXGI_FORMAT_R32G32B32A32_FLOAT )
     {
-        memcpy_s( tex.get(), img->width * img->height * sizeof(float) * 4, img->pixels, img->slicePitch );
+        if ( img->slicePitch > texBytes )
+            return E_FAIL;
+
+        memcpy( tex.get(), img->pixels, img->slicePitch );
     }
     else
     {
@@ -136,7 +144,10 @@ static HRESULT LoadTextureF32( const wchar_t* fname, std::unique_ptr<float[]>& t
 
         auto img2 = image2.GetImage( 0, 0, 0 );
 
-        memcpy_s( tex.get(), img->width * img->height * sizeof(float) * 4, img2->pixels, img2->slicePitch );
+        if ( img2->slicePitch > texBytes )
+            return E_FAIL;
+
+        memcpy( tex.get(), img2->pixels, img2->slicePitch );
     }
 
     width = img->width;
@@ -0,0 +1,175 @@
+//-------------------------------------------------------------------------------------
+// memtrack.cpp
+//
+// Optional replacement of the global operator new/delete that counts heap activity
+// per thread. Memory obtained directly from malloc is not counted.
+//
+// Copyright (c) Microsoft Corporation.
+//-------------------------------------------------------------------------------------
+
+#include "directxtest.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#ifdef _MSC_VER
+#pragma warning(disable : 28251)
+// C28251 Inconsistent annotation for 'new'
+#endif
+
+namespace
+{
+    struct AllocationCounters
+    {
+        uint64_t allocations;
+        uint64_t bytes;
+        int64_t liveBytes;
+        int64_t peakLiveBytes;
+        int suspended;
+    };
+
+    thread_local AllocationCounters t_counters = {};
+}
+
+#ifdef TRACK_ALLOCATIONS
+
+namespace
+{
+    // Stored immediately in front of each returned block
+    struct AllocationHeader
+    {
+        void* raw;
+        size_t size;
+    };
+
+    void* TrackedAlloc(size_t size, size_t alignment) noexcept
+    {
+        if (!size)
+            size = 1;
+
+        alignment = std::max(alignment, alignof(std::max_align_t));
+
+        const size_t total = size + alignment + sizeof(AllocationHeader);
+        if (total < size)
+            return nullptr;
+
+        void* raw = malloc(total);
+        if (!raw)
+            return nullptr;
+
+        const uintptr_t ptr = (reinterpret_cast<uintptr_t>(raw) + sizeof(AllocationHeader) + alignment - 1) & ~(uintptr_t(alignment) - 1);
+
+        auto header = reinterpret_cast<AllocationHeader*>(ptr) - 1;
+        header->raw = raw;
+        header->size = size;
+
+        auto& counters = t_counters;
+        if (!counters.suspended)
+        {
+            ++counters.allocations;
+            counters.bytes += size;
+        }
+
+        counters.liveBytes += static_cast<int64_t>(size);
+        counters.peakLiveBytes = std::max(counters.peakLiveBytes, counters.liveBytes);
+
+        return reinterpret_cast<void*>(ptr);
+    }
+
+    void TrackedFree(void* ptr) noexcept
+    {
+        if (!ptr)
+            return;
+
+        auto header = reinterpret_cast<AllocationHeader*>(ptr) - 1;
+
+        // Blocks freed on another thread than the one that allocated them skew that thread's
+        // live count, which is acceptable for the single-threaded library calls being measured
+        t_counters.liveBytes -= static_cast<int64_t>(header->size);
+
+        free(header->raw);
+    }
+
+    void* TrackedAllocOrThrow(size_t size, size_t alignment)
+    {
+        void* ptr = TrackedAlloc(size, alignment);
+        if (!ptr)
+            throw std::bad_alloc();
+        return ptr;
+    }
+}
+
+void* operator new(size_t size) { return TrackedAllocOrThrow(size, 0); }
+void* operator new[](size_t size) { return TrackedAllocOrThrow(size, 0); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return TrackedAlloc(size, 0); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return TrackedAlloc(size, 0); }
+void* operator new(size_t size, std::align_val_t align) { return TrackedAllocOrThrow(size, static_cast<size_t>(align)); }
+void* operator new[](size_t size, std::align_val_t align) { return TrackedAllocOrThrow(size, static_cast<size_t>(align)); }
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept { return TrackedAlloc(size, static_cast<size_t>(align)); }
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept { return TrackedAlloc(size, static_cast<size_t>(align)); }
+
+void operator delete(void* ptr) noexcept { TrackedFree(ptr); }
+void operator delete[](void* ptr) noexcept { TrackedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { TrackedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { TrackedFree(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { TrackedFree(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { TrackedFree(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { TrackedFree(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { TrackedFree(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { TrackedFree(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { TrackedFree(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { TrackedFree(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { TrackedFree(ptr); }
+
+bool IsAllocationTrackingEnabled() noexcept { return true; }
+
+#else
+
+bool IsAllocationTrackingEnabled() noexcept { return false; }
+
+#endif // TRACK_ALLOCATIONS
+
+
+//-------------------------------------------------------------------------------------
+AllocationScope::AllocationScope() noexcept
+{
+    auto& counters = t_counters;
+    m_allocations = counters.allocations;
+    m_bytes = counters.bytes;
+    m_startLive = counters.liveBytes;
+    m_outerPeak = counters.peakLiveBytes;
+
+    // Restart peak tracking from the current live size for this scope
+    counters.peakLiveBytes = counters.liveBytes;
+}
+
+AllocationScope::~AllocationScope()
+{
+    auto& counters = t_counters;
+    counters.peakLiveBytes = std::max(counters.peakLiveBytes, m_outerPeak);
+}
+
+AllocationStats AllocationScope::GetStats() const noexcept
+{
+    const auto& counters = t_counters;
+
+    AllocationStats stats;
+    stats.allocations = counters.allocations - m_allocations;
+    stats.bytes = counters.bytes - m_bytes;
+    stats.peakLiveBytes = static_cast<uint64_t>(std::max<int64_t>(0, counters.peakLiveBytes - m_startLive));
+    return stats;
+}
+
+
+//-------------------------------------------------------------------------------------
+AllocationTrackingSuspend::AllocationTrackingSuspend() noexcept
+{
+    ++t_counters.suspended;
+}
+
+AllocationTrackingSuspend::~AllocationTrackingSuspend()
+{
+    --t_counters.suspended;
+}
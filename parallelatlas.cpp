@@ -0,0 +1,593 @@
+//-------------------------------------------------------------------------------------
+// parallelatlas.cpp
+//
+// Copyright (c) Microsoft Corporation.
+//-------------------------------------------------------------------------------------
+
+#include "directxtest.h"
+#include "parallelatlas.h"
+#include "unionfind.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
+using namespace DirectX;
+
+namespace
+{
+    const HRESULT c_ArithmeticOverflow = static_cast<HRESULT>(0x80070216L);
+
+    // Share of the reported progress given to the partition step; the rest is packing
+    const float c_PartitionWeight = 0.8f;
+
+    struct Component
+    {
+        std::vector<uint32_t> faces;    // local face -> input face
+        std::vector<uint32_t> verts;    // local vertex -> input vertex
+
+        std::vector<UVAtlasVertex> vb;
+        std::vector<uint8_t> ib;
+        std::vector<uint32_t> facePartitioning;
+        std::vector<uint32_t> vertexRemap;
+        std::vector<uint32_t> partitionAdjacency;
+        float maxStretch;
+        size_t numCharts;
+        HRESULT hr;
+
+        Component() : maxStretch(0.f), numCharts(0), hr(S_OK) {}
+    };
+
+    // Combines progress from concurrent library calls into one serialized callback. Parts
+    // fill [0, scale) in proportion to their weights; Final() covers the rest.
+    class ProgressAggregator
+    {
+    public:
+        ProgressAggregator(std::function<HRESULT __cdecl(float)> callback, std::vector<float> weights, float scale) :
+            m_callback(std::move(callback)),
+            m_done(weights.size(), 0.f),
+            m_weight(std::move(weights)),
+            m_scale(scale),
+            m_cancel(S_OK)
+        {
+        }
+
+        HRESULT Part(size_t part, float percentComplete)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            const HRESULT cancel = m_cancel.load(std::memory_order_relaxed);
+            if (FAILED(cancel))
+                return cancel;
+
+            m_done[part] = percentComplete;
+
+            float total = 0.f;
+            for (size_t j = 0; j < m_done.size(); ++j)
+            {
+                total += m_done[j] * m_weight[j];
+            }
+
+            return Report(total * m_scale);
+        }
+
+        HRESULT Final(float percentComplete)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return Report(m_scale + percentComplete * (1.f - m_scale));
+        }
+
+        // Polled by workers outside the lock
+        HRESULT GetCancel() const noexcept
+        {
+            return m_cancel.load(std::memory_order_acquire);
+        }
+
+    private:
+        HRESULT Report(float percentComplete)
+        {
+            if (!m_callback)
+                return S_OK;
+
+            const HRESULT hr = m_callback(percentComplete);
+            if (FAILED(hr))
+                m_cancel.store(hr, std::memory_order_release);
+            return hr;
+        }
+
+        std::function<HRESULT __cdecl(float)> m_callback;
+        std::mutex m_mutex;
+        std::vector<float> m_done;
+        std::vector<float> m_weight;
+        float m_scale;
+        std::atomic<HRESULT> m_cancel;
+    };
+
+    // Runs work(item) for every item on up to threadCount threads (including the caller),
+    // taking items in the given order and stopping early once progress is cancelled
+    template<typename Work>
+    void RunConcurrent(const std::vector<size_t>& order, size_t threadCount, const ProgressAggregator& progress, Work work)
+    {
+        std::atomic<size_t> next(0);
+        auto worker = [&]()
+        {
+            for (;;)
+            {
+                const size_t slot = next++;
+                if (slot >= order.size() || FAILED(progress.GetCancel()))
+                    break;
+
+                work(order[slot]);
+            }
+        };
+
+        threadCount = std::max<size_t>(1, std::min(threadCount, order.size()));
+
+        std::vector<std::thread> threads;
+        threads.reserve(threadCount - 1);
+        for (size_t j = 1; j < threadCount; ++j)
+            threads.emplace_back(worker);
+        worker();
+        for (auto& it : threads)
+            it.join();
+    }
+
+    // Faces marked unused (an index of -1) belong to no component and pass through
+    template<typename index_t>
+    bool IsUnusedFace(const index_t* indices, size_t face) noexcept
+    {
+        return indices[face * 3] == index_t(-1) || indices[face * 3 + 1] == index_t(-1) || indices[face * 3 + 2] == index_t(-1);
+    }
+
+    // Splits the mesh into face-connected components and builds their local vertex lists
+    template<typename index_t>
+    void SplitComponents(const index_t* indices, size_t nFaces, size_t nVerts, const uint32_t* adjacency, std::vector<Component>& components)
+    {
+        std::vector<uint32_t> parent(nFaces);
+        std::iota(parent.begin(), parent.end(), 0u);
+
+        for (size_t face = 0; face < nFaces; ++face)
+        {
+            if (IsUnusedFace(indices, face))
+                continue;
+
+            for (size_t edge = 0; edge < 3; ++edge)
+            {
+                const uint32_t neighbor = adjacency[face * 3 + edge];
+                if (neighbor == uint32_t(-1) || neighbor >= nFaces || IsUnusedFace(indices, neighbor))
+                    continue;
+
+                UnionRoots(parent, uint32_t(face), neighbor);
+            }
+        }
+
+        std::vector<uint32_t> rootComponent(nFaces, uint32_t(-1));
+        for (size_t face = 0; face < nFaces; ++face)
+        {
+            if (IsUnusedFace(indices, face))
+                continue;
+
+            const uint32_t root = FindRoot(parent, uint32_t(face));
+            if (rootComponent[root] == uint32_t(-1))
+            {
+                rootComponent[root] = uint32_t(components.size());
+                components.emplace_back();
+            }
+            components[rootComponent[root]].faces.push_back(uint32_t(face));
+        }
+
+        // A vertex shared by two components (a bowtie) is duplicated into each
+        std::vector<uint32_t> localVert(nVerts, uint32_t(-1));
+        for (auto& comp : components)
+        {
+            for (auto face : comp.faces)
+            {
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    const index_t v = indices[face * 3 + k];
+                    if (size_t(v) < nVerts && localVert[v] == uint32_t(-1))
+                    {
+                        localVert[v] = uint32_t(comp.verts.size());
+                        comp.verts.push_back(uint32_t(v));
+                    }
+                }
+            }
+
+            for (auto v : comp.verts)
+                localVert[v] = uint32_t(-1);
+        }
+    }
+
+    template<typename index_t>
+    void PartitionComponent(
+        size_t compIndex,
+        Component& comp,
+        const XMFLOAT3* positions,
+        const index_t* indices,
+        DXGI_FORMAT indexFormat,
+        size_t nVerts,
+        float maxStretch,
+        const uint32_t* adjacency,
+        const uint32_t* falseEdgeAdjacency,
+        const float* pIMTArray,
+        ProgressAggregator& progress,
+        float callbackFrequency,
+        UVATLAS options)
+    {
+        const size_t nLocalFaces = comp.faces.size();
+        const size_t nLocalVerts = comp.verts.size();
+
+        // Input vertex -> local vertex, sorted for lookup
+        std::vector<std::pair<uint32_t, uint32_t>> vertMap(nLocalVerts);
+        for (size_t j = 0; j < nLocalVerts; ++j)
+            vertMap[j] = std::make_pair(comp.verts[j], uint32_t(j));
+        std::sort(vertMap.begin(), vertMap.end());
+
+        std::vector<XMFLOAT3> localPos(nLocalVerts);
+        for (size_t j = 0; j < nLocalVerts; ++j)
+            localPos[j] = positions[comp.verts[j]];
+
+        std::vector<index_t> localIndices(nLocalFaces * 3);
+        std::vector<uint32_t> localAdj(nLocalFaces * 3);
+        std::vector<uint32_t> localFalseEdges(falseEdgeAdjacency ? nLocalFaces * 3 : 0);
+        std::vector<float> localIMT(pIMTArray ? nLocalFaces * 3 : 0);
+
+        // comp.faces is in ascending input order, so it doubles as the input -> local lookup
+        auto toLocalFace = [&](uint32_t face) -> uint32_t
+        {
+            if (face == uint32_t(-1))
+                return face;
+
+            auto it = std::lower_bound(comp.faces.begin(), comp.faces.end(), face);
+            return (it != comp.faces.end() && *it == face) ? uint32_t(it - comp.faces.begin()) : uint32_t(-1);
+        };
+
+        for (size_t j = 0; j < nLocalFaces; ++j)
+        {
+            const size_t face = comp.faces[j];
+            for (size_t k = 0; k < 3; ++k)
+            {
+                const index_t v = indices[face * 3 + k];
+                if (size_t(v) < nVerts)
+                {
+                    auto it = std::lower_bound(vertMap.begin(), vertMap.end(), std::make_pair(uint32_t(v), uint32_t(0)));
+                    localIndices[j * 3 + k] = index_t(it->second);
+                }
+                else
+                {
+                    // Out of range indices pass through for UVAtlasPartition to reject
+                    localIndices[j * 3 + k] = v;
+                }
+                localAdj[j * 3 + k] = toLocalFace(adjacency[face * 3 + k]);
+
+                if (falseEdgeAdjacency)
+                    localFalseEdges[j * 3 + k] = toLocalFace(falseEdgeAdjacency[face * 3 + k]);
+
+                if (pIMTArray)
+                    localIMT[j * 3 + k] = pIMTArray[face * 3 + k];
+            }
+        }
+
+        auto callback = [&progress, compIndex](float percentComplete) -> HRESULT
+        {
+            return progress.Part(compIndex, percentComplete);
+        };
+
+        comp.hr = UVAtlasPartition(localPos.data(), nLocalVerts,
+            localIndices.data(), indexFormat, nLocalFaces,
+            0, maxStretch,
+            localAdj.data(),
+            falseEdgeAdjacency ? localFalseEdges.data() : nullptr,
+            pIMTArray ? localIMT.data() : nullptr,
+            callback, callbackFrequency,
+            options,
+            comp.vb, comp.ib, &comp.facePartitioning, &comp.vertexRemap, comp.partitionAdjacency,
+            &comp.maxStretch, &comp.numCharts);
+    }
+
+    template<typename index_t>
+    HRESULT CreateParallel(
+        const XMFLOAT3* positions, size_t nVerts,
+        const index_t* indices, DXGI_FORMAT indexFormat, size_t nFaces,
+        float maxStretch,
+        size_t width, size_t height, float gutter,
+        const uint32_t* adjacency, const uint32_t* falseEdgeAdjacency, const float* pIMTArray,
+        std::function<HRESULT __cdecl(float)> statusCallBack, float callbackFrequency,
+        UVATLAS options,
+        std::vector<Component>& components,
+        size_t threadCount,
+        std::vector<UVAtlasVertex>& vMeshOutVertexBuffer,
+        std::vector<uint8_t>& vMeshOutIndexBuffer,
+        std::vector<uint32_t>* pvFacePartitioning,
+        std::vector<uint32_t>* pvVertexRemapArray,
+        float* maxStretchOut,
+        size_t* numChartsOut)
+    {
+        std::vector<float> weights(components.size());
+        for (size_t j = 0; j < components.size(); ++j)
+        {
+            weights[j] = float(components[j].faces.size()) / float(nFaces);
+        }
+
+        ProgressAggregator progress(statusCallBack, std::move(weights), c_PartitionWeight);
+
+        // Largest components first so one big part doesn't start last
+        std::vector<size_t> order(components.size());
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::stable_sort(order.begin(), order.end(),
+            [&](size_t a, size_t b) { return components[a].faces.size() > components[b].faces.size(); });
+
+        RunConcurrent(order, threadCount, progress, [&](size_t index)
+        {
+            auto& comp = components[index];
+            try
+            {
+                PartitionComponent<index_t>(index, comp, positions, indices, indexFormat, nVerts, maxStretch,
+                    adjacency, falseEdgeAdjacency, pIMTArray, progress, callbackFrequency, options);
+            }
+            catch (const std::bad_alloc&)
+            {
+                comp.hr = E_OUTOFMEMORY;
+            }
+            catch (...)
+            {
+                comp.hr = E_FAIL;
+            }
+        });
+
+        if (FAILED(progress.GetCancel()))
+            return progress.GetCancel();
+
+        // Merge, keeping the input face order
+        size_t totalVerts = 0;
+        for (const auto& comp : components)
+        {
+            if (FAILED(comp.hr))
+                return comp.hr;
+            totalVerts += comp.vb.size();
+        }
+
+        if (totalVerts >= ((sizeof(index_t) == 2) ? size_t(UINT16_MAX) : size_t(UINT32_MAX)))
+            return c_ArithmeticOverflow;
+
+        vMeshOutVertexBuffer.clear();
+        vMeshOutVertexBuffer.reserve(totalVerts);
+
+        // Unused faces are in no component, so they keep the marker in every index and chart 0
+        vMeshOutIndexBuffer.assign(nFaces * 3 * sizeof(index_t), 0xff);
+
+        std::vector<uint32_t> facePartitioning(nFaces, 0);
+        std::vector<uint32_t> vertexRemap(totalVerts, 0);
+        std::vector<uint32_t> partitionAdjacency(nFaces * 3, uint32_t(-1));
+
+        auto outIndices = reinterpret_cast<index_t*>(vMeshOutIndexBuffer.data());
+
+        float stretch = 0.f;
+        size_t charts = 0;
+        for (const auto& comp : components)
+        {
+            const size_t vbOffset = vMeshOutVertexBuffer.size();
+            auto localIndices = reinterpret_cast<const index_t*>(comp.ib.data());
+
+            for (size_t j = 0; j < comp.faces.size(); ++j)
+            {
+                const size_t face = comp.faces[j];
+                facePartitioning[face] = uint32_t(charts + comp.facePartitioning[j]);
+
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    const index_t local = localIndices[j * 3 + k];
+                    outIndices[face * 3 + k] = (local == index_t(-1)) ? local : index_t(vbOffset + local);
+
+                    const uint32_t neighbor = comp.partitionAdjacency[j * 3 + k];
+                    partitionAdjacency[face * 3 + k] = (neighbor == uint32_t(-1)) ? neighbor : comp.faces[neighbor];
+                }
+            }
+
+            for (size_t j = 0; j < comp.vertexRemap.size(); ++j)
+            {
+                vertexRemap[vbOffset + j] = comp.verts[comp.vertexRemap[j]];
+            }
+
+            vMeshOutVertexBuffer.insert(vMeshOutVertexBuffer.end(), comp.vb.begin(), comp.vb.end());
+
+            stretch = std::max(stretch, comp.maxStretch);
+            charts += comp.numCharts;
+        }
+
+        // Release the per-component copies before packing
+        components.clear();
+
+        auto packCallback = [&progress](float percentComplete) -> HRESULT
+        {
+            return progress.Final(percentComplete);
+        };
+
+        const HRESULT hr = UVAtlasPack(vMeshOutVertexBuffer, vMeshOutIndexBuffer, indexFormat,
+            width, height, gutter, partitionAdjacency, packCallback, callbackFrequency);
+        if (FAILED(hr))
+            return hr;
+
+        if (pvFacePartitioning)
+            pvFacePartitioning->swap(facePartitioning);
+
+        if (pvVertexRemapArray)
+            pvVertexRemapArray->swap(vertexRemap);
+
+        if (maxStretchOut)
+            *maxStretchOut = stretch;
+
+        if (numChartsOut)
+            *numChartsOut = charts;
+
+        return S_OK;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT __cdecl UVAtlasCreateParallel(
+    const XMFLOAT3* positions, size_t nVerts,
+    const void* indices, DXGI_FORMAT indexFormat, size_t nFaces,
+    size_t maxChartNumber, float maxStretch,
+    size_t width, size_t height, float gutter,
+    const uint32_t* adjacency, const uint32_t* falseEdgeAdjacency, const float* pIMTArray,
+    std::function<HRESULT __cdecl(float percentComplete)> statusCallBack,
+    float callbackFrequency,
+    UVATLAS options,
+    size_t threadCount,
+    std::vector<UVAtlasVertex>& vMeshOutVertexBuffer,
+    std::vector<uint8_t>& vMeshOutIndexBuffer,
+    std::vector<uint32_t>* pvFacePartitioning,
+    std::vector<uint32_t>* pvVertexRemapArray,
+    float* maxStretchOut,
+    size_t* numChartsOut)
+{
+    if (!threadCount)
+        threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+    const bool validFormat = (indexFormat == DXGI_FORMAT_R16_UINT || indexFormat == DXGI_FORMAT_R32_UINT);
+
+    // Anything the split can't handle, including invalid arguments, gets UVAtlasCreate's behavior.
+    // A threadCount of 1 still splits so the output doesn't depend on it.
+    if (maxChartNumber != 0 || !validFormat || !positions || !indices || !adjacency
+        || !nFaces || !nVerts || nVerts >= UINT32_MAX || nFaces >= (UINT32_MAX / 3))
+    {
+        return UVAtlasCreate(positions, nVerts, indices, indexFormat, nFaces,
+            maxChartNumber, maxStretch, width, height, gutter,
+            adjacency, falseEdgeAdjacency, pIMTArray, statusCallBack, callbackFrequency,
+            options, vMeshOutVertexBuffer, vMeshOutIndexBuffer,
+            pvFacePartitioning, pvVertexRemapArray, maxStretchOut, numChartsOut);
+    }
+
+    try
+    {
+        std::vector<Component> components;
+        if (indexFormat == DXGI_FORMAT_R16_UINT)
+            SplitComponents(static_cast<const uint16_t*>(indices), nFaces, nVerts, adjacency, components);
+        else
+            SplitComponents(static_cast<const uint32_t*>(indices), nFaces, nVerts, adjacency, components);
+
+        if (components.size() < 2)
+        {
+            components.clear();
+            return UVAtlasCreate(positions, nVerts, indices, indexFormat, nFaces,
+                maxChartNumber, maxStretch, width, height, gutter,
+                adjacency, falseEdgeAdjacency, pIMTArray, statusCallBack, callbackFrequency,
+                options, vMeshOutVertexBuffer, vMeshOutIndexBuffer,
+                pvFacePartitioning, pvVertexRemapArray, maxStretchOut, numChartsOut);
+        }
+
+        if (indexFormat == DXGI_FORMAT_R16_UINT)
+        {
+            return CreateParallel(positions, nVerts, static_cast<const uint16_t*>(indices), indexFormat, nFaces,
+                maxStretch, width, height, gutter, adjacency, falseEdgeAdjacency, pIMTArray,
+                statusCallBack, callbackFrequency, options, components, threadCount,
+                vMeshOutVertexBuffer, vMeshOutIndexBuffer, pvFacePartitioning, pvVertexRemapArray, maxStretchOut, numChartsOut);
+        }
+        else
+        {
+            return CreateParallel(positions, nVerts, static_cast<const uint32_t*>(indices), indexFormat, nFaces,
+                maxStretch, width, height, gutter, adjacency, falseEdgeAdjacency, pIMTArray,
+                statusCallBack, callbackFrequency, options, components, threadCount,
+                vMeshOutVertexBuffer, vMeshOutIndexBuffer, pvFacePartitioning, pvVertexRemapArray, maxStretchOut, numChartsOut);
+        }
+    }
+    catch (const std::bad_alloc&)
+    {
+        return E_OUTOFMEMORY;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT __cdecl UVAtlasPackMultiple(
+    const std::vector<UVAtlasVertex>& vMeshVertexBuffer,
+    const std::vector<uint8_t>& vMeshIndexBuffer,
+    DXGI_FORMAT indexFormat,
+    const UVAtlasPackTarget* targets, size_t nTargets,
+    const std::vector<uint32_t>& vPartitionResultAdjacency,
+    std::function<HRESULT __cdecl(float percentComplete)> statusCallBack,
+    float callbackFrequency,
+    size_t threadCount,
+    std::vector<std::vector<UVAtlasVertex>>& vMeshOutVertexBuffers,
+    std::vector<std::vector<uint8_t>>& vMeshOutIndexBuffers)
+{
+    if (!targets || !nTargets)
+        return E_INVALIDARG;
+
+    if (indexFormat != DXGI_FORMAT_R16_UINT && indexFormat != DXGI_FORMAT_R32_UINT)
+        return E_INVALIDARG;
+
+    if (vMeshVertexBuffer.empty() || vMeshIndexBuffer.empty())
+        return E_INVALIDARG;
+
+    // Checked up front so a bad target doesn't cost the packs before it
+    for (size_t j = 0; j < nTargets; ++j)
+    {
+        if (!targets[j].width || !targets[j].height || !(targets[j].gutter >= 0.f))
+            return E_INVALIDARG;
+    }
+
+    if (!threadCount)
+        threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+    try
+    {
+        std::vector<std::vector<UVAtlasVertex>> vbs(nTargets);
+        std::vector<std::vector<uint8_t>> ibs(nTargets);
+        std::vector<HRESULT> results(nTargets, S_OK);
+
+        ProgressAggregator progress(statusCallBack, std::vector<float>(nTargets, 1.f / float(nTargets)), 1.f);
+
+        std::vector<size_t> order(nTargets);
+        std::iota(order.begin(), order.end(), size_t(0));
+
+        RunConcurrent(order, threadCount, progress, [&](size_t index)
+        {
+            auto callback = [&progress, index](float percentComplete) -> HRESULT
+            {
+                return progress.Part(index, percentComplete);
+            };
+
+            try
+            {
+                vbs[index] = vMeshVertexBuffer;
+                ibs[index] = vMeshIndexBuffer;
+                results[index] = UVAtlasPack(vbs[index], ibs[index], indexFormat,
+                    targets[index].width, targets[index].height, targets[index].gutter,
+                    vPartitionResultAdjacency, callback, callbackFrequency);
+            }
+            catch (const std::bad_alloc&)
+            {
+                results[index] = E_OUTOFMEMORY;
+            }
+            catch (...)
+            {
+                results[index] = E_FAIL;
+            }
+        });
+
+        if (FAILED(progress.GetCancel()))
+            return progress.GetCancel();
+
+        for (auto hr : results)
+        {
+            if (FAILED(hr))
+                return hr;
+        }
+
+        vMeshOutVertexBuffers.swap(vbs);
+        vMeshOutIndexBuffers.swap(ibs);
+        return S_OK;
+    }
+    catch (const std::bad_alloc&)
+    {
+        return E_OUTOFMEMORY;
+    }
+}
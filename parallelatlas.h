@@ -0,0 +1,74 @@
+//-------------------------------------------------------------------------------------
+// parallelatlas.h
+//
+// Concurrent atlas entry points built on the public UVAtlasPartition/UVAtlasPack API:
+// UVAtlasCreate with the partition (charting and parameterization) step run per connected
+// component, and one partition packed at several resolutions
+//
+// Copyright (c) Microsoft Corporation.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "UVAtlas.h"
+
+// Same contract as UVAtlasCreate, plus threadCount (0 for one per hardware thread).
+//
+// Connected components (by adjacency) are partitioned on up to threadCount threads and
+// the results packed together in one UVAtlasPack call. Meshes with a single component or
+// a maxChartNumber limit go straight to UVAtlasCreate on the calling thread, so a single
+// connected scan (Head_Big_Ears, most photogrammetry) gets no speedup; the parallelism is
+// only across components. Unused faces (marked with a -1 index) belong to no component;
+// their output indices are all -1 and their chart is 0. The callback is serialized and
+// sees the overall progress.
+//
+// Output is byte-identical for every threadCount: each component is partitioned on its
+// own copy of the data and merged in component order, so scheduling never reaches it.
+HRESULT __cdecl UVAtlasCreateParallel(
+    _In_reads_(nVerts) const DirectX::XMFLOAT3* positions, size_t nVerts,
+    _When_(indexFormat == DXGI_FORMAT_R16_UINT, _In_reads_bytes_(nFaces * sizeof(uint16_t) * 3))
+    _When_(indexFormat != DXGI_FORMAT_R16_UINT, _In_reads_bytes_(nFaces * sizeof(uint32_t) * 3)) const void* indices,
+    DXGI_FORMAT indexFormat, size_t nFaces,
+    size_t maxChartNumber, float maxStretch,
+    size_t width, size_t height, float gutter,
+    _In_reads_(nFaces * 3) const uint32_t* adjacency,
+    _In_reads_opt_(nFaces * 3) const uint32_t* falseEdgeAdjacency,
+    _In_reads_opt_(nFaces * 3) const float* pIMTArray,
+    std::function<HRESULT __cdecl(float percentComplete)> statusCallBack,
+    float callbackFrequency,
+    DirectX::UVATLAS options,
+    size_t threadCount,
+    std::vector<DirectX::UVAtlasVertex>& vMeshOutVertexBuffer,
+    std::vector<uint8_t>& vMeshOutIndexBuffer,
+    _Out_opt_ std::vector<uint32_t>* pvFacePartitioning,
+    _Out_opt_ std::vector<uint32_t>* pvVertexRemapArray,
+    _Out_opt_ float* maxStretchOut,
+    _Out_opt_ size_t* numChartsOut);
+
+// One output resolution for UVAtlasPackMultiple
+struct UVAtlasPackTarget
+{
+    size_t width;
+    size_t height;
+    float gutter;
+};
+
+// Packs a partition from UVAtlasPartition once per target, concurrently on up to threadCount
+// threads (0 for one per hardware thread). Entry j of the outputs matches what UVAtlasPack
+// gives for targets[j] on a copy of the input, which is left unchanged. On failure the
+// outputs are untouched and the error from the first failing target is returned.
+HRESULT __cdecl UVAtlasPackMultiple(
+    const std::vector<DirectX::UVAtlasVertex>& vMeshVertexBuffer,
+    const std::vector<uint8_t>& vMeshIndexBuffer,
+    DXGI_FORMAT indexFormat,
+    _In_reads_(nTargets) const UVAtlasPackTarget* targets, size_t nTargets,
+    const std::vector<uint32_t>& vPartitionResultAdjacency,
+    std::function<HRESULT __cdecl(float percentComplete)> statusCallBack,
+    float callbackFrequency,
+    size_t threadCount,
+    std::vector<std::vector<DirectX::UVAtlasVertex>>& vMeshOutVertexBuffers,
+    std::vector<std::vector<uint8_t>>& vMeshOutIndexBuffers);
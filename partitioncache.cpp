@@ -0,0 +1,450 @@
+//-------------------------------------------------------------------------------------
+// partitioncache.cpp
+//
+// Copyright (c) Microsoft Corporation.
+//-------------------------------------------------------------------------------------
+
+#include "directxtest.h"
+#include "partitioncache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <new>
+#include <thread>
+
+using namespace DirectX;
+
+namespace
+{
+    const uint32_t c_CacheMagic = 0x43505655; // 'UVPC'
+    const uint32_t c_CacheVersion = 2;
+
+    const size_t c_CompareChunk = 256 * 1024;
+
+    inline uint64_t RotateLeft(uint64_t value, int bits) noexcept
+    {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    inline uint64_t Finalize(uint64_t h) noexcept
+    {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    // Names entries and checks payloads. Two independent 64-bit lanes over 8-byte words
+    // (MurmurHash3-style mixing), so it runs at memory speed on large meshes. It is not
+    // collision resistant and doesn't need to be: entries store the inputs they were made
+    // from and a hit compares them, so a collision only costs a recompute.
+    class ContentHash
+    {
+    public:
+        ContentHash() noexcept : m_lane{ 0x9e3779b97f4a7c15ull, 0xc2b2ae3d27d4eb4full }, m_size(0) {}
+
+        void Add(const void* data, size_t size) noexcept
+        {
+            auto ptr = static_cast<const uint8_t*>(data);
+            const size_t words = size / sizeof(uint64_t);
+            for (size_t j = 0; j < words; ++j)
+            {
+                uint64_t word;
+                memcpy(&word, ptr + j * sizeof(uint64_t), sizeof(word));
+                AddWord(word);
+            }
+
+            // The tail is padded to a word; the total size folded in at the end tells
+            // padding from data
+            const size_t tail = size % sizeof(uint64_t);
+            if (tail)
+            {
+                uint64_t word = 0;
+                memcpy(&word, ptr + words * sizeof(uint64_t), tail);
+                AddWord(word);
+            }
+
+            m_size += size;
+        }
+
+        template<typename T>
+        void AddValue(const T& value) noexcept
+        {
+            Add(&value, sizeof(T));
+        }
+
+        // Optional arrays hash their presence so null and all-zero differ
+        void AddOptional(const void* data, size_t size) noexcept
+        {
+            const uint8_t present = data ? 1 : 0;
+            AddValue(present);
+            if (data)
+                Add(data, size);
+        }
+
+        void GetKey(uint64_t key[2]) const noexcept
+        {
+            key[0] = Finalize(m_lane[0] ^ m_size);
+            key[1] = Finalize(m_lane[1] ^ RotateLeft(m_size, 32));
+        }
+
+        uint64_t Get() const noexcept
+        {
+            uint64_t key[2];
+            GetKey(key);
+            return key[0] ^ key[1];
+        }
+
+    private:
+        void AddWord(uint64_t word) noexcept
+        {
+            m_lane[0] = RotateLeft(m_lane[0] ^ (RotateLeft(word * 0x87c37b91114253d5ull, 31) * 0x4cf5ad432745937full), 27) * 5 + 0x52dce729;
+            m_lane[1] = RotateLeft(m_lane[1] ^ (RotateLeft(word * 0x4cf5ad432745937full, 33) * 0x87c37b91114253d5ull), 31) * 5 + 0x38495ab5;
+        }
+
+        uint64_t m_lane[2];
+        uint64_t m_size;
+    };
+
+    // The inputs an entry was made from, stored after the header and compared on a hit
+    struct PartitionInputs
+    {
+        const XMFLOAT3* positions;
+        const void* indices;
+        const uint32_t* adjacency;
+        const uint32_t* falseEdgeAdjacency;
+        const float* pIMTArray;
+    };
+
+    struct CacheHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key[2];
+        uint64_t nVerts;
+        uint64_t nFaces;
+        uint32_t indexFormat;
+        uint32_t libraryVersion;
+        uint64_t maxChartNumber;
+        uint64_t options;
+        float maxStretchIn;
+        uint32_t optionalInputs;    // bit 0 false edges, bit 1 IMT
+        float maxStretch;
+        uint32_t reserved;
+        uint64_t numCharts;
+        uint64_t vertexCount;       // output vertices, and remap entries
+        uint64_t payloadHash;
+    };
+
+    static_assert(sizeof(UVAtlasVertex) == sizeof(XMFLOAT3) + sizeof(XMFLOAT2), "UVAtlasVertex must not have padding to be hashed");
+
+    struct PartitionResult
+    {
+        std::vector<UVAtlasVertex> vb;
+        std::vector<uint8_t> ib;
+        std::vector<uint32_t> facePart;
+        std::vector<uint32_t> remap;
+        std::vector<uint32_t> adjacency;
+        float maxStretch;
+        size_t numCharts;
+    };
+
+    uint64_t HashPayload(const PartitionResult& result) noexcept
+    {
+        ContentHash hash;
+        hash.Add(result.vb.data(), result.vb.size() * sizeof(UVAtlasVertex));
+        hash.Add(result.ib.data(), result.ib.size());
+        hash.Add(result.facePart.data(), result.facePart.size() * sizeof(uint32_t));
+        hash.Add(result.remap.data(), result.remap.size() * sizeof(uint32_t));
+        hash.Add(result.adjacency.data(), result.adjacency.size() * sizeof(uint32_t));
+        return hash.Get();
+    }
+
+    bool ReadArray(FILE* fp, void* data, size_t size) noexcept
+    {
+        return !size || fread(data, 1, size, fp) == size;
+    }
+
+    bool WriteArray(FILE* fp, const void* data, size_t size) noexcept
+    {
+        return !size || fwrite(data, 1, size, fp) == size;
+    }
+
+    // Compares the next size bytes of the file with data, a chunk at a time
+    bool MatchArray(FILE* fp, const void* data, size_t size, uint8_t* buffer, size_t bufferSize) noexcept
+    {
+        auto ptr = static_cast<const uint8_t*>(data);
+        while (size)
+        {
+            const size_t chunk = std::min(size, bufferSize);
+            if (fread(buffer, 1, chunk, fp) != chunk || memcmp(buffer, ptr, chunk) != 0)
+                return false;
+
+            ptr += chunk;
+            size -= chunk;
+        }
+        return true;
+    }
+
+    size_t GetInputSizes(const CacheHeader& header, size_t indexSize, size_t sizes[5]) noexcept
+    {
+        const size_t nFaces = size_t(header.nFaces);
+        sizes[0] = size_t(header.nVerts) * sizeof(XMFLOAT3);
+        sizes[1] = nFaces * 3 * indexSize;
+        sizes[2] = nFaces * 3 * sizeof(uint32_t);
+        sizes[3] = (header.optionalInputs & 1) ? nFaces * 3 * sizeof(uint32_t) : 0;
+        sizes[4] = (header.optionalInputs & 2) ? nFaces * 3 * sizeof(float) : 0;
+        return 5;
+    }
+
+    // Anything unexpected is a miss; the caller recomputes and rewrites the entry. That
+    // includes an entry made from other inputs whose key collides with these.
+    bool ReadEntry(const wchar_t* file, const CacheHeader& expected, const PartitionInputs& inputs, size_t indexSize, PartitionResult& result)
+    {
+        FILE* fp = OpenFile(file, "rb");
+        if (!fp)
+            return false;
+
+        CacheHeader header = {};
+        bool ok = fread(&header, sizeof(header), 1, fp) == 1
+            && header.magic == c_CacheMagic
+            && header.version == c_CacheVersion
+            && header.key[0] == expected.key[0]
+            && header.key[1] == expected.key[1]
+            && header.nVerts == expected.nVerts
+            && header.nFaces == expected.nFaces
+            && header.indexFormat == expected.indexFormat
+            && header.libraryVersion == expected.libraryVersion
+            && header.maxChartNumber == expected.maxChartNumber
+            && header.options == expected.options
+            && memcmp(&header.maxStretchIn, &expected.maxStretchIn, sizeof(float)) == 0
+            && header.optionalInputs == expected.optionalInputs
+            && header.vertexCount >= header.nVerts
+            && header.vertexCount <= header.nVerts + header.nFaces * 3;
+
+        if (ok)
+        {
+            size_t sizes[5];
+            const void* data[5] = { inputs.positions, inputs.indices, inputs.adjacency, inputs.falseEdgeAdjacency, inputs.pIMTArray };
+            const size_t count = GetInputSizes(header, indexSize, sizes);
+
+            std::unique_ptr<uint8_t[]> buffer(new (std::nothrow) uint8_t[c_CompareChunk]);
+            ok = buffer != nullptr;
+            for (size_t j = 0; j < count && ok; ++j)
+            {
+                ok = MatchArray(fp, data[j], sizes[j], buffer.get(), c_CompareChunk);
+            }
+        }
+
+        if (ok)
+        {
+            const size_t nFaces = size_t(header.nFaces);
+            const size_t nVerts = size_t(header.vertexCount);
+            result.vb.resize(nVerts);
+            result.ib.resize(nFaces * 3 * indexSize);
+            result.facePart.resize(nFaces);
+            result.remap.resize(nVerts);
+            result.adjacency.resize(nFaces * 3);
+
+            ok = ReadArray(fp, result.vb.data(), nVerts * sizeof(UVAtlasVertex))
+                && ReadArray(fp, result.ib.data(), result.ib.size())
+                && ReadArray(fp, result.facePart.data(), nFaces * sizeof(uint32_t))
+                && ReadArray(fp, result.remap.data(), nVerts * sizeof(uint32_t))
+                && ReadArray(fp, result.adjacency.data(), nFaces * 3 * sizeof(uint32_t))
+                && fgetc(fp) == EOF
+                && HashPayload(result) == header.payloadHash;
+
+            result.maxStretch = header.maxStretch;
+            result.numCharts = size_t(header.numCharts);
+        }
+
+        fclose(fp);
+        return ok;
+    }
+
+    void WriteEntry(const std::wstring& file, CacheHeader header, const PartitionInputs& inputs, size_t indexSize, const PartitionResult& result)
+    {
+        // Writers of the same entry each use their own temporary so a reader never sees a
+        // partial file
+        const std::wstring temp = file + L"." + std::to_wstring(std::hash<std::thread::id>()(std::this_thread::get_id()))
+            + L"." + std::to_wstring(GetTickMS()) + L".tmp";
+
+        FILE* fp = OpenFile(temp.c_str(), "wb");
+        if (!fp)
+            return;
+
+        header.maxStretch = result.maxStretch;
+        header.numCharts = result.numCharts;
+        header.vertexCount = result.vb.size();
+        header.payloadHash = HashPayload(result);
+
+        size_t sizes[5];
+        const void* data[5] = { inputs.positions, inputs.indices, inputs.adjacency, inputs.falseEdgeAdjacency, inputs.pIMTArray };
+        const size_t count = GetInputSizes(header, indexSize, sizes);
+
+        bool ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+        for (size_t j = 0; j < count && ok; ++j)
+        {
+            ok = WriteArray(fp, data[j], sizes[j]);
+        }
+
+        ok = ok
+            && WriteArray(fp, result.vb.data(), result.vb.size() * sizeof(UVAtlasVertex))
+            && WriteArray(fp, result.ib.data(), result.ib.size())
+            && WriteArray(fp, result.facePart.data(), result.facePart.size() * sizeof(uint32_t))
+            && WriteArray(fp, result.remap.data(), result.remap.size() * sizeof(uint32_t))
+            && WriteArray(fp, result.adjacency.data(), result.adjacency.size() * sizeof(uint32_t));
+
+        ok = (fclose(fp) == 0) && ok;
+
+        if (!ok || !MoveFileReplace(temp.c_str(), file.c_str()))
+        {
+            RemovePath(temp.c_str());
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT __cdecl UVAtlasPartitionCached(
+    const wchar_t* cacheDirectory,
+    const XMFLOAT3* positions, size_t nVerts,
+    const void* indices,
+    DXGI_FORMAT indexFormat, size_t nFaces,
+    size_t maxChartNumber, float maxStretch,
+    const uint32_t* adjacency,
+    const uint32_t* falseEdgeAdjacency,
+    const float* pIMTArray,
+    std::function<HRESULT __cdecl(float percentComplete)> statusCallBack,
+    float callbackFrequency,
+    UVATLAS options,
+    std::vector<UVAtlasVertex>& vMeshOutVertexBuffer,
+    std::vector<uint8_t>& vMeshOutIndexBuffer,
+    std::vector<uint32_t>* pvFacePartitioning,
+    std::vector<uint32_t>* pvVertexRemapArray,
+    std::vector<uint32_t>& vPartitionResultAdjacency,
+    float* maxStretchOut,
+    size_t* numChartsOut,
+    UVAtlasPartitionCacheInfo* pCacheInfo)
+{
+    if (!cacheDirectory || !*cacheDirectory)
+        return E_INVALIDARG;
+
+    size_t indexSize = 0;
+    switch (indexFormat)
+    {
+    case DXGI_FORMAT_R16_UINT: indexSize = sizeof(uint16_t); break;
+    case DXGI_FORMAT_R32_UINT: indexSize = sizeof(uint32_t); break;
+    default: break;
+    }
+
+    // Arguments that can't be hashed go straight to the library for its usual error
+    if (!positions || !nVerts || !indices || !nFaces || !adjacency || !indexSize
+        || nVerts >= UINT32_MAX || nFaces >= (UINT32_MAX / 3))
+    {
+        return UVAtlasPartition(positions, nVerts, indices, indexFormat, nFaces,
+            maxChartNumber, maxStretch, adjacency, falseEdgeAdjacency, pIMTArray,
+            statusCallBack, callbackFrequency, options,
+            vMeshOutVertexBuffer, vMeshOutIndexBuffer, pvFacePartitioning, pvVertexRemapArray,
+            vPartitionResultAdjacency, maxStretchOut, numChartsOut);
+    }
+
+    try
+    {
+        ContentHash hash;
+        hash.AddValue(c_CacheVersion);
+        hash.AddValue(static_cast<uint32_t>(UVATLAS_VERSION));
+        hash.AddValue(static_cast<uint64_t>(nVerts));
+        hash.Add(positions, nVerts * sizeof(XMFLOAT3));
+        hash.AddValue(static_cast<uint32_t>(indexFormat));
+        hash.AddValue(static_cast<uint64_t>(nFaces));
+        hash.Add(indices, nFaces * 3 * indexSize);
+        hash.Add(adjacency, nFaces * 3 * sizeof(uint32_t));
+        hash.AddOptional(falseEdgeAdjacency, nFaces * 3 * sizeof(uint32_t));
+        hash.AddOptional(pIMTArray, nFaces * 3 * sizeof(float));
+        hash.AddValue(static_cast<uint64_t>(options));
+        hash.AddValue(static_cast<uint64_t>(maxChartNumber));
+        hash.AddValue(maxStretch);
+
+        CacheHeader header = {};
+        header.magic = c_CacheMagic;
+        header.version = c_CacheVersion;
+        hash.GetKey(header.key);
+        header.nVerts = nVerts;
+        header.nFaces = nFaces;
+        header.indexFormat = static_cast<uint32_t>(indexFormat);
+        header.libraryVersion = static_cast<uint32_t>(UVATLAS_VERSION);
+        header.maxChartNumber = maxChartNumber;
+        header.options = static_cast<uint64_t>(options);
+        header.maxStretchIn = maxStretch;
+        header.optionalInputs = (falseEdgeAdjacency ? 1u : 0u) | (pIMTArray ? 2u : 0u);
+
+        const PartitionInputs inputs = { positions, indices, adjacency, falseEdgeAdjacency, pIMTArray };
+
+        wchar_t name[40] = {};
+        swprintf(name, std::size(name), L"%016llx%016llx.uvp",
+            static_cast<unsigned long long>(header.key[0]), static_cast<unsigned long long>(header.key[1]));
+
+        std::wstring file = cacheDirectory;
+#ifdef _WIN32
+        if (file.back() != L'\\' && file.back() != L'/')
+            file += L'\\';
+#else
+        if (file.back() != L'/')
+            file += L'/';
+#endif
+        file += name;
+
+        PartitionResult result;
+        const bool hit = ReadEntry(file.c_str(), header, inputs, indexSize, result);
+        if (!hit)
+        {
+            HRESULT hr = UVAtlasPartition(positions, nVerts, indices, indexFormat, nFaces,
+                maxChartNumber, maxStretch, adjacency, falseEdgeAdjacency, pIMTArray,
+                statusCallBack, callbackFrequency, options,
+                result.vb, result.ib, &result.facePart, &result.remap, result.adjacency,
+                &result.maxStretch, &result.numCharts);
+            if (FAILED(hr))
+                return hr;
+
+            WriteEntry(file, header, inputs, indexSize, result);
+        }
+        else if (statusCallBack)
+        {
+            // Cancellation is still honored on the fast path
+            HRESULT hr = statusCallBack(1.f);
+            if (FAILED(hr))
+                return hr;
+        }
+
+        vMeshOutVertexBuffer.swap(result.vb);
+        vMeshOutIndexBuffer.swap(result.ib);
+        if (pvFacePartitioning)
+            pvFacePartitioning->swap(result.facePart);
+        if (pvVertexRemapArray)
+            pvVertexRemapArray->swap(result.remap);
+        vPartitionResultAdjacency.swap(result.adjacency);
+        if (maxStretchOut)
+            *maxStretchOut = result.maxStretch;
+        if (numChartsOut)
+            *numChartsOut = result.numCharts;
+
+        if (pCacheInfo)
+        {
+            pCacheInfo->hit = hit;
+            pCacheInfo->file.swap(file);
+        }
+
+        return S_OK;
+    }
+    catch (const std::bad_alloc&)
+    {
+        return E_OUTOFMEMORY;
+    }
+}
@@ -0,0 +1,52 @@
+//-------------------------------------------------------------------------------------
+// partitioncache.h
+//
+// On-disk cache of UVAtlasPartition results keyed by the content of the inputs, so only
+// UVAtlasPack has to run again when pack settings (resolution, gutter) change
+//
+// Copyright (c) Microsoft Corporation.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "UVAtlas.h"
+
+struct UVAtlasPartitionCacheInfo
+{
+    bool hit;               // results came from the cache
+    std::wstring file;      // the entry for these inputs, whether or not it existed
+};
+
+// Same contract as UVAtlasPartition, with results stored in and served from files in
+// cacheDirectory, which must exist. Entries are named by a fast, non-cryptographic 128-bit
+// hash of the positions, indices, adjacency, false edges, IMT, options, maxChartNumber,
+// maxStretch and library version. Each entry also stores those inputs, and a hit only
+// counts when they compare equal, so a changed input or a colliding name misses and
+// recomputes. Entries that fail to read back intact count as misses and are rewritten.
+// Writes go through a temporary file and a rename, and a failed write doesn't fail the call.
+HRESULT __cdecl UVAtlasPartitionCached(
+    _In_z_ const wchar_t* cacheDirectory,
+    _In_reads_(nVerts) const DirectX::XMFLOAT3* positions, size_t nVerts,
+    _When_(indexFormat == DXGI_FORMAT_R16_UINT, _In_reads_bytes_(nFaces * sizeof(uint16_t) * 3))
+    _When_(indexFormat != DXGI_FORMAT_R16_UINT, _In_reads_bytes_(nFaces * sizeof(uint32_t) * 3)) const void* indices,
+    DXGI_FORMAT indexFormat, size_t nFaces,
+    size_t maxChartNumber, float maxStretch,
+    _In_reads_(nFaces * 3) const uint32_t* adjacency,
+    _In_reads_opt_(nFaces * 3) const uint32_t* falseEdgeAdjacency,
+    _In_reads_opt_(nFaces * 3) const float* pIMTArray,
+    std::function<HRESULT __cdecl(float percentComplete)> statusCallBack,
+    float callbackFrequency,
+    DirectX::UVATLAS options,
+    std::vector<DirectX::UVAtlasVertex>& vMeshOutVertexBuffer,
+    std::vector<uint8_t>& vMeshOutIndexBuffer,
+    _Out_opt_ std::vector<uint32_t>* pvFacePartitioning,
+    _Out_opt_ std::vector<uint32_t>* pvVertexRemapArray,
+    std::vector<uint32_t>& vPartitionResultAdjacency,
+    _Out_opt_ float* maxStretchOut,
+    _Out_opt_ size_t* numChartsOut,
+    _Out_opt_ UVAtlasPartitionCacheInfo* pCacheInfo);
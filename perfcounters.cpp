@@ -0,0 +1,199 @@
+//-------------------------------------------------------------------------------------
+// perfcounters.cpp
+//
+// Optional hardware performance counters per test. Uses perf_event_open on Linux;
+// other platforms report the counters as unavailable.
+//
+// Copyright (c) Microsoft Corporation.
+//-------------------------------------------------------------------------------------
+
+#include "directxtest.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    bool s_countersEnabled = false;
+}
+
+#ifdef __linux__
+
+namespace
+{
+    enum : size_t
+    {
+        COUNTER_CYCLES = 0,
+        COUNTER_INSTRUCTIONS,
+        COUNTER_CACHE_MISSES,
+        COUNTER_BRANCH_MISSES,
+        COUNTER_MAX
+    };
+
+    const uint64_t c_counterConfig[COUNTER_MAX] =
+    {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES,
+    };
+
+    // One event group per thread, opened on first use. The group leader is the cycle counter,
+    // so all four counters are scheduled onto the PMU together.
+    struct CounterGroup
+    {
+        int fd[COUNTER_MAX];
+        bool opened;
+        bool valid;
+
+        CounterGroup() noexcept : fd{ -1, -1, -1, -1 }, opened(false), valid(false) {}
+
+        ~CounterGroup()
+        {
+            for (size_t i = COUNTER_MAX; i > 0; --i)
+            {
+                if (fd[i - 1] >= 0)
+                    close(fd[i - 1]);
+            }
+        }
+
+        CounterGroup(const CounterGroup&) = delete;
+        CounterGroup& operator=(const CounterGroup&) = delete;
+
+        bool Open() noexcept
+        {
+            if (opened)
+                return valid;
+
+            opened = true;
+
+            for (size_t i = 0; i < COUNTER_MAX; ++i)
+            {
+                perf_event_attr attr = {};
+                attr.size = sizeof(attr);
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = c_counterConfig[i];
+                attr.disabled = (i == 0) ? 1 : 0;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+                // Calling thread only, on any CPU
+                const long ret = syscall(__NR_perf_event_open, &attr, 0, -1, (i == 0) ? -1 : fd[0], 0);
+                if (ret < 0)
+                    return false;
+
+                fd[i] = static_cast<int>(ret);
+            }
+
+            valid = true;
+            return true;
+        }
+    };
+
+    thread_local CounterGroup t_counterGroup;
+
+    struct GroupReadFormat
+    {
+        uint64_t nr;
+        uint64_t timeEnabled;
+        uint64_t timeRunning;
+        uint64_t values[COUNTER_MAX];
+    };
+}
+
+bool EnablePerfCounters() noexcept
+{
+    // Probe on the calling thread so an unsupported kernel or a restrictive
+    // perf_event_paranoid setting is reported once up front
+    s_countersEnabled = t_counterGroup.Open();
+    return s_countersEnabled;
+}
+
+//-------------------------------------------------------------------------------------
+PerfCounterScope::PerfCounterScope() noexcept : m_active(false)
+{
+    if (!s_countersEnabled)
+        return;
+
+    auto& group = t_counterGroup;
+    if (!group.Open())
+        return;
+
+    ioctl(group.fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    m_active = (ioctl(group.fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) == 0);
+}
+
+PerfCounterScope::~PerfCounterScope()
+{
+    if (m_active)
+    {
+        ioctl(t_counterGroup.fd[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+PerfCounterStats PerfCounterScope::GetStats() const noexcept
+{
+    PerfCounterStats stats = {};
+    if (!m_active)
+        return stats;
+
+    const int leader = t_counterGroup.fd[0];
+    ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    GroupReadFormat data = {};
+    const ssize_t bytes = read(leader, &data, sizeof(data));
+
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+    if (bytes != static_cast<ssize_t>(sizeof(data)) || data.nr != COUNTER_MAX || !data.timeRunning)
+        return stats;
+
+    // Scale up if the PMU was shared with other groups and multiplexed
+    double scale = 1.0;
+    if (data.timeRunning < data.timeEnabled)
+    {
+        scale = double(data.timeEnabled) / double(data.timeRunning);
+    }
+
+    stats.cycles = static_cast<uint64_t>(double(data.values[COUNTER_CYCLES]) * scale);
+    stats.instructions = static_cast<uint64_t>(double(data.values[COUNTER_INSTRUCTIONS]) * scale);
+    stats.cacheMisses = static_cast<uint64_t>(double(data.values[COUNTER_CACHE_MISSES]) * scale);
+    stats.branchMisses = static_cast<uint64_t>(double(data.values[COUNTER_BRANCH_MISSES]) * scale);
+    stats.valid = true;
+    return stats;
+}
+
+#else // !__linux__
+
+bool EnablePerfCounters() noexcept
+{
+    s_countersEnabled = false;
+    return false;
+}
+
+//-------------------------------------------------------------------------------------
+PerfCounterScope::PerfCounterScope() noexcept : m_active(false)
+{
+}
+
+PerfCounterScope::~PerfCounterScope()
+{
+}
+
+PerfCounterStats PerfCounterScope::GetStats() const noexcept
+{
+    PerfCounterStats stats = {};
+    return stats;
+}
+
+#endif // __linux__
+
+bool IsPerfCountersEnabled() noexcept
+{
+    return s_countersEnabled;
+}
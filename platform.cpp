@@ -0,0 +1,332 @@
+//-------------------------------------------------------------------------------------
+// platform.cpp
+//
+// Portable wrappers for the OS services used by the test suite
+//
+// Copyright (c) Microsoft Corporation.
+//-------------------------------------------------------------------------------------
+
+#include "directxtest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+#ifdef _WIN32
+#include <Psapi.h>
+#else
+#include <cwctype>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+
+//-------------------------------------------------------------------------------------
+uint64_t GetTickMS() noexcept
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+bool ExpandMediaPath(const wchar_t* fname, wchar_t* path, size_t count) noexcept
+{
+    if (!fname || !path || !count)
+        return false;
+
+#ifdef _WIN32
+    const DWORD ret = ExpandEnvironmentStringsW(fname, path, static_cast<DWORD>(std::min<size_t>(count, UINT32_MAX)));
+    return (ret > 0 && ret <= count);
+#else
+    std::wstring result;
+    for (const wchar_t* ptr = fname; *ptr; ++ptr)
+    {
+        if (*ptr == L'%')
+        {
+            const wchar_t* end = wcschr(ptr + 1, L'%');
+            if (end && end > ptr + 1)
+            {
+                std::string name;
+                for (const wchar_t* ch = ptr + 1; ch < end; ++ch)
+                {
+                    name += static_cast<char>(*ch);
+                }
+
+                const char* value = getenv(name.c_str());
+                if (value)
+                {
+                    wchar_t wvalue[MAX_PATH] = {};
+                    if (mbstowcs(wvalue, value, MAX_PATH) >= MAX_PATH)
+                        return false;
+
+                    result += wvalue;
+                    ptr = end;
+                    continue;
+                }
+            }
+
+            // Unknown variables are left in place, matching ExpandEnvironmentStrings
+            result += *ptr;
+        }
+        else if (*ptr == L'\\')
+        {
+            // Avoid doubling up when the variable already ends with a separator
+            if (result.empty() || result.back() != L'/')
+            {
+                result += L'/';
+            }
+        }
+        else
+        {
+            result += *ptr;
+        }
+    }
+
+    if (result.size() >= count)
+        return false;
+
+    wcscpy(path, result.c_str());
+    return true;
+#endif
+}
+
+
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void GetFileExtension(const wchar_t* path, wchar_t* ext, size_t count) noexcept
+{
+    if (!ext || !count)
+        return;
+
+    *ext = 0;
+
+    if (!path)
+        return;
+
+    const wchar_t* dot = wcsrchr(path, L'.');
+    if (!dot)
+        return;
+
+    if (wcschr(dot, L'/') || wcschr(dot, L'\\'))
+        return;
+
+    if (wcslen(dot) < count)
+    {
+        wcscpy(ext, dot);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+int CompareNoCase(const wchar_t* a, const wchar_t* b) noexcept
+{
+#ifdef _WIN32
+    return _wcsicmp(a, b);
+#else
+    return wcscasecmp(a, b);
+#endif
+}
+
+
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+FILE* OpenFile(const wchar_t* fileName, const char* mode) noexcept
+{
+    if (!fileName || !mode)
+        return nullptr;
+
+#ifdef _WIN32
+    wchar_t wmode[8] = {};
+    for (size_t j = 0; mode[j] && j < std::size(wmode) - 1; ++j)
+    {
+        wmode[j] = static_cast<wchar_t>(mode[j]);
+    }
+
+    FILE* fp = nullptr;
+    if (_wfopen_s(&fp, fileName, wmode) != 0)
+        return nullptr;
+
+    return fp;
+#else
+    char name[MAX_PATH] = {};
+    if (wcstombs(name, fileName, MAX_PATH) >= MAX_PATH)
+        return nullptr;
+
+    return fopen(name, mode);
+#endif
+}
+
+
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+bool MoveFileReplace(const wchar_t* source, const wchar_t* destination) noexcept
+{
+    if (!source || !destination)
+        return false;
+
+#ifdef _WIN32
+    return MoveFileExW(source, destination, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    char from[MAX_PATH] = {};
+    char to[MAX_PATH] = {};
+    if (wcstombs(from, source, MAX_PATH) >= MAX_PATH || wcstombs(to, destination, MAX_PATH) >= MAX_PATH)
+        return false;
+
+    return rename(from, to) == 0;
+#endif
+}
+
+
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+bool RemovePath(const wchar_t* path) noexcept
+{
+    if (!path)
+        return false;
+
+#ifdef _WIN32
+    const DWORD attributes = GetFileAttributesW(path);
+    if (attributes == INVALID_FILE_ATTRIBUTES)
+        return false;
+
+    return ((attributes & FILE_ATTRIBUTE_DIRECTORY) ? RemoveDirectoryW(path) : DeleteFileW(path)) != 0;
+#else
+    char name[MAX_PATH] = {};
+    if (wcstombs(name, path, MAX_PATH) >= MAX_PATH)
+        return false;
+
+    return remove(name) == 0;
+#endif
+}
+
+
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+bool CreateTempDirectory(wchar_t* path, size_t count) noexcept
+{
+    if (!path || !count)
+        return false;
+
+    *path = 0;
+
+#ifdef _WIN32
+    wchar_t temp[MAX_PATH] = {};
+    const DWORD len = GetTempPathW(MAX_PATH, temp);
+    if (!len || len >= MAX_PATH)
+        return false;
+
+    // GetTempFileNameW creates a unique file; the directory takes over its name
+    wchar_t name[MAX_PATH] = {};
+    if (!GetTempFileNameW(temp, L"uva", 0, name))
+        return false;
+
+    if (!DeleteFileW(name) || !CreateDirectoryW(name, nullptr))
+        return false;
+
+    const size_t nameLen = wcslen(name);
+    if (nameLen + 2 > count)
+    {
+        RemoveDirectoryW(name);
+        return false;
+    }
+
+    wcscpy_s(path, count, name);
+    wcscat_s(path, count, L"\\");
+    return true;
+#else
+    const char* temp = getenv("TMPDIR");
+    if (!temp || !*temp)
+        temp = "/tmp";
+
+    std::string name = temp;
+    if (name.back() != '/')
+        name += '/';
+    name += "uvaXXXXXX";
+
+    if (!mkdtemp(&name[0]))
+        return false;
+
+    name += '/';
+    const size_t len = mbstowcs(path, name.c_str(), count);
+    if (len == size_t(-1) || len >= count)
+    {
+        name.pop_back();
+        rmdir(name.c_str());
+        *path = 0;
+        return false;
+    }
+
+    return true;
+#endif
+}
+
+
+//-------------------------------------------------------------------------------------
+void GetThreadCPUTime(double& userMS, double& systemMS) noexcept
+{
+    userMS = systemMS = 0;
+
+#ifdef _WIN32
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime))
+    {
+        // 100ns units
+        userMS = double((uint64_t(userTime.dwHighDateTime) << 32) | userTime.dwLowDateTime) / 10000.0;
+        systemMS = double((uint64_t(kernelTime.dwHighDateTime) << 32) | kernelTime.dwLowDateTime) / 10000.0;
+    }
+#else
+    struct rusage usage = {};
+    if (!getrusage(RUSAGE_THREAD, &usage))
+    {
+        userMS = double(usage.ru_utime.tv_sec) * 1000.0 + double(usage.ru_utime.tv_usec) / 1000.0;
+        systemMS = double(usage.ru_stime.tv_sec) * 1000.0 + double(usage.ru_stime.tv_usec) / 1000.0;
+    }
+#endif
+}
+
+
+//-------------------------------------------------------------------------------------
+void GetProcessCPUTime(double& userMS, double& systemMS) noexcept
+{
+    userMS = systemMS = 0;
+
+#ifdef _WIN32
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+    {
+        // 100ns units
+        userMS = double((uint64_t(userTime.dwHighDateTime) << 32) | userTime.dwLowDateTime) / 10000.0;
+        systemMS = double((uint64_t(kernelTime.dwHighDateTime) << 32) | kernelTime.dwLowDateTime) / 10000.0;
+    }
+#else
+    struct rusage usage = {};
+    if (!getrusage(RUSAGE_SELF, &usage))
+    {
+        userMS = double(usage.ru_utime.tv_sec) * 1000.0 + double(usage.ru_utime.tv_usec) / 1000.0;
+        systemMS = double(usage.ru_stime.tv_sec) * 1000.0 + double(usage.ru_stime.tv_usec) / 1000.0;
+    }
+#endif
+}
+
+
+//-------------------------------------------------------------------------------------
+int64_t GetPeakRSS() noexcept
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc = {};
+    pmc.cb = sizeof(pmc);
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        return 0;
+
+    return static_cast<int64_t>(pmc.PeakWorkingSetSize);
+#else
+    struct rusage usage = {};
+    if (getrusage(RUSAGE_SELF, &usage))
+        return 0;
+
+    return static_cast<int64_t>(usage.ru_maxrss) * 1024; // kilobytes on Linux
+#endif
+}
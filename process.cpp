@@ -6,10 +6,25 @@
 
 #include "directxtest.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 #include "UVAtlas.h"
 #include "DirectXMesh.h"
 
+#include "MeshGenerator.h"
+#include "ShapesGenerator.h"
 #include "TestHelpers.h"
+#include "atlasmetrics.h"
+#include "atlasprogress.h"
+#include "boundedatlas.h"
+#include "parallelatlas.h"
+#include "sharedatlas.h"
 #include "WaveFrontReader.h"
 
 using namespace DirectX;
@@ -88,11 +103,12 @@ static inline bool VerifyVertices( const XMFLOAT3* pos, size_t nVerts, const UVA
 //-------------------------------------------------------------------------------------
 static HRESULT __cdecl UVAtlasCallback( float fPercentDone  )
 {
-    UNREFERENCED_PARAMETER(fPercentDone);
+    // The library's internal stages are only visible through the progress it reports
+    TraceCounter( "UVAtlas progress %", double( fPercentDone ) * 100.0 );
 
-    static ULONGLONG s_lastTick = 0;
+    static thread_local uint64_t s_lastTick = 0;
 
-    ULONGLONG tick = GetTickCount64();
+    uint64_t tick = GetTickMS();
 
     if ( ( tick - s_lastTick ) > 1000 )
     {
@@ -106,57 +122,235 @@ static HRESULT __cdecl UVAtlasCallback( float fPercentDone  )
 
 
 //-------------------------------------------------------------------------------------
-// MeshProcess (16-bit)
-bool Test08()
+static void PrintAllocationStats( const char* name, const AllocationStats& stats )
 {
-    bool success = true;
+    print( "\n\t%s: %llu allocations, %.1f KB allocated, %.1f KB peak live",
+           name,
+           static_cast<unsigned long long>( stats.allocations ),
+           double( stats.bytes ) / 1024.0,
+           double( stats.peakLiveBytes ) / 1024.0 );
+}
 
-    size_t ncount = 0;
-    size_t npass = 0;
 
-    for( size_t index=0; index < std::size(g_TestMedia16); ++index )
+//-------------------------------------------------------------------------------------
+// Runs UVAtlasCreate on prepared mesh data and verifies the results; threads other than 1
+// goes through UVAtlasCreateParallel instead
+template<typename index_t>
+static bool AtlasMesh( const wchar_t* szPath, const XMFLOAT3* pos, size_t nVerts, const index_t* indices, size_t nFaces, const uint32_t* adj, size_t threads = 1 )
+{
+    static_assert( sizeof(index_t) == 2 || sizeof(index_t) == 4, "Only 16-bit and 32-bit indices are supported" );
+
+    const DXGI_FORMAT indexFormat = ( sizeof(index_t) == 2 ) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+
+    HRESULT hr;
+    std::wstring msgs;
+
+    std::vector<UVAtlasVertex> vb;
+    std::vector<uint8_t> ib;
+    std::vector<uint32_t> facePart;
+    std::vector<uint32_t> remap;
+    float maxStretch = 0.f;
+    size_t numCharts = 0;
+    AllocationStats createAllocs;
     {
-        wchar_t szPath[MAX_PATH] = {};
-        DWORD ret = ExpandEnvironmentStringsW( g_TestMedia16[index].fname, szPath, MAX_PATH );
-        if ( !ret || ret > MAX_PATH )
+        AllocationScope allocScope;
+        TraceSpan span( "UVAtlasCreate" );
+        if ( threads == 1 )
         {
-            printe( "ERROR: ExpandEnvironmentStrings FAILED\n" );
-            return false;
+            hr = UVAtlasCreate( pos, nVerts, indices, indexFormat, nFaces,
+                                0, 0.f, 512, 512, 1.f,
+                                adj, nullptr, nullptr, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                                UVATLAS_DEFAULT, vb, ib, &facePart, &remap, &maxStretch, &numCharts );
+        }
+        else
+        {
+            hr = UVAtlasCreateParallel( pos, nVerts, indices, indexFormat, nFaces,
+                                        0, 0.f, 512, 512, 1.f,
+                                        adj, nullptr, nullptr, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                                        UVATLAS_DEFAULT, threads, vb, ib, &facePart, &remap, &maxStretch, &numCharts );
         }
+        createAllocs = allocScope.GetStats();
+    }
+    if (FAILED(hr))
+    {
+        printe( "\nERROR: create atlas failed (%08X)\n%S\n", static_cast<unsigned int>(hr), szPath );
+        return false;
+    }
 
-#ifdef _DEBUG
-        OutputDebugStringW(szPath);
-        OutputDebugStringA("\n");
-#endif
+    TraceSpan verifySpan( "Verify" );
 
-        wchar_t ext[_MAX_EXT];
-        _wsplitpath_s( szPath, nullptr, 0, nullptr, 0, nullptr, 0, ext, _MAX_EXT );
+    if ( vb.size() < nVerts
+         || (ib.size() / (sizeof(index_t)*3)) != nFaces
+         || facePart.size() != nFaces
+         || remap.size() != vb.size()
+         || !numCharts )
+    {
+        printe( "\nERROR: Unexpected results from create atlas:\n%S\n\tverts %zu\n\tfaces %zu (%zu bytes)\n\tface partitions %zu\n\tremap array %zu\n\tmaxStretch %f\n\tnumCharts %zu\n",
+                szPath, vb.size(), nFaces, ib.size(), facePart.size(), remap.size(), maxStretch, numCharts );
+        return false;
+    }
+
+    if ( !IsValidVertexRemap( reinterpret_cast<const index_t*>( ib.data() ), nFaces, remap.data(), vb.size(), true ) )
+    {
+        printe( "\nERROR: Vertex remap invalid from create atlas:\n%S\n", szPath );
+        return false;
+    }
 
-        ++ncount;
+    if ( !IsValidFacePartition( facePart.data(), nFaces, numCharts ) )
+    {
+        printe( "\nERROR: Face partition invalid from create atlas:\n%S\n", szPath );
+        return false;
+    }
 
-        std::unique_ptr<DX::WaveFrontReader<uint16_t>> mesh(new DX::WaveFrontReader<uint16_t>());
+    if ( !VerifyVertices( pos, nVerts, vb.data(), remap.data(), vb.size() ) )
+    {
+        printe( "\nERROR: Vertex data doesn't match remap:\n%S\n", szPath );
+        return false;
+    }
 
-        print( "*" );
+    hr = Validate( reinterpret_cast<const index_t*>( ib.data() ), nFaces, vb.size(), nullptr, VALIDATE_DEFAULT, &msgs );
+    if ( FAILED(hr) )
+    {
+        printe( "\nERROR: Invalid index buffer from create atlas (%08X):\n%S\n%S\n", static_cast<unsigned int>(hr), szPath, msgs.c_str() );
+        return false;
+    }
 
-        HRESULT hr;
-        if ( _wcsicmp( ext, L".vbo" ) == 0 )
+    verifySpan.End();
+
+    {
+        BenchExcludeScope benchExclude;
+        TraceSpan span( "Metrics" );
+
+        UVAtlasMetrics metrics;
+        hr = UVAtlasComputeMetrics( vb.data(), vb.size(), ib.data(), indexFormat, nFaces, facePart.data(), 512, 512, 1.f, metrics );
+        if ( FAILED(hr) )
         {
-            hr = mesh->LoadVBO( szPath );
+            printe( "\nERROR: atlas metrics failed (%08X)\n%S\n", static_cast<unsigned int>(hr), szPath );
+            return false;
         }
-        else
+
+        print( "\n\t%zu charts: coverage %.3f, %zu overlap texels, %zu gutter violations, texel density %.2f..%.2f",
+               numCharts, metrics.coverage, metrics.overlapTexels, metrics.gutterViolations, metrics.minTexelDensity, metrics.maxTexelDensity );
+    }
+
+    if ( IsAllocationTrackingEnabled() || IsTraceEnabled() )
+    {
+        // Repeat the work as separate partition and pack calls to attribute heap use and time to
+        // each. This is a second atlas on top of UVAtlasCreate, so it roughly doubles the case;
+        // the enclosing span keeps it apart from the UVAtlasCreate span in the trace.
+        TraceSpan repeatSpan( "Partition + pack (repeat)" );
+
+        std::vector<UVAtlasVertex> pvb;
+        std::vector<uint8_t> pib;
+        std::vector<uint32_t> partitionResultAdjacency;
+        AllocationStats partitionAllocs;
+        {
+            AllocationScope allocScope;
+            TraceSpan span( "UVAtlasPartition" );
+            hr = UVAtlasPartition( pos, nVerts, indices, indexFormat, nFaces,
+                                   0, 0.f,
+                                   adj, nullptr, nullptr, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                                   UVATLAS_DEFAULT, pvb, pib, nullptr, nullptr, partitionResultAdjacency, nullptr, nullptr );
+            partitionAllocs = allocScope.GetStats();
+        }
+        if ( FAILED(hr) )
         {
-            hr = mesh->Load( szPath );
+            printe( "\nERROR: partition failed (%08X)\n%S\n", static_cast<unsigned int>(hr), szPath );
+            return false;
         }
 
+        AllocationStats packAllocs;
+        {
+            AllocationScope allocScope;
+            TraceSpan span( "UVAtlasPack" );
+            hr = UVAtlasPack( pvb, pib, indexFormat, 512, 512, 1.f,
+                              partitionResultAdjacency, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY );
+            packAllocs = allocScope.GetStats();
+        }
+        if ( FAILED(hr) )
+        {
+            printe( "\nERROR: pack failed (%08X)\n%S\n", static_cast<unsigned int>(hr), szPath );
+            return false;
+        }
+
+        if ( IsAllocationTrackingEnabled() )
+        {
+            PrintAllocationStats( "UVAtlasCreate", createAllocs );
+            PrintAllocationStats( "UVAtlasPartition", partitionAllocs );
+            PrintAllocationStats( "UVAtlasPack", packAllocs );
+            print( "\n" );
+        }
+    }
+
+    return true;
+}
+
+
+//-------------------------------------------------------------------------------------
+// Media ready for atlasing: loaded, validated, and with adjacency. The first trusted request
+// for a file does that work and later ones in the run share the result, so the tests that
+// atlas the same media don't each repeat it. Untrusted requests always start from the file,
+// and tests only make trusted ones with --trusted-input.
+namespace
+{
+    template<typename index_t>
+    struct PreparedMesh
+    {
+        std::vector<index_t> indices;
+        std::vector<XMFLOAT3> positions;
+        std::vector<uint32_t> adjacency;
+
+        size_t FaceCount() const noexcept { return indices.size() / 3; }
+    };
+
+    // Wall time of each preparation step, in ms
+    struct PrepareTimings
+    {
+        double loadMS;
+        double validateMS;
+        double adjacencyMS;
+    };
+
+    template<typename index_t>
+    std::shared_ptr<const PreparedMesh<index_t>> PrepareMesh( const wchar_t* szPath, PrepareTimings* timings = nullptr )
+    {
+        using clock = std::chrono::steady_clock;
+        auto elapsedMS = []( clock::time_point start ) { return std::chrono::duration<double, std::milli>( clock::now() - start ).count(); };
+
+        wchar_t ext[_MAX_EXT];
+        GetFileExtension( szPath, ext, _MAX_EXT );
+
+        std::unique_ptr<DX::WaveFrontReader<index_t>> reader( new DX::WaveFrontReader<index_t>() );
+
+        HRESULT hr;
+        auto start = clock::now();
+        {
+            BenchExcludeScope benchExclude;
+            TraceSpan span( "Load" );
+
+            if ( CompareNoCase( ext, L".vbo" ) == 0 )
+            {
+                hr = reader->LoadVBO( szPath );
+            }
+            else
+            {
+                hr = reader->Load( szPath );
+            }
+        }
+        if ( timings )
+            timings->loadMS = elapsedMS( start );
+
         if ( FAILED(hr) )
         {
-            success = false;
             printe( "ERROR: Failed loading mesh data (%08X):\n%S\n", static_cast<unsigned int>(hr), szPath );
-            continue;
+            return nullptr;
         }
 
-        size_t nFaces = mesh->indices.size() / 3;
-        size_t nVerts = mesh->vertices.size();
+        auto mesh = std::make_shared<PreparedMesh<index_t>>();
+        mesh->indices.swap( reader->indices );
+
+        const size_t nFaces = mesh->FaceCount();
+        const size_t nVerts = reader->vertices.size();
 
 #ifdef _DEBUG
         char output[ 256 ] = {};
@@ -165,12 +359,17 @@ bool Test08()
 #endif
 
         std::wstring msgs;
-        hr = Validate( mesh->indices.data(), nFaces, nVerts, nullptr, VALIDATE_DEFAULT, &msgs );
+        start = clock::now();
+        {
+            TraceSpan span( "Validate" );
+            hr = Validate( mesh->indices.data(), nFaces, nVerts, nullptr, VALIDATE_DEFAULT, &msgs );
+        }
+        if ( timings )
+            timings->validateMS = elapsedMS( start );
         if ( FAILED(hr) )
         {
-            success = false;
             printe( "ERROR: Failed Validate mesh data (%08X):\n%S\n%S\n", static_cast<unsigned int>(hr), szPath, msgs.c_str() );
-            continue;
+            return nullptr;
         }
 
 #ifdef _DEBUG
@@ -181,228 +380,869 @@ bool Test08()
         }
 #endif
 
-        std::unique_ptr<XMFLOAT3[]> pos( new XMFLOAT3[ nVerts ] );
+        mesh->positions.resize( nVerts );
         for( size_t j = 0; j < nVerts; ++j )
-            pos[ j ] = mesh->vertices[ j ].position;
-
-        std::unique_ptr<uint32_t[]> adj( new uint32_t[ mesh->indices.size() ] );
-        memset( adj.get(), 0xff, sizeof(uint32_t) *  mesh->indices.size() );
+            mesh->positions[ j ] = reader->vertices[ j ].position;
 
-        hr = GenerateAdjacencyAndPointReps( mesh->indices.data(), nFaces, pos.get(), nVerts, 0.f, nullptr, adj.get() );
+        mesh->adjacency.resize( mesh->indices.size() );
+        start = clock::now();
+        {
+            TraceSpan span( "GenerateAdjacencyAndPointReps" );
+            hr = GenerateAdjacencyAndPointReps( mesh->indices.data(), nFaces, mesh->positions.data(), nVerts, 0.f, nullptr, mesh->adjacency.data() );
+        }
+        if ( timings )
+            timings->adjacencyMS = elapsedMS( start );
         if ( FAILED(hr) )
         {
-            success = false;
-            printe("ERROR: failed GenerateAdjacencyAndPointReps (%08X)\n:%S\n", static_cast<unsigned int>(hr), szPath );
-            continue;
+            printe( "ERROR: failed GenerateAdjacencyAndPointReps (%08X)\n:%S\n", static_cast<unsigned int>(hr), szPath );
+            return nullptr;
         }
 
-        std::vector<UVAtlasVertex> vb;
-        std::vector<uint8_t> ib;
-        std::vector<uint32_t> facePart;
-        std::vector<uint32_t> remap;
-        float maxStretch = 0.f;
-        size_t numCharts = 0;
-        hr = UVAtlasCreate( pos.get(), nVerts, mesh->indices.data(), DXGI_FORMAT_R16_UINT, nFaces,
-                            0, 0.f, 512, 512, 1.f,
-                            adj.get(), nullptr, nullptr, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
-                            UVATLAS_DEFAULT, vb, ib, &facePart, &remap, &maxStretch, &numCharts );
-        if (FAILED(hr))
-        {
-            printe( "\nERROR: create atlas failed (%08X)\n%S\n", static_cast<unsigned int>(hr), szPath );
-            success = false;
-        }
-        else if ( vb.size() < nVerts
-                  || (ib.size() / (sizeof(uint16_t)*3)) != nFaces
-                  || facePart.size() != nFaces
-                  || remap.size() != vb.size()
-                  || !numCharts )
+        return mesh;
+    }
+
+    template<typename index_t>
+    struct PreparedMeshCache
+    {
+        std::mutex mutex;
+        std::map<std::wstring, std::shared_ptr<const PreparedMesh<index_t>>> meshes;
+
+        static PreparedMeshCache& Get()
         {
-            printe( "\nERROR: Unexpected results from create atlas:\n%S\n\tverts %zu\n\tfaces %zu (%zu bytes)\n\tface partitions %zu\n\tremap array %zu\n\tmaxStretch %f\n\tnumCharts %zu\n",
-                    szPath, vb.size(), nFaces, ib.size(), facePart.size(), remap.size(), maxStretch, numCharts );
-            success = false;
+            static PreparedMeshCache s_cache;
+            return s_cache;
         }
-        else if ( !IsValidVertexRemap( reinterpret_cast<const uint16_t*>( ib.data() ), nFaces, remap.data(), vb.size(), true ) )
+    };
+
+    template<typename index_t>
+    std::shared_ptr<const PreparedMesh<index_t>> GetPreparedMesh( const wchar_t* szPath, bool trusted )
+    {
+        auto& cache = PreparedMeshCache<index_t>::Get();
+
+        if ( trusted )
         {
-            printe( "\nERROR: Vertex remap invalid from create atlas:\n%S\n", szPath );
-            success = false;
+            std::lock_guard<std::mutex> lock( cache.mutex );
+            auto it = cache.meshes.find( szPath );
+            if ( it != cache.meshes.end() )
+                return it->second;
         }
-        else if ( !IsValidFacePartition( facePart.data(), nFaces, numCharts ) )
+
+        auto mesh = PrepareMesh<index_t>( szPath );
+        if ( mesh && trusted )
         {
-            printe( "\nERROR: Face partition invalid from create atlas:\n%S\n", szPath );
-            success = false;
+            // Tests that raced to prepare the same file all use the first copy
+            std::lock_guard<std::mutex> lock( cache.mutex );
+            return cache.meshes.emplace( szPath, mesh ).first->second;
         }
-        else if ( !VerifyVertices( pos.get(), nVerts, vb.data(), remap.data(), vb.size() ) )
+
+        return mesh;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+template<typename index_t>
+static bool ProcessMesh( const wchar_t* fname )
+{
+    wchar_t szPath[MAX_PATH] = {};
+    if ( !ExpandMediaPath( fname, szPath, MAX_PATH ) )
+    {
+        printe( "ERROR: ExpandMediaPath FAILED\n" );
+        return false;
+    }
+
+#ifdef _DEBUG
+    OutputDebugStringW(szPath);
+    OutputDebugStringA("\n");
+#endif
+
+    auto mesh = GetPreparedMesh<index_t>( szPath, IsTrustedInputEnabled() );
+    if ( !mesh )
+        return false;
+
+    return AtlasMesh<index_t>( szPath, mesh->positions.data(), mesh->positions.size(), mesh->indices.data(), mesh->FaceCount(), mesh->adjacency.data() );
+}
+
+
+//-------------------------------------------------------------------------------------
+// Sub-test name is the media file name without the path
+static std::string GetMediaName( const wchar_t* fname )
+{
+    const wchar_t* name = wcsrchr( fname, L'\\' );
+    name = ( name ) ? ( name + 1 ) : fname;
+
+    std::string result;
+    for( ; *name; ++name )
+    {
+        result += ( *name < 0x80 ) ? static_cast<char>( *name ) : '?';
+    }
+    return result;
+}
+
+
+//-------------------------------------------------------------------------------------
+// MeshProcess (16-bit)
+void Test08( std::vector<SubTest>& tests )
+{
+    for( size_t index=0; index < std::size(g_TestMedia16); ++index )
+    {
+        const wchar_t* fname = g_TestMedia16[index].fname;
+        tests.emplace_back( GetMediaName( fname ), [fname]() { return ProcessMesh<uint16_t>( fname ); } );
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+// MeshProcess (32-bit)
+#ifndef BUILD_BVT_ONLY
+void Test11( std::vector<SubTest>& tests )
+{
+    for( size_t index=0; index < std::size(g_TestMedia32); ++index )
+    {
+        const wchar_t* fname = g_TestMedia32[index].fname;
+        tests.emplace_back( GetMediaName( fname ), [fname]() { return ProcessMesh<uint32_t>( fname ); } );
+    }
+}
+#endif
+
+
+//-------------------------------------------------------------------------------------
+// Procedural meshes that do not depend on the media path
+static bool ProcessGeneratedMesh( MeshGenerator<uint32_t>::Kind kind, size_t targetFaces, size_t threads = 1 )
+{
+    std::vector<uint32_t> indices;
+    std::vector<XMFLOAT3> pos;
+    std::vector<uint32_t> adj;
+    {
+        BenchExcludeScope benchExclude;
+        TraceSpan span( "Generate" );
+        MeshGenerator<uint32_t>::Create( kind, targetFaces, 0x1234u, indices, pos, adj );
+    }
+
+    const size_t nFaces = indices.size() / 3;
+
+    std::wstring msgs;
+    HRESULT hr = Validate( indices.data(), nFaces, pos.size(), adj.data(), VALIDATE_BACKFACING | VALIDATE_BOWTIES | VALIDATE_ASYMMETRIC_ADJ, &msgs );
+    if ( FAILED(hr) )
+    {
+        printe( "ERROR: Generated %s mesh failed Validate (%08X):\n%S\n", MeshGenerator<uint32_t>::GetKindName( kind ), static_cast<unsigned int>(hr), msgs.c_str() );
+        return false;
+    }
+
+    std::wstring name = L"generated ";
+    for( const char* ptr = MeshGenerator<uint32_t>::GetKindName( kind ); *ptr; ++ptr )
+    {
+        name += static_cast<wchar_t>( *ptr );
+    }
+
+    return AtlasMesh<uint32_t>( name.c_str(), pos.data(), pos.size(), indices.data(), nFaces, adj.data(), threads );
+}
+
+
+//-------------------------------------------------------------------------------------
+// MeshProcess (generated)
+void Test12( std::vector<SubTest>& tests )
+{
+    using Generator = MeshGenerator<uint32_t>;
+
+    for( int kind = 0; kind < Generator::KIND_MAX; ++kind )
+    {
+        const auto k = static_cast<Generator::Kind>( kind );
+        tests.emplace_back( Generator::GetKindName( k ), [k]() { return ProcessGeneratedMesh( k, 10000 ); } );
+    }
+
+    // Many small components, so this exercises the concurrent partition path
+    tests.emplace_back( "clutter (parallel)", []() { return ProcessGeneratedMesh( Generator::KIND_CLUTTER, 10000, 0 ); } );
+}
+
+
+//-------------------------------------------------------------------------------------
+// Status reporting overhead: the same UVAtlasCreate at several callback frequencies,
+// with a plain callback and with a UVAtlasProgress block, timed against a run with no
+// callback. Each variant is the median of c_progressRuns so the overhead is not noise.
+enum ProgressMode
+{
+    PROGRESS_NONE,
+    PROGRESS_CALLBACK,
+    PROGRESS_BLOCK,
+};
+
+static const size_t c_progressRuns = 5;
+
+static bool ProcessProgress( const wchar_t* szPath, const PreparedMesh<uint16_t>& mesh, ProgressMode mode, float frequency, double& elapsedMS, size_t& calls )
+{
+    calls = 0;
+    UVAtlasProgress progress;
+    std::function<HRESULT __cdecl(float)> callback;
+    switch( mode )
+    {
+    case PROGRESS_CALLBACK:
+        callback = [&calls]( float ) -> HRESULT
         {
-            printe( "\nERROR: Vertex data doesn't match remap:\n%S\n", szPath );
-            success = false;
-        }
-        else
+            ++calls;
+            return S_OK;
+        };
+        break;
+
+    case PROGRESS_BLOCK:
+        callback = UVAtlasProgressCallback( progress );
+        break;
+
+    default:
+        break;
+    }
+
+    // A watcher samples the block from another thread the way a job scheduler would
+    std::atomic<bool> done( false );
+    std::atomic<bool> monotonic( true );
+    std::thread watcher;
+    if ( mode == PROGRESS_BLOCK )
+    {
+        watcher = std::thread( [&]()
         {
-            hr = Validate( reinterpret_cast<const uint16_t*>( ib.data() ), nFaces, vb.size(), nullptr, VALIDATE_DEFAULT, &msgs );
-            if ( FAILED(hr) )
+            float last = 0.f;
+            while ( !done.load( std::memory_order_acquire ) )
             {
-                printe( "\nERROR: Invalid index buffer from create atlas (%08X):\n%S\n%S\n", static_cast<unsigned int>(hr), szPath, msgs.c_str() );
-                success = false;
+                const float current = progress.percentComplete.load( std::memory_order_relaxed );
+                if ( current < last )
+                    monotonic = false;
+                last = current;
+                std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
             }
+        } );
+    }
+
+    std::vector<UVAtlasVertex> vb;
+    std::vector<uint8_t> ib;
+    const auto start = std::chrono::steady_clock::now();
+    HRESULT hr = UVAtlasCreate( mesh.positions.data(), mesh.positions.size(), mesh.indices.data(), DXGI_FORMAT_R16_UINT, mesh.FaceCount(),
+                                0, 0.f, 512, 512, 1.f,
+                                mesh.adjacency.data(), nullptr, nullptr, callback, frequency,
+                                UVATLAS_DEFAULT, vb, ib, nullptr, nullptr, nullptr, nullptr );
+    elapsedMS = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+
+    done.store( true, std::memory_order_release );
+    if ( watcher.joinable() )
+        watcher.join();
+
+    if ( FAILED(hr) )
+    {
+        printe( "\nERROR: create atlas failed (%08X)\n%S\n", static_cast<unsigned int>(hr), szPath );
+        return false;
+    }
+
+    if ( mode == PROGRESS_BLOCK )
+    {
+        calls = progress.updates;
+
+        if ( !monotonic )
+        {
+            printe( "\nERROR: progress block went backwards\n%S\n", szPath );
+            return false;
         }
+    }
+
+    return true;
+}
 
-        ++npass;
+// Median time of c_progressRuns atlases with the given status reporting
+static bool TimeProgress( const wchar_t* szPath, const PreparedMesh<uint16_t>& mesh, ProgressMode mode, float frequency, double& medianMS, size_t& calls )
+{
+    double samples[c_progressRuns] = {};
+    for( size_t run = 0; run < c_progressRuns; ++run )
+    {
+        if ( !ProcessProgress( szPath, mesh, mode, frequency, samples[run], calls ) )
+            return false;
     }
 
-    print("\n%zu meshes tested, %zu meshes passed ", ncount, npass );
+    std::sort( std::begin(samples), std::end(samples) );
+    medianMS = samples[ c_progressRuns / 2 ];
+    return true;
+}
 
-    return success;
+
+//-------------------------------------------------------------------------------------
+// MeshProcess(progress)
+static bool ProcessProgressOverhead( const wchar_t* fname )
+{
+    wchar_t szPath[MAX_PATH] = {};
+    if ( !ExpandMediaPath( fname, szPath, MAX_PATH ) )
+    {
+        printe( "ERROR: ExpandMediaPath FAILED\n" );
+        return false;
+    }
+
+    std::shared_ptr<const PreparedMesh<uint16_t>> mesh;
+    {
+        BenchExcludeScope benchExclude;
+        mesh = GetPreparedMesh<uint16_t>( szPath, IsTrustedInputEnabled() );
+    }
+    if ( !mesh )
+        return false;
+
+    double baseMS = 0;
+    size_t calls = 0;
+    if ( !TimeProgress( szPath, *mesh, PROGRESS_NONE, UVATLAS_DEFAULT_CALLBACK_FREQUENCY, baseMS, calls ) )
+        return false;
+
+    print( "\n\tno callback: %.2f ms (median of %zu)", baseMS, c_progressRuns );
+
+    const float frequencies[] = { 0.1f, 0.01f, 0.001f, 0.0001f };
+    for( auto frequency : frequencies )
+    {
+        static const struct { ProgressMode mode; const char* name; } s_modes[] =
+        {
+            { PROGRESS_CALLBACK, "callback" },
+            { PROGRESS_BLOCK, "progress block" },
+        };
+
+        for( const auto& it : s_modes )
+        {
+            double medianMS = 0;
+            if ( !TimeProgress( szPath, *mesh, it.mode, frequency, medianMS, calls ) )
+                return false;
+
+            print( "\n\t%s %g: %.2f ms, %zu status reports, overhead %+.2f ms (%+.1f%%)",
+                   it.name, double( frequency ), medianMS, calls, medianMS - baseMS,
+                   ( baseMS > 0 ) ? ( medianMS / baseMS - 1.0 ) * 100.0 : 0.0 );
+        }
+    }
+
+    return true;
 }
 
+void Test16( std::vector<SubTest>& tests )
+{
+    tests.emplace_back( "teapot", []() { return ProcessProgressOverhead( MESH_MEDIA_PATH L"teapot._obj" ); } );
+}
 
 
 //-------------------------------------------------------------------------------------
-// MeshProcess (32-bit)
-#ifndef BUILD_BVT_ONLY
-bool Test11()
+// Shared atlas for several props
+namespace
 {
-    bool success = true;
+    struct PartitionedMesh
+    {
+        const char* name;
+        std::vector<XMFLOAT3> positions;
+        std::vector<UVAtlasVertex> vb;
+        std::vector<uint8_t> ib;
+        std::vector<uint32_t> facePart;
+        std::vector<uint32_t> partitionAdj;
+    };
+
+    bool PartitionProp( const char* name, const std::vector<uint16_t>& indices, std::vector<XMFLOAT3>&& positions, const std::vector<uint32_t>& adj, PartitionedMesh& mesh )
+    {
+        mesh.name = name;
+        mesh.positions = std::move( positions );
+
+        const size_t nFaces = indices.size() / 3;
+
+        HRESULT hr = UVAtlasPartition( mesh.positions.data(), mesh.positions.size(), indices.data(), DXGI_FORMAT_R16_UINT, nFaces,
+                               0, 0.f,
+                               adj.data(), nullptr, nullptr, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                               UVATLAS_DEFAULT, mesh.vb, mesh.ib, &mesh.facePart, nullptr, mesh.partitionAdj, nullptr, nullptr );
+        if ( FAILED(hr) )
+        {
+            printe( "\nERROR: partition failed for %s (%08X)\n", name, static_cast<unsigned int>(hr) );
+            return false;
+        }
 
-    size_t ncount = 0;
-    size_t npass = 0;
+        return true;
+    }
 
-    for (size_t index = 0; index < std::size(g_TestMedia32); ++index)
+    bool LoadProp( const wchar_t* fname, const char* name, PartitionedMesh& mesh )
     {
         wchar_t szPath[MAX_PATH] = {};
-        DWORD ret = ExpandEnvironmentStringsW(g_TestMedia32[index].fname, szPath, MAX_PATH);
-        if (!ret || ret > MAX_PATH)
+        if ( !ExpandMediaPath( fname, szPath, MAX_PATH ) )
         {
-            printe("ERROR: ExpandEnvironmentStrings FAILED\n");
+            printe( "ERROR: ExpandMediaPath FAILED\n" );
             return false;
         }
 
-#ifdef _DEBUG
-        OutputDebugStringW(szPath);
-        OutputDebugStringA("\n");
-#endif
-
-        wchar_t ext[_MAX_EXT];
-        _wsplitpath_s(szPath, nullptr, 0, nullptr, 0, nullptr, 0, ext, _MAX_EXT);
+        auto prepared = GetPreparedMesh<uint16_t>( szPath, IsTrustedInputEnabled() );
+        if ( !prepared )
+            return false;
 
-        ++ncount;
+        std::vector<XMFLOAT3> positions( prepared->positions );
+        return PartitionProp( name, prepared->indices, std::move( positions ), prepared->adjacency, mesh );
+    }
 
-        std::unique_ptr<DX::WaveFrontReader<uint32_t>> mesh(new DX::WaveFrontReader<uint32_t>());
+    template<typename Create>
+    bool CreateProp( const char* name, Create create, PartitionedMesh& mesh )
+    {
+        std::vector<uint16_t> indices;
+        std::vector<ShapesGenerator<uint16_t>::Vertex> vertices;
+        create( indices, vertices );
 
-        print("*");
+        std::vector<XMFLOAT3> positions( vertices.size() );
+        for( size_t j = 0; j < positions.size(); ++j )
+            positions[ j ] = vertices[ j ].position;
 
-        HRESULT hr;
-        if (_wcsicmp(ext, L".vbo") == 0)
+        // ShapesGenerator duplicates vertices along texture seams; weld them for adjacency
+        std::vector<uint32_t> adj( indices.size() );
+        const HRESULT hr = GenerateAdjacencyAndPointReps( indices.data(), indices.size() / 3, positions.data(), positions.size(), 1e-5f, nullptr, adj.data() );
+        if ( FAILED(hr) )
         {
-            hr = mesh->LoadVBO(szPath);
+            printe( "ERROR: failed GenerateAdjacencyAndPointReps for %s (%08X)\n", name, static_cast<unsigned int>(hr) );
+            return false;
         }
-        else
+
+        return PartitionProp( name, indices, std::move( positions ), adj, mesh );
+    }
+}
+
+// MeshProcess(shared atlas)
+bool Test18()
+{
+    using Shapes = ShapesGenerator<uint16_t>;
+
+    std::vector<PartitionedMesh> props( 6 );
+    {
+        BenchExcludeScope benchExclude;
+
+        if ( !LoadProp( MESH_MEDIA_PATH L"cup._obj", "cup", props[0] )
+             || !LoadProp( MESH_MEDIA_PATH L"teapot._obj", "teapot", props[1] )
+             || !CreateProp( "cube", []( std::vector<uint16_t>& ib, std::vector<Shapes::Vertex>& vb ) { Shapes::CreateCube( ib, vb, 1.f, false ); }, props[2] )
+             || !CreateProp( "sphere", []( std::vector<uint16_t>& ib, std::vector<Shapes::Vertex>& vb ) { Shapes::CreateSphere( ib, vb, 1.f, 16, false ); }, props[3] )
+             || !CreateProp( "cylinder", []( std::vector<uint16_t>& ib, std::vector<Shapes::Vertex>& vb ) { Shapes::CreateCylinder( ib, vb, 1.f, 1.f, 32, false ); }, props[4] )
+             || !CreateProp( "torus", []( std::vector<uint16_t>& ib, std::vector<Shapes::Vertex>& vb ) { Shapes::CreateTorus( ib, vb, 1.f, 0.333f, 32, false ); }, props[5] ) )
         {
-            hr = mesh->Load(szPath);
+            return false;
         }
+    }
+
+    std::vector<UVAtlasSharedMesh> meshes;
+    for( const auto& prop : props )
+    {
+        meshes.push_back( UVAtlasSharedMesh{ &prop.vb, &prop.ib, &prop.partitionAdj } );
+    }
+
+    const size_t width = 1024;
+    const size_t height = 1024;
+
+    std::vector<std::vector<UVAtlasVertex>> vbs;
+    std::vector<UVAtlasChartPlacement> charts;
+    HRESULT hr = UVAtlasPackShared( meshes.data(), meshes.size(), DXGI_FORMAT_R16_UINT, width, height, 2.f,
+                                    UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY, vbs, &charts );
+    if ( FAILED(hr) )
+    {
+        printe( "\nERROR: shared atlas pack failed (%08X)\n", static_cast<unsigned int>(hr) );
+        return false;
+    }
 
-        if (FAILED(hr))
+    bool success = true;
+
+    if ( vbs.size() != props.size() )
+    {
+        printe( "\nERROR: shared atlas pack returned %zu vertex buffers for %zu meshes\n", vbs.size(), props.size() );
+        return false;
+    }
+
+    // Geometry and vertex order are untouched; only UVs move into the shared atlas
+    std::vector<size_t> chartsPerMesh( props.size(), 0 );
+    for( const auto& chart : charts )
+    {
+        if ( chart.mesh >= props.size() || chart.size.x < 0.f || chart.size.y < 0.f
+             || chart.offset.x < 0.f || chart.offset.y < 0.f || chart.offset.x + chart.size.x > 1.f || chart.offset.y + chart.size.y > 1.f )
         {
+            printe( "\nERROR: invalid chart placement (mesh %u, face %u, offset %f %f, size %f %f)\n",
+                    chart.mesh, chart.firstFace, chart.offset.x, chart.offset.y, chart.size.x, chart.size.y );
             success = false;
-            printe("ERROR: Failed loading mesh data (%08X):\n%S\n", static_cast<unsigned int>(hr), szPath);
             continue;
         }
+        ++chartsPerMesh[ chart.mesh ];
+    }
 
-        size_t nFaces = mesh->indices.size() / 3;
-        size_t nVerts = mesh->vertices.size();
-
-#ifdef _DEBUG
-        char output[256] = {};
-        sprintf_s(output, "INFO: %zu verts, %zu faces\n", nVerts, nFaces);
-        OutputDebugStringA(output);
-#endif
-
-        std::wstring msgs;
-        hr = Validate(mesh->indices.data(), nFaces, nVerts, nullptr, VALIDATE_DEFAULT, &msgs);
-        if (FAILED(hr))
+    for( size_t j = 0; j < props.size(); ++j )
+    {
+        const auto& prop = props[j];
+        if ( vbs[j].size() != prop.vb.size() || !chartsPerMesh[j] )
         {
+            printe( "\nERROR: shared atlas [%s] has %zu verts (expected %zu) and %zu charts\n", prop.name, vbs[j].size(), prop.vb.size(), chartsPerMesh[j] );
             success = false;
-            printe("ERROR: Failed Validate mesh data (%08X):\n%S\n%S\n", static_cast<unsigned int>(hr), szPath, msgs.c_str());
             continue;
         }
 
-#ifdef _DEBUG
-        hr = Validate(mesh->indices.data(), nFaces, nVerts, nullptr, VALIDATE_DEGENERATE, &msgs);
-        if (FAILED(hr))
+        for( size_t v = 0; v < vbs[j].size(); ++v )
         {
-            OutputDebugStringW(msgs.c_str());
+            const auto& out = vbs[j][v];
+            if ( memcmp( &out.pos, &prop.vb[v].pos, sizeof(XMFLOAT3) ) != 0
+                 || out.uv.x < 0.f || out.uv.x > 1.f || out.uv.y < 0.f || out.uv.y > 1.f )
+            {
+                printe( "\nERROR: shared atlas [%s] vertex %zu is wrong (uv %f %f)\n", prop.name, v, out.uv.x, out.uv.y );
+                success = false;
+                break;
+            }
         }
-#endif
+    }
 
-        std::unique_ptr<XMFLOAT3[]> pos(new XMFLOAT3[nVerts]);
-        for (size_t j = 0; j < nVerts; ++j)
-            pos[j] = mesh->vertices[j].position;
+    // Measure the shared atlas as one mesh, with chart ids made unique across meshes, so an
+    // overlap between two charts of the same mesh counts as well as one between meshes
+    std::vector<UVAtlasVertex> combinedVB;
+    std::vector<uint32_t> combinedIB;
+    std::vector<uint32_t> combinedFacePart;
+    uint32_t chartBase = 0;
+    for( size_t j = 0; j < props.size(); ++j )
+    {
+        const uint32_t vbBase = static_cast<uint32_t>( combinedVB.size() );
+        combinedVB.insert( combinedVB.end(), vbs[j].cbegin(), vbs[j].cend() );
 
-        std::unique_ptr<uint32_t[]> adj(new uint32_t[mesh->indices.size()]);
-        memset(adj.get(), 0xff, sizeof(uint32_t) * mesh->indices.size());
+        auto ib = reinterpret_cast<const uint16_t*>( props[j].ib.data() );
+        const size_t nIndices = props[j].ib.size() / sizeof(uint16_t);
+        for( size_t k = 0; k < nIndices; ++k )
+            combinedIB.push_back( vbBase + ib[k] );
 
-        hr = GenerateAdjacencyAndPointReps(mesh->indices.data(), nFaces, pos.get(), nVerts, 0.f, nullptr, adj.get());
-        if (FAILED(hr))
+        uint32_t meshCharts = 0;
+        for( auto chart : props[j].facePart )
         {
-            success = false;
-            printe("ERROR: failed GenerateAdjacencyAndPointReps (%08X)\n:%S\n", static_cast<unsigned int>(hr), szPath);
-            continue;
+            combinedFacePart.push_back( chartBase + chart );
+            meshCharts = std::max( meshCharts, chart + 1 );
         }
+        chartBase += meshCharts;
+    }
 
-        std::vector<UVAtlasVertex> vb;
-        std::vector<uint8_t> ib;
-        std::vector<uint32_t> facePart;
-        std::vector<uint32_t> remap;
-        float maxStretch = 0.f;
-        size_t numCharts = 0;
-        hr = UVAtlasCreate(pos.get(), nVerts, mesh->indices.data(), DXGI_FORMAT_R32_UINT, nFaces,
-            0, 0.f, 512, 512, 1.f,
-            adj.get(), nullptr, nullptr, UVAtlasCallback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
-            UVATLAS_DEFAULT, vb, ib, &facePart, &remap, &maxStretch, &numCharts);
-        if (FAILED(hr))
-        {
-            printe("\nERROR: create atlas failed (%08X)\n%S\n", static_cast<unsigned int>(hr), szPath);
+    {
+        BenchExcludeScope benchExclude;
+
+        UVAtlasMetrics metrics;
+        hr = UVAtlasComputeMetrics( combinedVB.data(), combinedVB.size(), combinedIB.data(), DXGI_FORMAT_R32_UINT, combinedFacePart.size(),
+                                    combinedFacePart.data(), width, height, 2.f, metrics );
+        if ( FAILED(hr) )
+        {
+            printe( "\nERROR: shared atlas metrics failed (%08X)\n", static_cast<unsigned int>(hr) );
             success = false;
         }
-        else if (vb.size() < nVerts
-            || (ib.size() / (sizeof(uint32_t) * 3)) != nFaces
-            || facePart.size() != nFaces
-            || remap.size() != vb.size()
-            || !numCharts)
+        else
         {
-            printe("\nERROR: Unexpected results from create atlas:\n%S\n\tverts %zu\n\tfaces %zu (%zu bytes)\n\tface partitions %zu\n\tremap array %zu\n\tmaxStretch %f\n\tnumCharts %zu\n",
-                szPath, vb.size(), nFaces, ib.size(), facePart.size(), remap.size(), maxStretch, numCharts);
-            success = false;
+            print( "\n\tcoverage %.3f, %zu overlap texels, %zu gutter violations", metrics.coverage, metrics.overlapTexels, metrics.gutterViolations );
+
+            if ( metrics.overlapTexels )
+            {
+                printe( "\nERROR: shared atlas has %zu texels covered by more than one chart\n", metrics.overlapTexels );
+                success = false;
+            }
         }
-        else if (!IsValidVertexRemap(reinterpret_cast<const uint32_t*>(ib.data()), nFaces, remap.data(), vb.size(), true))
+    }
+
+    print( "\n\t%zu meshes, %zu charts", props.size(), charts.size() );
+
+    return success;
+}
+
+
+//-------------------------------------------------------------------------------------
+// Generated mesh through UVAtlasCreateBounded. Checks the outputs and that the budget held
+// through the partition phase, sampled when the call reports UVATLAS_BOUNDED_PACK_PROGRESS;
+// the final pack is outside the budget and only reported. Every build checks the rise in
+// process peak RSS, and TRACK_ALLOCATIONS builds also check tracked heap use. Peak RSS
+// before the call may be an earlier test's high-water mark rather than what is resident,
+// so the RSS check can miss an overrun but never reports one that didn't happen. With
+// rssCap the call gets whatever the cap leaves after the mesh is generated. unusedFace
+// marks one face in the middle of the mesh unused (-1 indices, no neighbors).
+static bool ProcessBoundedMesh( MeshGenerator<uint32_t>::Kind kind, size_t targetFaces, size_t memoryBudget, size_t atlasSize, int64_t rssCap, bool unusedFace = false )
+{
+    const char* kindName = MeshGenerator<uint32_t>::GetKindName( kind );
+
+    std::vector<uint32_t> indices;
+    std::vector<XMFLOAT3> pos;
+    std::vector<uint32_t> adj;
+    {
+        BenchExcludeScope benchExclude;
+        TraceSpan span( "Generate" );
+        MeshGenerator<uint32_t>::Create( kind, targetFaces, 0x1234u, indices, pos, adj );
+    }
+
+    const size_t nFaces = indices.size() / 3;
+    const size_t nVerts = pos.size();
+
+    const size_t unused = nFaces / 2;
+    if ( unusedFace )
+    {
+        for( size_t k = 0; k < 3; ++k )
         {
-            printe("\nERROR: Vertex remap invalid from create atlas:\n%S\n", szPath);
-            success = false;
+            const uint32_t neighbor = adj[ unused * 3 + k ];
+            if ( neighbor != uint32_t(-1) )
+            {
+                for( size_t j = 0; j < 3; ++j )
+                {
+                    if ( adj[ neighbor * 3 + j ] == unused )
+                        adj[ neighbor * 3 + j ] = uint32_t(-1);
+                }
+            }
+
+            adj[ unused * 3 + k ] = uint32_t(-1);
+            indices[ unused * 3 + k ] = uint32_t(-1);
         }
-        else if (!IsValidFacePartition(facePart.data(), nFaces, numCharts))
+    }
+
+    // Peak RSS only rises, so it bounds what is resident now
+    const int64_t peakBefore = GetPeakRSS();
+    if ( rssCap > 0 )
+    {
+        if ( peakBefore <= 0 || peakBefore >= rssCap )
         {
-            printe("\nERROR: Face partition invalid from create atlas:\n%S\n", szPath);
-            success = false;
+            printe( "\nERROR: peak RSS is %.1f MB before the call, so a %.1f MB cap can't be checked; run this test on its own\n",
+                    double( peakBefore ) / ( 1024.0 * 1024.0 ), double( rssCap ) / ( 1024.0 * 1024.0 ) );
+            return false;
+        }
+
+        memoryBudget = size_t( rssCap - peakBefore );
+    }
+
+    std::vector<UVAtlasVertex> vb;
+    std::vector<uint8_t> ib;
+    std::vector<uint32_t> facePart;
+    std::vector<uint32_t> remap;
+    float maxStretch = 0.f;
+    size_t numCharts = 0;
+    size_t numGroups = 0;
+    AllocationStats allocs = {};
+    AllocationStats partitionAllocs = {};
+    int64_t partitionPeakRSS = 0;
+    bool partitionDone = false;
+
+    const auto start = std::chrono::steady_clock::now();
+    HRESULT hr;
+    {
+        AllocationScope allocScope;
+        TraceSpan span( "UVAtlasCreateBounded" );
+
+        auto callback = [&]( float percentComplete ) -> HRESULT
+        {
+            if ( !partitionDone && percentComplete >= UVATLAS_BOUNDED_PACK_PROGRESS )
+            {
+                partitionDone = true;
+                partitionPeakRSS = GetPeakRSS();
+                partitionAllocs = allocScope.GetStats();
+            }
+            return UVAtlasCallback( percentComplete );
+        };
+
+        hr = UVAtlasCreateBounded( pos.data(), nVerts, indices.data(), DXGI_FORMAT_R32_UINT, nFaces,
+                                   0, 0.f, atlasSize, atlasSize, 2.f,
+                                   adj.data(), nullptr, nullptr, callback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                                   UVATLAS_DEFAULT, memoryBudget, vb, ib, &facePart, &remap, &maxStretch, &numCharts, &numGroups );
+        allocs = allocScope.GetStats();
+    }
+    const double elapsedMS = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+    const int64_t peakAfter = GetPeakRSS();
+
+    if ( FAILED(hr) )
+    {
+        printe( "\nERROR: bounded create atlas [%s, %zu faces, %.1f MB] failed (%08X)\n",
+                kindName, nFaces, double( memoryBudget ) / ( 1024.0 * 1024.0 ), static_cast<unsigned int>(hr) );
+        return false;
+    }
+
+    print( "\n\t%zu faces in %zu groups under %.1f MB: %zu charts, stretch %f, %.0f ms, peak RSS %.1f MB partitioning, %.1f MB with the pack",
+           nFaces, numGroups, double( memoryBudget ) / ( 1024.0 * 1024.0 ), numCharts, maxStretch, elapsedMS,
+           double( partitionPeakRSS ) / ( 1024.0 * 1024.0 ), double( peakAfter ) / ( 1024.0 * 1024.0 ) );
+
+    if ( numGroups < 2 )
+    {
+        printe( "\nERROR: bounded create atlas [%s] didn't split the mesh under its budget\n", kindName );
+        return false;
+    }
+
+    if ( !partitionDone )
+    {
+        printe( "\nERROR: bounded create atlas [%s] never reported the end of its partition phase\n", kindName );
+        return false;
+    }
+
+    if ( vb.size() < nVerts
+         || ( ib.size() / ( sizeof(uint32_t) * 3 ) ) != nFaces
+         || facePart.size() != nFaces
+         || remap.size() != vb.size()
+         || !numCharts )
+    {
+        printe( "\nERROR: Unexpected results from bounded create atlas [%s]:\n\tverts %zu\n\tfaces %zu (%zu bytes)\n\tface partitions %zu\n\tremap array %zu\n\tnumCharts %zu\n",
+                kindName, vb.size(), nFaces, ib.size(), facePart.size(), remap.size(), numCharts );
+        return false;
+    }
+
+    if ( unusedFace )
+    {
+        auto outIndices = reinterpret_cast<const uint32_t*>( ib.data() );
+        if ( outIndices[ unused * 3 ] != uint32_t(-1) || outIndices[ unused * 3 + 1 ] != uint32_t(-1) || outIndices[ unused * 3 + 2 ] != uint32_t(-1) )
+        {
+            printe( "\nERROR: bounded create atlas [%s] lost the unused face marker: %u %u %u\n",
+                    kindName, outIndices[ unused * 3 ], outIndices[ unused * 3 + 1 ], outIndices[ unused * 3 + 2 ] );
+            return false;
         }
-        else if (!VerifyVertices(pos.get(), nVerts, vb.data(), remap.data(), vb.size()))
+    }
+
+    if ( !IsValidVertexRemap( reinterpret_cast<const uint32_t*>( ib.data() ), nFaces, remap.data(), vb.size(), true ) )
+    {
+        printe( "\nERROR: Vertex remap invalid from bounded create atlas [%s]\n", kindName );
+        return false;
+    }
+
+    if ( !IsValidFacePartition( facePart.data(), nFaces, numCharts ) )
+    {
+        printe( "\nERROR: Face partition invalid from bounded create atlas [%s]\n", kindName );
+        return false;
+    }
+
+    if ( !VerifyVertices( pos.data(), nVerts, vb.data(), remap.data(), vb.size() ) )
+    {
+        printe( "\nERROR: Vertex data doesn't match remap from bounded create atlas [%s]\n", kindName );
+        return false;
+    }
+
+    bool success = true;
+
+    if ( IsAllocationTrackingEnabled() )
+    {
+        PrintAllocationStats( "UVAtlasCreateBounded", allocs );
+        print( "\n\t%.1f MB live partitioning, %.1f MB with the pack",
+               double( partitionAllocs.peakLiveBytes ) / ( 1024.0 * 1024.0 ), double( allocs.peakLiveBytes ) / ( 1024.0 * 1024.0 ) );
+        if ( partitionAllocs.peakLiveBytes > memoryBudget )
         {
-            printe("\nERROR: Vertex data doesn't match remap:\n%S\n", szPath);
+            printe( "\nERROR: bounded create atlas [%s] peaked at %.1f MB live partitioning, over its %.1f MB budget\n",
+                    kindName, double( partitionAllocs.peakLiveBytes ) / ( 1024.0 * 1024.0 ), double( memoryBudget ) / ( 1024.0 * 1024.0 ) );
             success = false;
         }
-        else
+
+        // Calibrates UVATLAS_BOUNDED_PARTITION_BYTES_PER_FACE: UVAtlasPartition over the whole
+        // mesh, plus the input copies and lookups CreateBounded makes for a group. Skipped
+        // under an RSS cap, where a whole-mesh partition is what the cap is there to avoid.
+        if ( rssCap <= 0 )
         {
-            hr = Validate(reinterpret_cast<const uint32_t*>(ib.data()), nFaces, vb.size(), nullptr, VALIDATE_DEFAULT, &msgs);
-            if (FAILED(hr))
+            AllocationStats wholeAllocs = {};
+            {
+                AllocationScope scope;
+                std::vector<UVAtlasVertex> partVB;
+                std::vector<uint8_t> partIB;
+                std::vector<uint32_t> partFacePart;
+                std::vector<uint32_t> partRemap;
+                std::vector<uint32_t> partAdj;
+                hr = UVAtlasPartition( pos.data(), nVerts, indices.data(), DXGI_FORMAT_R32_UINT, nFaces,
+                                       0, 0.f,
+                                       adj.data(), nullptr, nullptr, nullptr, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                                       UVATLAS_DEFAULT, partVB, partIB, &partFacePart, &partRemap, partAdj, nullptr, nullptr );
+                wholeAllocs = scope.GetStats();
+            }
+
+            if ( FAILED(hr) )
             {
-                printe("\nERROR: Invalid index buffer from create atlas (%08X):\n%S\n%S\n", static_cast<unsigned int>(hr), szPath, msgs.c_str());
+                printe( "\nERROR: partition [%s] for calibration failed (%08X)\n", kindName, static_cast<unsigned int>(hr) );
                 success = false;
             }
+            else
+            {
+                const size_t copyBytes = nVerts * ( sizeof(XMFLOAT3) + sizeof(uint32_t) ) + nFaces * 3 * sizeof(uint32_t) * 2 + nFaces * sizeof(uint32_t);
+                const double bytesPerFace = double( wholeAllocs.peakLiveBytes + copyBytes ) / double( nFaces );
+                print( "\n\tpartition peak %.0f bytes per face (estimate %zu)", bytesPerFace, UVATLAS_BOUNDED_PARTITION_BYTES_PER_FACE );
+                if ( bytesPerFace > double( UVATLAS_BOUNDED_PARTITION_BYTES_PER_FACE ) )
+                {
+                    printe( "\nERROR: partition [%s] peaked at %.0f bytes per face, over the %zu byte estimate that sizes bounded groups\n",
+                            kindName, bytesPerFace, UVATLAS_BOUNDED_PARTITION_BYTES_PER_FACE );
+                    success = false;
+                }
+            }
         }
-
-        ++npass;
     }
 
-    print("\n%zu meshes tested, %zu meshes passed ", ncount, npass);
+    if ( peakBefore > 0 && partitionPeakRSS - peakBefore > int64_t( memoryBudget ) )
+    {
+        if ( rssCap > 0 )
+        {
+            printe( "\nERROR: bounded create atlas [%s] took peak RSS to %.1f MB partitioning, over the %.1f MB cap\n",
+                    kindName, double( partitionPeakRSS ) / ( 1024.0 * 1024.0 ), double( rssCap ) / ( 1024.0 * 1024.0 ) );
+        }
+        else
+        {
+            printe( "\nERROR: bounded create atlas [%s] raised peak RSS by %.1f MB partitioning, over its %.1f MB budget\n",
+                    kindName, double( partitionPeakRSS - peakBefore ) / ( 1024.0 * 1024.0 ), double( memoryBudget ) / ( 1024.0 * 1024.0 ) );
+        }
+        success = false;
+    }
 
     return success;
 }
+
+
+//-------------------------------------------------------------------------------------
+// MeshProcess (bounded memory)
+void Test23( std::vector<SubTest>& tests )
+{
+    using Generator = MeshGenerator<uint32_t>;
+
+    // Budgets small enough to force a few groups; clutter also bundles components per group
+    tests.emplace_back( "terrain", []() { return ProcessBoundedMesh( Generator::KIND_TERRAIN, 40000, 32 * 1024 * 1024, 1024, 0 ); } );
+    tests.emplace_back( "clutter", []() { return ProcessBoundedMesh( Generator::KIND_CLUTTER, 40000, 32 * 1024 * 1024, 1024, 0 ); } );
+    tests.emplace_back( "terrain (unused face)", []() { return ProcessBoundedMesh( Generator::KIND_TERRAIN, 40000, 32 * 1024 * 1024, 1024, 0, true ); } );
+
+    // CTest runs this one on its own as uvatlas_large, where peak RSS starts low
+    if ( AreLargeTestsEnabled() )
+    {
+        // A photogrammetry-sized mesh with the process capped at 2 GB through partitioning
+        tests.emplace_back( "terrain 10M", []() { return ProcessBoundedMesh( Generator::KIND_TERRAIN, 10000000, 0, 4096, int64_t( 2 ) << 30 ); } );
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+// What --trusted-input saves on one media file: each test that reuses a shared mesh skips
+// loading, validating and deriving adjacency, so those steps are timed here. With
+// --trusted-input the shared mesh is also checked against a fresh one, so a test that
+// modified it would show up.
+template<typename index_t>
+static bool ProcessTrustedMesh( const wchar_t* fname )
+{
+    wchar_t szPath[MAX_PATH] = {};
+    if ( !ExpandMediaPath( fname, szPath, MAX_PATH ) )
+    {
+        printe( "ERROR: ExpandMediaPath FAILED\n" );
+        return false;
+    }
+
+    PrepareTimings timings = {};
+    auto fresh = PrepareMesh<index_t>( szPath, &timings );
+    if ( !fresh )
+        return false;
+
+    print( "\n\t%zu faces: load %.1f ms, validate %.1f ms, adjacency %.1f ms; --trusted-input skips %.1f ms per reuse",
+           fresh->FaceCount(), timings.loadMS, timings.validateMS, timings.adjacencyMS,
+           timings.loadMS + timings.validateMS + timings.adjacencyMS );
+
+    if ( IsTrustedInputEnabled() )
+    {
+        auto trusted = GetPreparedMesh<index_t>( szPath, true );
+        if ( !trusted )
+            return false;
+
+        if ( trusted->indices != fresh->indices
+             || trusted->adjacency != fresh->adjacency
+             || trusted->positions.size() != fresh->positions.size()
+             || memcmp( trusted->positions.data(), fresh->positions.data(), fresh->positions.size() * sizeof(XMFLOAT3) ) != 0 )
+        {
+            printe( "\nERROR: shared mesh differs from one freshly loaded and validated:\n%S\n", szPath );
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+//-------------------------------------------------------------------------------------
+// MeshProcess (trusted input)
+void Test24( std::vector<SubTest>& tests )
+{
+    for( const auto& media : g_TestMedia16 )
+    {
+        const wchar_t* fname = media.fname;
+        tests.emplace_back( GetMediaName( fname ), [fname]() { return ProcessTrustedMesh<uint16_t>( fname ); } );
+    }
+
+#ifndef BUILD_BVT_ONLY
+    for( const auto& media : g_TestMedia32 )
+    {
+        const wchar_t* fname = media.fname;
+        tests.emplace_back( GetMediaName( fname ), [fname]() { return ProcessTrustedMesh<uint32_t>( fname ); } );
+    }
 #endif
+}
@@ -0,0 +1,901 @@
+//-------------------------------------------------------------------------------------
+// scaling.cpp
+//
+// UVAtlasCreate scaling benchmark. Runs a tessellation sweep of generated spheres and
+// tori through each quality mode and reports throughput, chart count and stretch per
+// size, plus the local scaling exponent so super-linear regions stand out. With --packers
+// it instead partitions each mesh once and compares the chart packers on time and atlas
+// utilization from 512 to 4096 texels. With --reference it compares each quality mode to
+// the reference mode on time and distortion, and fails modes whose stretch or texel
+// density spread is worse by more than --tolerance. --media adds the cup, teapot and
+// Head_Big_Ears scans to the generated meshes. --index-types runs the MeshProcess media
+// through UVAtlasCreate with a void* buffer plus DXGI_FORMAT and through the typed
+// overload, checking the outputs match; it reports no timings.
+//
+// Copyright (c) Microsoft Corporation.
+//-------------------------------------------------------------------------------------
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+
+#include "directxtest.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "UVAtlas.h"
+#include "DirectXMesh.h"
+
+#include "MeshGenerator.h"
+#include "ShapesGenerator.h"
+#include "WaveFrontReader.h"
+#include "atlasmetrics.h"
+#include "bitsetpacker.h"
+#include "uvatlastyped.h"
+
+using namespace DirectX;
+
+namespace
+{
+    struct QualityMode
+    {
+        const char* name;
+        UVATLAS flags;
+    };
+
+    const QualityMode g_Modes[] =
+    {
+        { "default", UVATLAS_DEFAULT },
+        { "fast",    UVATLAS_GEODESIC_FAST },
+        { "quality", UVATLAS_GEODESIC_QUALITY },
+    };
+
+    struct MediaFile
+    {
+        const char* name;
+        const wchar_t* fname;
+    };
+
+    // Scans whose density makes the geodesic modes dominate the runtime
+    const MediaFile g_Media[] =
+    {
+        { "cup",     MESH_MEDIA_PATH L"cup._obj" },
+        { "teapot",  MESH_MEDIA_PATH L"teapot._obj" },
+        { "head",    MESH_MEDIA_PATH L"Head_Big_Ears._obj" },
+    };
+
+    // The MeshProcess(16) and MeshProcess(32) media, loaded with their own index width
+    const MediaFile g_IndexMedia16[] =
+    {
+        { "cup",      MESH_MEDIA_PATH L"cup._obj" },
+        { "teapot",   MESH_MEDIA_PATH L"teapot._obj" },
+        { "runner",   MESH_MEDIA_PATH L"SuperSimpleRunner._obj" },
+        { "shuttle",  MESH_MEDIA_PATH L"shuttle._obj" },
+        { "ship",     MESH_MEDIA_PATH L"player_ship_a._obj" },
+        { "engine",   MESH_MEDIA_PATH L"FSEngineGeo._obj" },
+        { "sphere",   MESH_MEDIA_PATH L"sphere.vbo" },
+        { "cylinder", MESH_MEDIA_PATH L"cylinder.vbo" },
+        { "torus",    MESH_MEDIA_PATH L"torus.vbo" },
+    };
+
+    const MediaFile g_IndexMedia32[] =
+    {
+        { "head",     MESH_MEDIA_PATH L"Head_Big_Ears._obj" },
+        { "john",     MESH_MEDIA_PATH L"John40k._obj" },
+    };
+
+    struct Options
+    {
+        size_t maxFaces;
+        size_t iterations;
+        bool generated;
+        bool media;
+        bool packers;
+        bool indexTypes;
+        unsigned modeMask;
+        int reference;
+        double tolerance;
+        const char* csvFile;
+
+        Options() : maxFaces(300000), iterations(1), generated(false), media(false), packers(false), indexTypes(false), modeMask(0x7),
+            reference(-1), tolerance(0.1), csvFile(nullptr) {}
+    };
+
+    struct Mesh
+    {
+        std::string shape;
+        size_t tessellation;
+        std::vector<uint32_t> indices;
+        std::vector<uint16_t> indices16;    // only for media loaded with 16-bit indices
+        std::vector<XMFLOAT3> positions;
+        std::vector<uint32_t> adjacency;
+
+        size_t FaceCount() const { return indices.size() / 3; }
+    };
+
+    struct Result
+    {
+        double medianMS;
+        size_t charts;
+        float maxStretch;
+        float densitySpread;    // max / min chart texel density, when measured
+        size_t overlapTexels;
+        HRESULT hr;
+    };
+
+    struct Packer
+    {
+        const char* name;
+        UVATLAS_PACKER packer;
+    };
+
+    const Packer g_Packers[] =
+    {
+        { "default", UVATLAS_PACKER_DEFAULT },
+        { "bitset",  UVATLAS_PACKER_BITSET },
+    };
+
+    struct PackResult
+    {
+        double medianMS;
+        double utilization;
+        HRESULT hr;
+    };
+
+    HRESULT __cdecl Callback(float /*percentComplete*/)
+    {
+        return S_OK;
+    }
+
+    bool PrepareShape(const char* shape, size_t tessellation, Mesh& mesh)
+    {
+        using Shapes = ShapesGenerator<uint32_t>;
+
+        std::vector<Shapes::Vertex> vertices;
+        if (!strcmp(shape, "sphere"))
+        {
+            Shapes::CreateSphere(mesh.indices, vertices, 1.f, tessellation, false);
+        }
+        else
+        {
+            Shapes::CreateTorus(mesh.indices, vertices, 1.f, 0.333f, tessellation, false);
+        }
+
+        mesh.shape = shape;
+        mesh.tessellation = tessellation;
+
+        mesh.positions.resize(vertices.size());
+        for (size_t j = 0; j < vertices.size(); ++j)
+        {
+            mesh.positions[j] = vertices[j].position;
+        }
+
+        // ShapesGenerator duplicates vertices along texture seams; a small epsilon welds them
+        // so the adjacency matches a closed surface
+        mesh.adjacency.resize(mesh.indices.size());
+        const HRESULT hr = GenerateAdjacencyAndPointReps(mesh.indices.data(), mesh.FaceCount(),
+            mesh.positions.data(), mesh.positions.size(), 1e-5f, nullptr, mesh.adjacency.data());
+        if (FAILED(hr))
+        {
+            printf("ERROR: GenerateAdjacencyAndPointReps failed for %s/%zu (%08X)\n", shape, tessellation, static_cast<unsigned int>(hr));
+            return false;
+        }
+
+        return true;
+    }
+
+    bool PrepareGenerated(MeshGenerator<uint32_t>::Kind kind, size_t targetFaces, Mesh& mesh)
+    {
+        try
+        {
+            MeshGenerator<uint32_t>::Create(kind, targetFaces, 0x1234u, mesh.indices, mesh.positions, mesh.adjacency);
+        }
+        catch (const std::exception& e)
+        {
+            printf("ERROR: MeshGenerator failed for %s/%zu: %s\n", MeshGenerator<uint32_t>::GetKindName(kind), targetFaces, e.what());
+            return false;
+        }
+
+        mesh.shape = MeshGenerator<uint32_t>::GetKindName(kind);
+        mesh.tessellation = targetFaces;
+        return true;
+    }
+
+    template<typename index_t>
+    bool PrepareMedia(const MediaFile& media, Mesh& mesh)
+    {
+        wchar_t szPath[MAX_PATH] = {};
+        if (!ExpandMediaPath(media.fname, szPath, MAX_PATH))
+        {
+            printf("ERROR: ExpandMediaPath failed for %s\n", media.name);
+            return false;
+        }
+
+        wchar_t ext[_MAX_EXT];
+        GetFileExtension(szPath, ext, _MAX_EXT);
+
+        std::unique_ptr<DX::WaveFrontReader<index_t>> reader(new DX::WaveFrontReader<index_t>());
+        HRESULT hr = (CompareNoCase(ext, L".vbo") == 0) ? reader->LoadVBO(szPath) : reader->Load(szPath);
+        if (FAILED(hr))
+        {
+            printf("ERROR: Failed loading mesh data (%08X): %ls\n", static_cast<unsigned int>(hr), szPath);
+            return false;
+        }
+
+        mesh.shape = media.name;
+        mesh.tessellation = 0;
+
+        mesh.positions.resize(reader->vertices.size());
+        for (size_t j = 0; j < reader->vertices.size(); ++j)
+        {
+            mesh.positions[j] = reader->vertices[j].position;
+        }
+
+        // Adjacency comes from the indices as loaded so a 16-bit unused marker stays one
+        mesh.adjacency.resize(reader->indices.size());
+        hr = GenerateAdjacencyAndPointReps(reader->indices.data(), reader->indices.size() / 3,
+            mesh.positions.data(), mesh.positions.size(), 0.f, nullptr, mesh.adjacency.data());
+        if (FAILED(hr))
+        {
+            printf("ERROR: GenerateAdjacencyAndPointReps failed for %s (%08X)\n", media.name, static_cast<unsigned int>(hr));
+            return false;
+        }
+
+        mesh.indices.assign(reader->indices.cbegin(), reader->indices.cend());
+        if (sizeof(index_t) == sizeof(uint16_t))
+        {
+            mesh.indices16.assign(reader->indices.cbegin(), reader->indices.cend());
+        }
+
+        return true;
+    }
+
+    // With measure set, the first iteration's atlas is also rasterized for the distortion
+    // and overlap figures; that happens outside the timed region
+    Result RunAtlas(const Mesh& mesh, UVATLAS flags, size_t iterations, bool measure = false)
+    {
+        Result result = {};
+
+        std::vector<double> samples;
+        for (size_t iter = 0; iter < iterations; ++iter)
+        {
+            std::vector<UVAtlasVertex> vb;
+            std::vector<uint8_t> ib;
+            std::vector<uint32_t> facePart;
+            float maxStretch = 0.f;
+            size_t numCharts = 0;
+
+            const auto start = std::chrono::steady_clock::now();
+
+            result.hr = UVAtlasCreate(mesh.positions.data(), mesh.positions.size(),
+                mesh.indices.data(), DXGI_FORMAT_R32_UINT, mesh.FaceCount(),
+                0, 0.f, 512, 512, 1.f,
+                mesh.adjacency.data(), nullptr, nullptr, Callback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                flags, vb, ib, measure ? &facePart : nullptr, nullptr, &maxStretch, &numCharts);
+
+            const auto end = std::chrono::steady_clock::now();
+
+            if (FAILED(result.hr))
+                return result;
+
+            samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+            result.charts = numCharts;
+            result.maxStretch = maxStretch;
+
+            if (measure && !iter)
+            {
+                UVAtlasMetrics metrics;
+                result.hr = UVAtlasComputeMetrics(vb.data(), vb.size(), ib.data(), DXGI_FORMAT_R32_UINT, mesh.FaceCount(),
+                    facePart.data(), 512, 512, 1.f, metrics);
+                if (FAILED(result.hr))
+                    return result;
+
+                result.densitySpread = (metrics.minTexelDensity > 0.f) ? metrics.maxTexelDensity / metrics.minTexelDensity : 0.f;
+                result.overlapTexels = metrics.overlapTexels;
+            }
+        }
+
+        std::sort(samples.begin(), samples.end());
+        const size_t n = samples.size();
+        result.medianMS = (n & 1) ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) * 0.5;
+        return result;
+    }
+
+    // Fraction of texels whose centers are covered by a triangle
+    double ComputeUtilization(const std::vector<UVAtlasVertex>& vb, const std::vector<uint8_t>& ib, size_t width, size_t height)
+    {
+        std::vector<uint8_t> covered(width * height, 0);
+        auto indices = reinterpret_cast<const uint32_t*>(ib.data());
+        const size_t nFaces = ib.size() / (sizeof(uint32_t) * 3);
+        for (size_t face = 0; face < nFaces; ++face)
+        {
+            XMFLOAT2 p[3];
+            for (size_t k = 0; k < 3; ++k)
+            {
+                const XMFLOAT2& uv = vb[indices[face * 3 + k]].uv;
+                p[k] = XMFLOAT2(uv.x * float(width), uv.y * float(height));
+            }
+
+            const float area = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[2].x - p[0].x) * (p[1].y - p[0].y);
+            if (area == 0.f)
+                continue;
+
+            const size_t x0 = size_t(std::max(0.f, std::floor(std::min({ p[0].x, p[1].x, p[2].x }))));
+            const size_t y0 = size_t(std::max(0.f, std::floor(std::min({ p[0].y, p[1].y, p[2].y }))));
+            const size_t x1 = std::min(width - 1, size_t(std::max(0.f, std::ceil(std::max({ p[0].x, p[1].x, p[2].x })))));
+            const size_t y1 = std::min(height - 1, size_t(std::max(0.f, std::ceil(std::max({ p[0].y, p[1].y, p[2].y })))));
+
+            for (size_t y = y0; y <= y1; ++y)
+            {
+                for (size_t x = x0; x <= x1; ++x)
+                {
+                    const float cx = float(x) + 0.5f;
+                    const float cy = float(y) + 0.5f;
+                    bool inside = true;
+                    for (size_t k = 0; k < 3 && inside; ++k)
+                    {
+                        const XMFLOAT2& a = p[k];
+                        const XMFLOAT2& b = p[(k + 1) % 3];
+                        const float edge = (b.x - a.x) * (cy - a.y) - (cx - a.x) * (b.y - a.y);
+                        inside = (area > 0.f) ? (edge >= 0.f) : (edge <= 0.f);
+                    }
+
+                    if (inside)
+                        covered[y * width + x] = 1;
+                }
+            }
+        }
+
+        size_t count = 0;
+        for (auto texel : covered)
+            count += texel;
+
+        return double(count) / double(width * height);
+    }
+
+    PackResult RunPack(const std::vector<UVAtlasVertex>& vb, const std::vector<uint8_t>& ib, const std::vector<uint32_t>& partitionAdj,
+        size_t size, UVATLAS_PACKER packer, size_t iterations)
+    {
+        PackResult result = {};
+
+        std::vector<double> samples;
+        for (size_t iter = 0; iter < iterations; ++iter)
+        {
+            std::vector<UVAtlasVertex> packedVB = vb;
+            std::vector<uint8_t> packedIB = ib;
+
+            const auto start = std::chrono::steady_clock::now();
+
+            result.hr = UVAtlasPackEx(packedVB, packedIB, DXGI_FORMAT_R32_UINT, size, size, 2.f,
+                partitionAdj, Callback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY, packer);
+
+            const auto end = std::chrono::steady_clock::now();
+
+            if (FAILED(result.hr))
+                return result;
+
+            samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+
+            if (!iter)
+            {
+                result.utilization = ComputeUtilization(packedVB, packedIB, size, size);
+            }
+        }
+
+        std::sort(samples.begin(), samples.end());
+        const size_t n = samples.size();
+        result.medianMS = (n & 1) ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) * 0.5;
+        return result;
+    }
+
+    // Partitions every mesh once, then packs the same charts with each packer per resolution
+    bool RunPackers(const std::vector<Mesh>& meshes, size_t iterations, FILE* csv)
+    {
+        if (csv)
+        {
+            fprintf(csv, "shape,tessellation,faces,charts,size,packer,median_ms,utilization\n");
+        }
+
+        printf("\n%-8s %8s %10s %8s %6s %-8s %12s %12s\n",
+            "shape", "tess", "faces", "charts", "size", "packer", "median ms", "utilization");
+
+        bool success = true;
+        for (const auto& mesh : meshes)
+        {
+            std::vector<UVAtlasVertex> vb;
+            std::vector<uint8_t> ib;
+            std::vector<uint32_t> partitionAdj;
+            size_t numCharts = 0;
+            HRESULT hr = UVAtlasPartition(mesh.positions.data(), mesh.positions.size(),
+                mesh.indices.data(), DXGI_FORMAT_R32_UINT, mesh.FaceCount(),
+                0, 0.f,
+                mesh.adjacency.data(), nullptr, nullptr, Callback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                UVATLAS_DEFAULT, vb, ib, nullptr, nullptr, partitionAdj, nullptr, &numCharts);
+            if (FAILED(hr))
+            {
+                printf("%-8s %8zu %10zu partition FAILED (%08X)\n", mesh.shape.c_str(), mesh.tessellation, mesh.FaceCount(),
+                    static_cast<unsigned int>(hr));
+                success = false;
+                continue;
+            }
+
+            for (size_t size = 512; size <= 4096; size *= 2)
+            {
+                for (const auto& packer : g_Packers)
+                {
+                    const PackResult result = RunPack(vb, ib, partitionAdj, size, packer.packer, iterations);
+                    if (FAILED(result.hr))
+                    {
+                        printf("%-8s %8zu %10zu %8zu %6zu %-8s FAILED (%08X)\n", mesh.shape.c_str(), mesh.tessellation, mesh.FaceCount(),
+                            numCharts, size, packer.name, static_cast<unsigned int>(result.hr));
+                        success = false;
+                        continue;
+                    }
+
+                    printf("%-8s %8zu %10zu %8zu %6zu %-8s %12.1f %12.3f\n",
+                        mesh.shape.c_str(), mesh.tessellation, mesh.FaceCount(), numCharts, size, packer.name,
+                        result.medianMS, result.utilization);
+
+                    if (csv)
+                    {
+                        fprintf(csv, "%s,%zu,%zu,%zu,%zu,%s,%.3f,%.4f\n",
+                            mesh.shape.c_str(), mesh.tessellation, mesh.FaceCount(), numCharts, size, packer.name,
+                            result.medianMS, result.utilization);
+                    }
+
+                    fflush(stdout);
+                }
+            }
+        }
+
+        return success;
+    }
+
+    // Runs the reference mode on every mesh, then each other selected mode, and checks that
+    // the modes distort no worse than the reference within the tolerance. Stretch is in
+    // [0,1] so it is compared absolutely; the density spread is compared as a ratio.
+    bool RunEquivalence(const std::vector<Mesh>& meshes, size_t reference, unsigned modeMask, size_t iterations, double tolerance, FILE* csv)
+    {
+        if (csv)
+        {
+            fprintf(csv, "shape,faces,mode,median_ms,speedup,charts,max_stretch,density_spread,overlap_texels,equivalent\n");
+        }
+
+        printf("\n%-8s %10s %-8s %12s %8s %8s %10s %10s %8s %6s\n",
+            "shape", "faces", "mode", "median ms", "speedup", "charts", "stretch", "spread", "overlap", "equiv");
+
+        bool success = true;
+        for (const auto& mesh : meshes)
+        {
+            const Result baseline = RunAtlas(mesh, g_Modes[reference].flags, iterations, true);
+            if (FAILED(baseline.hr))
+            {
+                printf("%-8s %10zu %-8s FAILED (%08X)\n", mesh.shape.c_str(), mesh.FaceCount(), g_Modes[reference].name,
+                    static_cast<unsigned int>(baseline.hr));
+                success = false;
+                continue;
+            }
+
+            for (size_t m = 0; m < std::size(g_Modes); ++m)
+            {
+                if (m != reference && !(modeMask & (1u << m)))
+                    continue;
+
+                const Result result = (m == reference) ? baseline : RunAtlas(mesh, g_Modes[m].flags, iterations, true);
+                if (FAILED(result.hr))
+                {
+                    printf("%-8s %10zu %-8s FAILED (%08X)\n", mesh.shape.c_str(), mesh.FaceCount(), g_Modes[m].name,
+                        static_cast<unsigned int>(result.hr));
+                    success = false;
+                    continue;
+                }
+
+                const double speedup = (result.medianMS > 0) ? baseline.medianMS / result.medianMS : 0.0;
+                const bool equivalent = (double(result.maxStretch) <= double(baseline.maxStretch) + tolerance)
+                    && (double(result.densitySpread) <= double(baseline.densitySpread) * (1.0 + tolerance));
+                if (!equivalent)
+                    success = false;
+
+                printf("%-8s %10zu %-8s %12.1f %8.2f %8zu %10.4f %10.2f %8zu %6s\n",
+                    mesh.shape.c_str(), mesh.FaceCount(), g_Modes[m].name,
+                    result.medianMS, speedup, result.charts, result.maxStretch, result.densitySpread, result.overlapTexels,
+                    equivalent ? "yes" : "NO");
+
+                if (csv)
+                {
+                    fprintf(csv, "%s,%zu,%s,%.3f,%.3f,%zu,%.6f,%.4f,%zu,%d\n",
+                        mesh.shape.c_str(), mesh.FaceCount(), g_Modes[m].name,
+                        result.medianMS, speedup, result.charts, result.maxStretch, result.densitySpread, result.overlapTexels,
+                        equivalent ? 1 : 0);
+                }
+
+                fflush(stdout);
+            }
+        }
+
+        return success;
+    }
+
+    // Everything UVAtlasCreate returns, compared bit for bit
+    struct AtlasOutputs
+    {
+        std::vector<UVAtlasVertex> vb;
+        std::vector<uint8_t> ib;
+        std::vector<uint32_t> facePart;
+        std::vector<uint32_t> remap;
+        float maxStretch;
+        size_t numCharts;
+
+        bool operator==(const AtlasOutputs& other) const noexcept
+        {
+            return vb.size() == other.vb.size()
+                && !memcmp(vb.data(), other.vb.data(), vb.size() * sizeof(UVAtlasVertex))
+                && ib == other.ib
+                && facePart == other.facePart
+                && remap == other.remap
+                && !memcmp(&maxStretch, &other.maxStretch, sizeof(float))
+                && numCharts == other.numCharts;
+        }
+    };
+
+    template<typename index_t>
+    HRESULT CreateTyped(const Mesh& mesh, const index_t* indices, AtlasOutputs& out)
+    {
+        return UVAtlasCreate<index_t>(mesh.positions.data(), mesh.positions.size(),
+            indices, mesh.FaceCount(),
+            0, 0.f, 512, 512, 1.f,
+            mesh.adjacency.data(), nullptr, nullptr, Callback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+            UVATLAS_DEFAULT, out.vb, out.ib, &out.facePart, &out.remap, &out.maxStretch, &out.numCharts);
+    }
+
+    // Atlases each mesh with its native index width through the void* + DXGI_FORMAT entry
+    // point and through the typed overload, and checks the outputs are identical. The typed
+    // overload forwards to the same entry point, so this is an equivalence check, not a
+    // benchmark: there is no second code path whose time could differ.
+    bool RunIndexTypes(const std::vector<Mesh>& meshes, FILE* csv)
+    {
+        if (csv)
+        {
+            fprintf(csv, "shape,faces,index_bits,vertices,charts,identical\n");
+        }
+
+        printf("\n%-8s %10s %6s %10s %8s %6s\n",
+            "shape", "faces", "index", "verts", "charts", "same");
+
+        bool success = true;
+        for (const auto& mesh : meshes)
+        {
+            const bool is16 = !mesh.indices16.empty();
+            const void* indices = is16 ? static_cast<const void*>(mesh.indices16.data()) : mesh.indices.data();
+            const DXGI_FORMAT indexFormat = is16 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+
+            AtlasOutputs format = {};
+            AtlasOutputs typed = {};
+            HRESULT hr = UVAtlasCreate(mesh.positions.data(), mesh.positions.size(),
+                indices, indexFormat, mesh.FaceCount(),
+                0, 0.f, 512, 512, 1.f,
+                mesh.adjacency.data(), nullptr, nullptr, Callback, UVATLAS_DEFAULT_CALLBACK_FREQUENCY,
+                UVATLAS_DEFAULT, format.vb, format.ib, &format.facePart, &format.remap, &format.maxStretch, &format.numCharts);
+            if (SUCCEEDED(hr))
+            {
+                hr = is16 ? CreateTyped(mesh, mesh.indices16.data(), typed)
+                    : CreateTyped(mesh, mesh.indices.data(), typed);
+            }
+
+            if (FAILED(hr))
+            {
+                printf("%-8s %10zu %6u FAILED (%08X)\n", mesh.shape.c_str(), mesh.FaceCount(), is16 ? 16u : 32u,
+                    static_cast<unsigned int>(hr));
+                success = false;
+                continue;
+            }
+
+            const bool identical = (format == typed);
+            if (!identical)
+                success = false;
+
+            printf("%-8s %10zu %6u %10zu %8zu %6s\n",
+                mesh.shape.c_str(), mesh.FaceCount(), is16 ? 16u : 32u,
+                format.vb.size(), format.numCharts, identical ? "yes" : "NO");
+
+            if (csv)
+            {
+                fprintf(csv, "%s,%zu,%u,%zu,%zu,%d\n",
+                    mesh.shape.c_str(), mesh.FaceCount(), is16 ? 16u : 32u,
+                    format.vb.size(), format.numCharts, identical ? 1 : 0);
+            }
+
+            fflush(stdout);
+        }
+
+        return success;
+    }
+
+    bool ParseCommandLine(int argc, char* argv[], Options& options)
+    {
+        for (int iArg = 1; iArg < argc; ++iArg)
+        {
+            const char* arg = argv[iArg];
+
+            if (!strcmp(arg, "--max-faces") && (iArg + 1 < argc))
+            {
+                options.maxFaces = strtoull(argv[++iArg], nullptr, 10);
+            }
+            else if (!strcmp(arg, "--iterations") && (iArg + 1 < argc))
+            {
+                options.iterations = std::max<size_t>(1, strtoull(argv[++iArg], nullptr, 10));
+            }
+            else if (!strcmp(arg, "--modes") && (iArg + 1 < argc))
+            {
+                // Comma-separated subset of default,fast,quality
+                options.modeMask = 0;
+                const std::string list = argv[++iArg];
+                for (size_t m = 0; m < std::size(g_Modes); ++m)
+                {
+                    if (list.find(g_Modes[m].name) != std::string::npos)
+                        options.modeMask |= 1u << m;
+                }
+
+                if (!options.modeMask)
+                {
+                    printf("ERROR: --modes expects a list of default, fast, quality\n");
+                    return false;
+                }
+            }
+            else if (!strcmp(arg, "--reference") && (iArg + 1 < argc))
+            {
+                const char* name = argv[++iArg];
+                options.reference = -1;
+                for (size_t m = 0; m < std::size(g_Modes); ++m)
+                {
+                    if (!strcmp(name, g_Modes[m].name))
+                        options.reference = static_cast<int>(m);
+                }
+
+                if (options.reference < 0)
+                {
+                    printf("ERROR: --reference expects one of default, fast, quality\n");
+                    return false;
+                }
+            }
+            else if (!strcmp(arg, "--tolerance") && (iArg + 1 < argc))
+            {
+                options.tolerance = std::max(0.0, strtod(argv[++iArg], nullptr));
+            }
+            else if (!strcmp(arg, "--generated"))
+            {
+                options.generated = true;
+            }
+            else if (!strcmp(arg, "--media"))
+            {
+                options.media = true;
+            }
+            else if (!strcmp(arg, "--packers"))
+            {
+                options.packers = true;
+            }
+            else if (!strcmp(arg, "--index-types"))
+            {
+                options.indexTypes = true;
+            }
+            else if (!strcmp(arg, "--csv") && (iArg + 1 < argc))
+            {
+                options.csvFile = argv[++iArg];
+            }
+            else
+            {
+                printf("ERROR: Unknown option '%s'\n", arg);
+                printf("Usage: uvatlasbench [--max-faces <count>] [--iterations <count>] [--modes default,fast,quality]\n"
+                       "                    [--generated] [--media] [--packers] [--reference <mode> [--tolerance <value>]]\n"
+                       "                    [--index-types] [--csv <file>]\n");
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    printf("**************************************************************\n");
+    printf("*** UVAtlasCreate scaling benchmark\n");
+    printf("*** Library Version %03d\n", UVATLAS_VERSION);
+    printf("**************************************************************\n");
+
+    Options options;
+    if (!ParseCommandLine(argc, argv, options))
+        return -1;
+
+    if (!XMVerifyCPUSupport())
+    {
+        printf("ERROR: XMVerifyCPUSupport fails on this system, not a supported platform\n");
+        return -1;
+    }
+
+    FILE* csv = nullptr;
+    if (options.csvFile)
+    {
+        csv = fopen(options.csvFile, "wt");
+        if (!csv)
+        {
+            printf("ERROR: Failed to open %s\n", options.csvFile);
+            return -1;
+        }
+    }
+
+    // Only the media are needed to compare the index paths
+    if (options.indexTypes)
+    {
+        std::vector<Mesh> media;
+        for (const auto& file : g_IndexMedia16)
+        {
+            Mesh mesh;
+            if (!PrepareMedia<uint16_t>(file, mesh))
+                return -1;
+            media.emplace_back(std::move(mesh));
+        }
+
+        for (const auto& file : g_IndexMedia32)
+        {
+            Mesh mesh;
+            if (!PrepareMedia<uint32_t>(file, mesh))
+                return -1;
+            media.emplace_back(std::move(mesh));
+        }
+
+        const bool identical = RunIndexTypes(media, csv);
+        if (csv)
+        {
+            fclose(csv);
+        }
+        return identical ? 0 : -1;
+    }
+
+    // Sweep tessellation by doubling; faces grow ~4x per step (sphere ~4t^2, torus ~2t^2)
+    std::vector<Mesh> meshes;
+    const char* shapes[] = { "sphere", "torus" };
+    for (auto shape : shapes)
+    {
+        for (size_t tessellation = 16; ; tessellation *= 2)
+        {
+            const size_t faces = !strcmp(shape, "sphere") ? (tessellation * (tessellation * 2 + 1) * 2) : ((tessellation + 1) * (tessellation + 1) * 2);
+            if (faces > options.maxFaces)
+                break;
+
+            Mesh mesh;
+            if (!PrepareShape(shape, tessellation, mesh))
+                return -1;
+            meshes.emplace_back(std::move(mesh));
+        }
+    }
+
+    if (options.generated)
+    {
+        for (int kind = 0; kind < MeshGenerator<uint32_t>::KIND_MAX; ++kind)
+        {
+            for (size_t target = 1000; target <= options.maxFaces; target *= 4)
+            {
+                Mesh mesh;
+                if (!PrepareGenerated(static_cast<MeshGenerator<uint32_t>::Kind>(kind), target, mesh))
+                    return -1;
+                meshes.emplace_back(std::move(mesh));
+            }
+        }
+    }
+
+    if (options.media)
+    {
+        for (const auto& media : g_Media)
+        {
+            Mesh mesh;
+            if (!PrepareMedia<uint32_t>(media, mesh))
+                return -1;
+            meshes.emplace_back(std::move(mesh));
+        }
+    }
+
+    if (options.reference >= 0)
+    {
+        const bool equivalent = RunEquivalence(meshes, size_t(options.reference), options.modeMask, options.iterations, options.tolerance, csv);
+        if (csv)
+        {
+            fclose(csv);
+        }
+        return equivalent ? 0 : -1;
+    }
+
+    if (options.packers)
+    {
+        const bool packed = RunPackers(meshes, options.iterations, csv);
+        if (csv)
+        {
+            fclose(csv);
+        }
+        return packed ? 0 : -1;
+    }
+
+    if (csv)
+    {
+        fprintf(csv, "shape,tessellation,faces,mode,median_ms,faces_per_sec,charts,max_stretch,exponent\n");
+    }
+
+    printf("\n%-8s %8s %10s %-8s %12s %14s %8s %10s %9s\n",
+        "shape", "tess", "faces", "mode", "median ms", "faces/sec", "charts", "stretch", "exponent");
+
+    bool success = true;
+    for (size_t m = 0; m < std::size(g_Modes); ++m)
+    {
+        if (!(options.modeMask & (1u << m)))
+            continue;
+
+        const Mesh* prevMesh = nullptr;
+        double prevMS = 0;
+
+        for (const auto& mesh : meshes)
+        {
+            if (prevMesh && prevMesh->shape != mesh.shape)
+                prevMesh = nullptr;
+
+            const Result result = RunAtlas(mesh, g_Modes[m].flags, options.iterations);
+            if (FAILED(result.hr))
+            {
+                printf("%-8s %8zu %10zu %-8s FAILED (%08X)\n", mesh.shape.c_str(), mesh.tessellation, mesh.FaceCount(), g_Modes[m].name,
+                    static_cast<unsigned int>(result.hr));
+                success = false;
+                prevMesh = nullptr;
+                continue;
+            }
+
+            const double facesPerSec = (result.medianMS > 0) ? double(mesh.FaceCount()) * 1000.0 / result.medianMS : 0.0;
+
+            // Local exponent k in time ~ faces^k between consecutive sizes; > 1 is super-linear
+            double exponent = 0;
+            if (prevMesh && prevMS > 0 && result.medianMS > 0 && mesh.FaceCount() > prevMesh->FaceCount())
+            {
+                exponent = std::log(result.medianMS / prevMS) / std::log(double(mesh.FaceCount()) / double(prevMesh->FaceCount()));
+            }
+
+            char exponentText[16] = "-";
+            if (prevMesh)
+            {
+                snprintf(exponentText, sizeof(exponentText), "%.2f", exponent);
+            }
+
+            printf("%-8s %8zu %10zu %-8s %12.1f %14.0f %8zu %10.4f %9s\n",
+                mesh.shape.c_str(), mesh.tessellation, mesh.FaceCount(), g_Modes[m].name,
+                result.medianMS, facesPerSec, result.charts, result.maxStretch, exponentText);
+
+            if (csv)
+            {
+                fprintf(csv, "%s,%zu,%zu,%s,%.3f,%.1f,%zu,%.6f,%s\n",
+                    mesh.shape.c_str(), mesh.tessellation, mesh.FaceCount(), g_Modes[m].name,
+                    result.medianMS, facesPerSec, result.charts, result.maxStretch, prevMesh ? exponentText : "");
+            }
+
+            fflush(stdout);
+
+            prevMesh = &mesh;
+            prevMS = result.medianMS;
+        }
+    }
+
+    if (csv)
+    {
+        fclose(csv);
+    }
+
+    return success ? 0 : -1;
+}
@@ -0,0 +1,212 @@
+//-------------------------------------------------------------------------------------
+// sharedatlas.cpp
+//
+// Copyright (c) Microsoft Corporation.
+//-------------------------------------------------------------------------------------
+
+#include "directxtest.h"
+#include "sharedatlas.h"
+#include "unionfind.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <exception>
+#include <numeric>
+
+using namespace DirectX;
+
+namespace
+{
+    const HRESULT c_ArithmeticOverflow = static_cast<HRESULT>(0x80070216L);
+
+    // Appends one mesh to the combined 32-bit buffers, offsetting vertex and face indices
+    template<typename index_t>
+    HRESULT AppendMesh(const UVAtlasSharedMesh& mesh, size_t vertOffset, size_t faceOffset,
+        std::vector<uint32_t>& indices, std::vector<uint32_t>& adjacency)
+    {
+        const size_t nVerts = mesh.vertexBuffer->size();
+        const size_t nFaces = mesh.indexBuffer->size() / (sizeof(index_t) * 3);
+        auto ib = reinterpret_cast<const index_t*>(mesh.indexBuffer->data());
+
+        for (size_t j = 0; j < nFaces * 3; ++j)
+        {
+            // Offsets would hide an out-of-range index from UVAtlasPack's own checks
+            if (size_t(ib[j]) >= nVerts)
+                return E_INVALIDARG;
+            indices.push_back(uint32_t(vertOffset + ib[j]));
+
+            const uint32_t neighbor = (*mesh.partitionResultAdjacency)[j];
+            if (neighbor == uint32_t(-1))
+            {
+                adjacency.push_back(neighbor);
+            }
+            else if (neighbor < nFaces)
+            {
+                adjacency.push_back(uint32_t(faceOffset + neighbor));
+            }
+            else
+            {
+                return E_INVALIDARG;
+            }
+        }
+
+        return S_OK;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT __cdecl UVAtlasPackShared(
+    const UVAtlasSharedMesh* meshes, size_t nMeshes,
+    DXGI_FORMAT indexFormat,
+    size_t width, size_t height, float gutter,
+    std::function<HRESULT __cdecl(float percentComplete)> statusCallBack,
+    float callbackFrequency,
+    std::vector<std::vector<UVAtlasVertex>>& vMeshOutVertexBuffers,
+    std::vector<UVAtlasChartPlacement>* pvChartPlacements)
+{
+    if (!meshes || !nMeshes || nMeshes >= UINT32_MAX)
+        return E_INVALIDARG;
+
+    size_t indexSize;
+    switch (indexFormat)
+    {
+    case DXGI_FORMAT_R16_UINT: indexSize = sizeof(uint16_t); break;
+    case DXGI_FORMAT_R32_UINT: indexSize = sizeof(uint32_t); break;
+    default: return E_INVALIDARG;
+    }
+
+    size_t totalVerts = 0;
+    size_t totalFaces = 0;
+    for (size_t j = 0; j < nMeshes; ++j)
+    {
+        const auto& mesh = meshes[j];
+        if (!mesh.vertexBuffer || !mesh.indexBuffer || !mesh.partitionResultAdjacency)
+            return E_INVALIDARG;
+
+        const size_t nFaces = mesh.indexBuffer->size() / (indexSize * 3);
+        if (mesh.vertexBuffer->empty() || !nFaces
+            || mesh.indexBuffer->size() != nFaces * indexSize * 3
+            || mesh.partitionResultAdjacency->size() != nFaces * 3)
+            return E_INVALIDARG;
+
+        totalVerts += mesh.vertexBuffer->size();
+        totalFaces += nFaces;
+    }
+
+    if (totalVerts >= UINT32_MAX || totalFaces >= (UINT32_MAX / 3))
+        return c_ArithmeticOverflow;
+
+    try
+    {
+        std::vector<UVAtlasVertex> vb;
+        std::vector<uint32_t> indices;
+        std::vector<uint32_t> adjacency;
+        vb.reserve(totalVerts);
+        indices.reserve(totalFaces * 3);
+        adjacency.reserve(totalFaces * 3);
+
+        std::vector<size_t> faceOffsets(nMeshes + 1, 0);
+        for (size_t j = 0; j < nMeshes; ++j)
+        {
+            const auto& mesh = meshes[j];
+
+            const HRESULT hr = (indexFormat == DXGI_FORMAT_R16_UINT)
+                ? AppendMesh<uint16_t>(mesh, vb.size(), faceOffsets[j], indices, adjacency)
+                : AppendMesh<uint32_t>(mesh, vb.size(), faceOffsets[j], indices, adjacency);
+            if (FAILED(hr))
+                return hr;
+
+            vb.insert(vb.end(), mesh.vertexBuffer->begin(), mesh.vertexBuffer->end());
+            faceOffsets[j + 1] = indices.size() / 3;
+        }
+
+        // Always packed as 32-bit so small 16-bit props can share an atlas past 64K vertices
+        std::vector<uint8_t> ib(indices.size() * sizeof(uint32_t));
+        memcpy(ib.data(), indices.data(), ib.size());
+
+        HRESULT hr = UVAtlasPack(vb, ib, DXGI_FORMAT_R32_UINT, width, height, gutter,
+            adjacency, statusCallBack, callbackFrequency);
+        if (FAILED(hr))
+            return hr;
+
+        if (vb.size() != totalVerts)
+            return E_UNEXPECTED;
+
+        if (pvChartPlacements)
+        {
+            // Charts never span meshes since no adjacency crosses between them
+            std::vector<uint32_t> parent(totalFaces);
+            std::iota(parent.begin(), parent.end(), 0u);
+            for (size_t face = 0; face < totalFaces; ++face)
+            {
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    const uint32_t neighbor = adjacency[face * 3 + k];
+                    if (neighbor == uint32_t(-1))
+                        continue;
+
+                    UnionRoots(parent, uint32_t(face), neighbor);
+                }
+            }
+
+            // Roots are the lowest face of each chart, so charts come out in first-face order
+            std::vector<uint32_t> chartOf(totalFaces, uint32_t(-1));
+            std::vector<UVAtlasChartPlacement> placements;
+            std::vector<XMFLOAT2> maxUV;
+            size_t mesh = 0;
+            for (size_t face = 0; face < totalFaces; ++face)
+            {
+                while (face >= faceOffsets[mesh + 1])
+                    ++mesh;
+
+                const uint32_t root = FindRoot(parent, uint32_t(face));
+                if (chartOf[root] == uint32_t(-1))
+                {
+                    chartOf[root] = uint32_t(placements.size());
+
+                    UVAtlasChartPlacement placement = {};
+                    placement.mesh = uint32_t(mesh);
+                    placement.firstFace = uint32_t(face - faceOffsets[mesh]);
+                    placement.offset = XMFLOAT2(FLT_MAX, FLT_MAX);
+                    placements.push_back(placement);
+                    maxUV.emplace_back(-FLT_MAX, -FLT_MAX);
+                }
+
+                const uint32_t chart = chartOf[root];
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    const XMFLOAT2& uv = vb[indices[face * 3 + k]].uv;
+                    placements[chart].offset.x = std::min(placements[chart].offset.x, uv.x);
+                    placements[chart].offset.y = std::min(placements[chart].offset.y, uv.y);
+                    maxUV[chart].x = std::max(maxUV[chart].x, uv.x);
+                    maxUV[chart].y = std::max(maxUV[chart].y, uv.y);
+                }
+            }
+
+            for (size_t j = 0; j < placements.size(); ++j)
+            {
+                placements[j].size = XMFLOAT2(maxUV[j].x - placements[j].offset.x, maxUV[j].y - placements[j].offset.y);
+            }
+
+            pvChartPlacements->swap(placements);
+        }
+
+        std::vector<std::vector<UVAtlasVertex>> vbs(nMeshes);
+        size_t vertOffset = 0;
+        for (size_t j = 0; j < nMeshes; ++j)
+        {
+            const size_t count = meshes[j].vertexBuffer->size();
+            vbs[j].assign(vb.begin() + ptrdiff_t(vertOffset), vb.begin() + ptrdiff_t(vertOffset + count));
+            vertOffset += count;
+        }
+
+        vMeshOutVertexBuffers.swap(vbs);
+        return S_OK;
+    }
+    catch (const std::bad_alloc&)
+    {
+        return E_OUTOFMEMORY;
+    }
+}
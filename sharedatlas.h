@@ -0,0 +1,46 @@
+//-------------------------------------------------------------------------------------
+// sharedatlas.h
+//
+// Packs the charts of several partitioned meshes into one shared atlas (e.g. a scene
+// lightmap) with a single UVAtlasPack call
+//
+// Copyright (c) Microsoft Corporation.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "UVAtlas.h"
+
+// One mesh as returned by UVAtlasPartition
+struct UVAtlasSharedMesh
+{
+    const std::vector<DirectX::UVAtlasVertex>* vertexBuffer;
+    const std::vector<uint8_t>* indexBuffer;
+    const std::vector<uint32_t>* partitionResultAdjacency;
+};
+
+// Where a chart ended up in the shared atlas, in normalized texture coordinates. Charts are
+// the face groups connected through the partition adjacency, in order of their first face.
+struct UVAtlasChartPlacement
+{
+    uint32_t mesh;
+    uint32_t firstFace;         // lowest face index of the chart within its mesh
+    DirectX::XMFLOAT2 offset;   // minimum corner of the chart's UV bounds
+    DirectX::XMFLOAT2 size;     // extent of the chart's UV bounds
+};
+
+// All meshes use indexFormat. Output vertex buffer j holds mesh j's vertices with UVs in the
+// shared atlas; index buffers and vertex order are unchanged, so the inputs' index buffers
+// still apply. The combined vertex count only has to fit in 32 bits, even for 16-bit input.
+HRESULT __cdecl UVAtlasPackShared(
+    _In_reads_(nMeshes) const UVAtlasSharedMesh* meshes, size_t nMeshes,
+    DXGI_FORMAT indexFormat,
+    size_t width, size_t height, float gutter,
+    std::function<HRESULT __cdecl(float percentComplete)> statusCallBack,
+    float callbackFrequency,
+    std::vector<std::vector<DirectX::UVAtlasVertex>>& vMeshOutVertexBuffers,
+    _Out_opt_ std::vector<UVAtlasChartPlacement>* pvChartPlacements);
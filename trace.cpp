@@ -0,0 +1,194 @@
+//-------------------------------------------------------------------------------------
+// trace.cpp
+//
+// Records scoped spans and counters in memory and writes them out in the Chrome
+// trace event format (chrome://tracing, https://ui.perfetto.dev).
+//
+// Copyright (c) Microsoft Corporation.
+//-------------------------------------------------------------------------------------
+
+#include "directxtest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct TraceEvent
+    {
+        std::string name;
+        char phase;     // 'X' complete span, 'C' counter
+        uint32_t tid;
+        double ts;      // microseconds
+        double value;   // duration for spans, sample value for counters
+    };
+
+    std::atomic<bool> s_traceEnabled(false);
+    std::wstring s_traceFile;
+    std::mutex s_traceMutex;
+    std::vector<TraceEvent> s_traceEvents;
+
+    const auto s_traceOrigin = std::chrono::steady_clock::now();
+
+    std::atomic<uint32_t> s_nextThreadId(1);
+    thread_local uint32_t t_threadId = 0;
+
+    double TraceNowUS() noexcept
+    {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - s_traceOrigin).count();
+    }
+
+    uint32_t TraceThreadId() noexcept
+    {
+        if (!t_threadId)
+            t_threadId = s_nextThreadId++;
+        return t_threadId;
+    }
+
+    void AddEvent(const char* name, char phase, double ts, double value)
+    {
+        // Trace bookkeeping should not show up in the per-test allocation counts
+        AllocationTrackingSuspend suspend;
+
+        TraceEvent ev;
+        ev.name = name;
+        ev.phase = phase;
+        ev.tid = TraceThreadId();
+        ev.ts = ts;
+        ev.value = value;
+
+        std::lock_guard<std::mutex> lock(s_traceMutex);
+        s_traceEvents.emplace_back(std::move(ev));
+    }
+
+    std::string EscapeTraceName(const std::string& str)
+    {
+        std::string result;
+        for (auto c : str)
+        {
+            switch (c)
+            {
+            case '"':  result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            default:   result += c; break;
+            }
+        }
+        return result;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void BeginTrace(const wchar_t* fileName)
+{
+    std::lock_guard<std::mutex> lock(s_traceMutex);
+    s_traceFile = fileName;
+    s_traceEvents.clear();
+    s_traceEvents.reserve(4096);
+    s_traceEnabled = true;
+}
+
+bool EndTrace()
+{
+    if (!s_traceEnabled)
+        return true;
+
+    s_traceEnabled = false;
+
+    std::lock_guard<std::mutex> lock(s_traceMutex);
+
+    FILE* fp = OpenFile(s_traceFile.c_str(), "wt");
+    if (!fp)
+    {
+        printe("ERROR: Failed to open trace file %ls\n", s_traceFile.c_str());
+        return false;
+    }
+
+    std::stable_sort(s_traceEvents.begin(), s_traceEvents.end(),
+        [](const TraceEvent& a, const TraceEvent& b) { return a.ts < b.ts; });
+
+    fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(fp, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"xtuvatlas\"}}");
+
+    for (const auto& ev : s_traceEvents)
+    {
+        const std::string name = EscapeTraceName(ev.name);
+        if (ev.phase == 'X')
+        {
+            fprintf(fp, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                name.c_str(), ev.tid, ev.ts, ev.value);
+        }
+        else
+        {
+            fprintf(fp, ",\n{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"args\":{\"value\":%g}}",
+                name.c_str(), ev.tid, ev.ts, ev.value);
+        }
+    }
+
+    fprintf(fp, "\n]}\n");
+    fclose(fp);
+
+    s_traceEvents.clear();
+    return true;
+}
+
+bool IsTraceEnabled() noexcept
+{
+    return s_traceEnabled;
+}
+
+_Use_decl_annotations_
+void TraceCounter(const char* name, double value)
+{
+    if (!s_traceEnabled)
+        return;
+
+    AddEvent(name, 'C', TraceNowUS(), value);
+}
+
+
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+TraceSpan::TraceSpan(const char* name) noexcept :
+    m_name(name),
+    m_start(0)
+{
+    if (s_traceEnabled)
+    {
+        m_start = TraceNowUS();
+    }
+    else
+    {
+        m_name = nullptr;
+    }
+}
+
+TraceSpan::~TraceSpan()
+{
+    End();
+}
+
+void TraceSpan::End() noexcept
+{
+    if (!m_name)
+        return;
+
+    const char* name = m_name;
+    m_name = nullptr;
+
+    if (!s_traceEnabled)
+        return;
+
+    try
+    {
+        AddEvent(name, 'X', m_start, TraceNowUS() - m_start);
+    }
+    catch (...)
+    {
+    }
+}
@@ -0,0 +1,35 @@
+//-------------------------------------------------------------------------------------
+// unionfind.h
+//
+// Disjoint sets over face indices, used to group faces into charts or components
+// through an adjacency array
+//
+// Copyright (c) Microsoft Corporation.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Root of the set holding face, halving the path on the way
+inline uint32_t FindRoot(std::vector<uint32_t>& parent, uint32_t face) noexcept
+{
+    while (parent[face] != face)
+    {
+        parent[face] = parent[parent[face]];
+        face = parent[face];
+    }
+    return face;
+}
+
+// Joins the sets of two faces. The lower root wins, so every root is the lowest face of
+// its set and walking faces in order visits sets in first-face order.
+inline void UnionRoots(std::vector<uint32_t>& parent, uint32_t a, uint32_t b) noexcept
+{
+    a = FindRoot(parent, a);
+    b = FindRoot(parent, b);
+    if (a != b)
+        parent[std::max(a, b)] = std::min(a, b);
+}
@@ -0,0 +1,156 @@
+//-------------------------------------------------------------------------------------
+// uvatlastyped.h
+//
+// Overloads of the UVAtlas entry points that take uint16_t or uint32_t index pointers in
+// place of const void* plus a DXGI_FORMAT, so the index width is fixed by the type
+//
+// Copyright (c) Microsoft Corporation.
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "UVAtlas.h"
+
+// Index format for an index type. Only the two widths UVAtlas accepts are defined, and the
+// overloads below drop out of overload resolution for any other type, so a call with the
+// wrong index type fails to compile rather than with E_INVALIDARG at runtime
+template<typename index_t> struct UVAtlasIndexFormat;
+
+template<> struct UVAtlasIndexFormat<uint16_t>
+{
+    static constexpr DXGI_FORMAT value = DXGI_FORMAT_R16_UINT;
+};
+
+template<> struct UVAtlasIndexFormat<uint32_t>
+{
+    static constexpr DXGI_FORMAT value = DXGI_FORMAT_R32_UINT;
+};
+
+// Each overload has the contract of the function it forwards to, with the format taken
+// from index_t. The library's own loops still branch on the format internally; what moves
+// to compile time is the choice at the call site, and with it the pairing of a 16-bit
+// buffer with R32_UINT (or the reverse) that the void* signature can't catch.
+
+template<typename index_t, typename = decltype(UVAtlasIndexFormat<index_t>::value)>
+inline HRESULT __cdecl UVAtlasCreate(
+    _In_reads_(nVerts) const DirectX::XMFLOAT3* positions, size_t nVerts,
+    _In_reads_(nFaces * 3) const index_t* indices, size_t nFaces,
+    size_t maxChartNumber, float maxStretch,
+    size_t width, size_t height, float gutter,
+    _In_reads_(nFaces * 3) const uint32_t* adjacency,
+    _In_reads_opt_(nFaces * 3) const uint32_t* falseEdgeAdjacency,
+    _In_reads_opt_(nFaces * 3) const float* pIMTArray,
+    std::function<HRESULT __cdecl(float percentComplete)> statusCallBack,
+    float callbackFrequency,
+    DirectX::UVATLAS options,
+    std::vector<DirectX::UVAtlasVertex>& vMeshOutVertexBuffer,
+    std::vector<uint8_t>& vMeshOutIndexBuffer,
+    _Out_opt_ std::vector<uint32_t>* pvFacePartitioning = nullptr,
+    _Out_opt_ std::vector<uint32_t>* pvVertexRemapArray = nullptr,
+    _Out_opt_ float* maxStretchOut = nullptr,
+    _Out_opt_ size_t* numChartsOut = nullptr)
+{
+    return DirectX::UVAtlasCreate(positions, nVerts, indices, UVAtlasIndexFormat<index_t>::value, nFaces,
+        maxChartNumber, maxStretch, width, height, gutter,
+        adjacency, falseEdgeAdjacency, pIMTArray, statusCallBack, callbackFrequency, options,
+        vMeshOutVertexBuffer, vMeshOutIndexBuffer, pvFacePartitioning, pvVertexRemapArray,
+        maxStretchOut, numChartsOut);
+}
+
+template<typename index_t, typename = decltype(UVAtlasIndexFormat<index_t>::value)>
+inline HRESULT __cdecl UVAtlasPartition(
+    _In_reads_(nVerts) const DirectX::XMFLOAT3* positions, size_t nVerts,
+    _In_reads_(nFaces * 3) const index_t* indices, size_t nFaces,
+    size_t maxChartNumber, float maxStretch,
+    _In_reads_(nFaces * 3) const uint32_t* adjacency,
+    _In_reads_opt_(nFaces * 3) const uint32_t* falseEdgeAdjacency,
+    _In_reads_opt_(nFaces * 3) const float* pIMTArray,
+    std::function<HRESULT __cdecl(float percentComplete)> statusCallBack,
+    float callbackFrequency,
+    DirectX::UVATLAS options,
+    std::vector<DirectX::UVAtlasVertex>& vMeshOutVertexBuffer,
+    std::vector<uint8_t>& vMeshOutIndexBuffer,
+    _Out_opt_ std::vector<uint32_t>* pvFacePartitioning,
+    _Out_opt_ std::vector<uint32_t>* pvVertexRemapArray,
+    std::vector<uint32_t>& vPartitionResultAdjacency,
+    _Out_opt_ float* maxStretchOut = nullptr,
+    _Out_opt_ size_t* numChartsOut = nullptr)
+{
+    return DirectX::UVAtlasPartition(positions, nVerts, indices, UVAtlasIndexFormat<index_t>::value, nFaces,
+        maxChartNumber, maxStretch, adjacency, falseEdgeAdjacency, pIMTArray,
+        statusCallBack, callbackFrequency, options,
+        vMeshOutVertexBuffer, vMeshOutIndexBuffer, pvFacePartitioning, pvVertexRemapArray,
+        vPartitionResultAdjacency, maxStretchOut, numChartsOut);
+}
+
+template<typename index_t, typename = decltype(UVAtlasIndexFormat<index_t>::value)>
+inline HRESULT __cdecl UVAtlasComputeIMTFromPerVertexSignal(
+    _In_reads_(nVerts) const DirectX::XMFLOAT3* positions, size_t nVerts,
+    _In_reads_(nFaces * 3) const index_t* indices, size_t nFaces,
+    _In_reads_(signalStride * nVerts) const float* pVertexSignal,
+    size_t signalDimension,
+    size_t signalStride,
+    std::function<HRESULT __cdecl(float percentComplete)> statusCallBack,
+    _Out_writes_(nFaces * 3) float* pIMTArray)
+{
+    return DirectX::UVAtlasComputeIMTFromPerVertexSignal(positions, nVerts,
+        indices, UVAtlasIndexFormat<index_t>::value, nFaces,
+        pVertexSignal, signalDimension, signalStride, statusCallBack, pIMTArray);
+}
+
+template<typename index_t, typename = decltype(UVAtlasIndexFormat<index_t>::value)>
+inline HRESULT __cdecl UVAtlasComputeIMTFromSignal(
+    _In_reads_(nVerts) const DirectX::XMFLOAT3* positions,
+    _In_reads_(nVerts) const DirectX::XMFLOAT2* texcoords,
+    size_t nVerts,
+    _In_reads_(nFaces * 3) const index_t* indices, size_t nFaces,
+    size_t signalDimension,
+    float maxUVDistance,
+    std::function<HRESULT __cdecl(const DirectX::XMFLOAT2* uv, size_t primitiveID, size_t signalDimension, void* userData, float* signalOut)> signalCallback,
+    _In_opt_ void* userData,
+    std::function<HRESULT __cdecl(float percentComplete)> statusCallBack,
+    _Out_writes_(nFaces * 3) float* pIMTArray)
+{
+    return DirectX::UVAtlasComputeIMTFromSignal(positions, texcoords, nVerts,
+        indices, UVAtlasIndexFormat<index_t>::value, nFaces,
+        signalDimension, maxUVDistance, signalCallback, userData, statusCallBack, pIMTArray);
+}
+
+template<typename index_t, typename = decltype(UVAtlasIndexFormat<index_t>::value)>
+inline HRESULT __cdecl UVAtlasComputeIMTFromTexture(
+    _In_reads_(nVerts) const DirectX::XMFLOAT3* positions,
+    _In_reads_(nVerts) const DirectX::XMFLOAT2* texcoords,
+    size_t nVerts,
+    _In_reads_(nFaces * 3) const index_t* indices, size_t nFaces,
+    _In_reads_(width * height * 4) const float* pTexture,
+    size_t width, size_t height,
+    DirectX::UVATLAS_IMT options,
+    std::function<HRESULT __cdecl(float percentComplete)> statusCallBack,
+    _Out_writes_(nFaces * 3) float* pIMTArray)
+{
+    return DirectX::UVAtlasComputeIMTFromTexture(positions, texcoords, nVerts,
+        indices, UVAtlasIndexFormat<index_t>::value, nFaces,
+        pTexture, width, height, options, statusCallBack, pIMTArray);
+}
+
+template<typename index_t, typename = decltype(UVAtlasIndexFormat<index_t>::value)>
+inline HRESULT __cdecl UVAtlasComputeIMTFromPerTexelSignal(
+    _In_reads_(nVerts) const DirectX::XMFLOAT3* positions,
+    _In_reads_(nVerts) const DirectX::XMFLOAT2* texcoords,
+    size_t nVerts,
+    _In_reads_(nFaces * 3) const index_t* indices, size_t nFaces,
+    _In_reads_(width * height * signalComponents) const float* pTexelSignal,
+    size_t width, size_t height, size_t signalComponents,
+    DirectX::UVATLAS_IMT options,
+    std::function<HRESULT __cdecl(float percentComplete)> statusCallBack,
+    _Out_writes_(nFaces * 3) float* pIMTArray)
+{
+    return DirectX::UVAtlasComputeIMTFromPerTexelSignal(positions, texcoords, nVerts,
+        indices, UVAtlasIndexFormat<index_t>::value, nFaces,
+        pTexelSignal, width, height, signalComponents, options, statusCallBack, pIMTArray);
+}